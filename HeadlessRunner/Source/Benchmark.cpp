@@ -0,0 +1,1944 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "OfflineRenderer.h"
+
+namespace
+{
+    // white noise in every channel, written through the ring so its mirrored tail is filled in too
+    void fillWithNoise (DelayRing& ring, juce::Random& random)
+    {
+        juce::HeapBlock<float> noise ((size_t) ring.getGuardSize());
+
+        for (int channel = 0; channel < ring.getNumChannels(); ++channel)
+        {
+            for (int start = 0; start < ring.getNumSamples(); start += ring.getGuardSize())
+            {
+                auto numSamples = juce::jmin (ring.getGuardSize(), ring.getNumSamples() - start);
+
+                for (int i = 0; i < numSamples; ++i)
+                    noise[i] = random.nextFloat() * 2.0f - 1.0f;
+
+                ring.write (channel, start, noise, numSamples);
+            }
+        }
+    }
+}
+
+//==============================================================================
+juce::Array<BenchmarkResult> ThroughputBenchmark::run()
+{
+    juce::Array<BenchmarkResult> results;
+
+    for (auto numChannels : channelCounts)
+        for (auto sampleRate : sampleRates)
+            for (auto blockSize : blockSizes)
+                results.add (runOne (sampleRate, numChannels, blockSize));
+
+    return results;
+}
+
+BenchmarkResult ThroughputBenchmark::runOne (double sampleRate, int numChannels, int blockSize)
+{
+    BenchmarkResult result;
+    result.blockSize = blockSize;
+    result.sampleRate = sampleRate;
+    result.numChannels = numChannels;
+
+    OfflineRenderer renderer;
+
+    for (auto& parameterID : parameters.getAllKeys())
+        renderer.setParameter (parameterID, parameters[parameterID].getFloatValue());
+
+    if (! renderer.prepare (sampleRate, numChannels, blockSize))
+        return result;
+
+    // one block of deterministic noise, re-used so we time the DSP rather than the noise generator
+    juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::Random random (0x5eed);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    auto& processor = renderer.getProcessor();
+    juce::MidiBuffer midi;
+
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+    auto numWarmUpBlocks = juce::jmax (1, numBlocks / 10);
+
+    for (int i = 0; i < numWarmUpBlocks; ++i)
+    {
+        block.makeCopyOf (stimulus, true);
+        processor.processBlock (block, midi);
+    }
+
+    // the copy is part of the timed loop, the same way a host refills its buffer each callback
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        block.makeCopyOf (stimulus, true);
+        processor.processBlock (block, midi);
+    }
+
+    auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+    auto numFrames = (double) numBlocks * blockSize;
+    auto numSamples = numFrames * numChannels;
+
+    result.samplesPerSecond = numSamples / elapsedSeconds;
+    result.nanosPerSample = elapsedSeconds * 1.0e9 / numSamples;
+    result.realtimeFactor = (numFrames / sampleRate) / elapsedSeconds;
+    return result;
+}
+
+//==============================================================================
+void ThroughputBenchmark::printTable (const juce::Array<BenchmarkResult>& results)
+{
+    std::cout << juce::String ("channels").paddedLeft (' ', 9)
+              << juce::String ("rate").paddedLeft (' ', 9)
+              << juce::String ("block").paddedLeft (' ', 7)
+              << juce::String ("samples/s").paddedLeft (' ', 15)
+              << juce::String ("ns/sample").paddedLeft (' ', 11)
+              << juce::String ("x realtime").paddedLeft (' ', 12) << std::endl;
+
+    for (auto& r : results)
+    {
+        std::cout << juce::String (r.numChannels).paddedLeft (' ', 9)
+                  << juce::String ((int) r.sampleRate).paddedLeft (' ', 9)
+                  << juce::String (r.blockSize).paddedLeft (' ', 7)
+                  << juce::String (r.samplesPerSecond, 0).paddedLeft (' ', 15)
+                  << juce::String (r.nanosPerSample, 3).paddedLeft (' ', 11)
+                  << juce::String (r.realtimeFactor, 1).paddedLeft (' ', 12) << std::endl;
+    }
+}
+
+bool ThroughputBenchmark::writeCsv (const juce::Array<BenchmarkResult>& results, const juce::File& file)
+{
+    juce::StringArray lines;
+    lines.add ("channels,sample_rate,block_size,samples_per_second,ns_per_sample,realtime_factor");
+
+    for (auto& r : results)
+        lines.add (juce::StringArray { juce::String (r.numChannels),
+                                       juce::String (r.sampleRate, 0),
+                                       juce::String (r.blockSize),
+                                       juce::String (r.samplesPerSecond, 0),
+                                       juce::String (r.nanosPerSample, 4),
+                                       juce::String (r.realtimeFactor, 2) }.joinIntoString (","));
+
+    return file.replaceWithText (lines.joinIntoString ("\n") + "\n");
+}
+
+//==============================================================================
+void printKernelTable (const juce::Array<KernelResult>& results)
+{
+    std::cout << juce::String ("kernel").paddedRight (' ', 28)
+              << juce::String ("block").paddedLeft (' ', 7)
+              << juce::String ("ns/sample").paddedLeft (' ', 11)
+              << juce::String ("x baseline").paddedLeft (' ', 12)
+              << juce::String ("% core").paddedLeft (' ', 9) << std::endl;
+
+    double baseline = 0.0;
+    int baselineBlockSize = -1;
+    int baselineGroup = -1;
+
+    for (auto& r : results)
+    {
+        if (r.blockSize != baselineBlockSize || r.group != baselineGroup)
+        {
+            baseline = r.nanosPerSample;
+            baselineBlockSize = r.blockSize;
+            baselineGroup = r.group;
+        }
+
+        std::cout << r.name.paddedRight (' ', 28)
+                  << juce::String (r.blockSize).paddedLeft (' ', 7)
+                  << juce::String (r.nanosPerSample, 3).paddedLeft (' ', 11)
+                  << juce::String (r.nanosPerSample / baseline, 2).paddedLeft (' ', 12)
+                  << juce::String (r.percentOfCore, 3).paddedLeft (' ', 9) << std::endl;
+    }
+}
+
+//==============================================================================
+juce::Array<KernelResult> InterpolatorBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    auto maxBlockSize = 1;
+
+    for (auto blockSize : blockSizes)
+        maxBlockSize = juce::jmax (maxBlockSize, blockSize);
+
+    DelayRing delayBuffer;
+    delayBuffer.setSize (1, (int) (sampleRate * 4.0), maxBlockSize + FractionalDelayReader::maxReadSpan);
+    auto delayBufferSize = delayBuffer.getNumSamples();
+    juce::Random random (0x5eed);
+    fillWithNoise (delayBuffer, random);
+
+    for (auto blockSize : blockSizes)
+    {
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+        // the same delay sequence for every kernel
+        juce::Array<double> delayTimes;
+
+        for (int i = 0; i < numBlocks; ++i)
+            delayTimes.add ((0.01 + 3.9 * random.nextDouble()) * sampleRate);
+
+        juce::AudioBuffer<float> output (1, blockSize);
+        output.clear();
+
+        auto time = [&] (const juce::String& name, auto&& readBlock)
+        {
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                readBlock (output.getWritePointer (0), writePosition, delayTimes.getUnchecked (i));
+                writePosition = (writePosition + blockSize) % delayBufferSize;
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            auto numFrames = (double) numBlocks * blockSize;
+            results.add ({ name, blockSize, elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate) });
+        };
+
+        // the original readDelayBuffer: truncate, then one or two addFrom() calls
+        time ("integer addFrom (original)", [&] (float* dest, int writePosition, double delay)
+        {
+            auto readPosition = writePosition - (int) delay;
+
+            if (readPosition < 0)
+                readPosition += delayBufferSize;
+
+            if (readPosition + blockSize < delayBufferSize)
+            {
+                juce::FloatVectorOperations::addWithMultiply (dest, delayBuffer.getReadPointer (0) + readPosition, 0.5f, blockSize);
+            }
+            else
+            {
+                auto numSamplesToEnd = delayBufferSize - readPosition;
+                juce::FloatVectorOperations::addWithMultiply (dest, delayBuffer.getReadPointer (0) + readPosition, 0.5f, numSamplesToEnd);
+                juce::FloatVectorOperations::addWithMultiply (dest + numSamplesToEnd, delayBuffer.getReadPointer (0), 0.5f, blockSize - numSamplesToEnd);
+            }
+        });
+
+        auto typeNames = FractionalDelayReader::getTypeNames();
+
+        for (int type = 0; type < typeNames.size(); ++type)
+        {
+            FractionalDelayReader reader;
+            reader.prepare (1);
+            reader.setType ((InterpolationType) type);
+
+            time (typeNames[type], [&] (float* dest, int writePosition, double delay)
+            {
+                reader.addFrom (dest, blockSize, delayBuffer.getReadPointer (0), delayBuffer.getMask(), writePosition, delay, 0.5f, 0);
+            });
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> FdnBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::Random random (0x5eed);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+    auto matrixNames = FeedbackDelayNetwork::getMatrixNames();
+
+    for (int lineCountIndex = 0; lineCountIndex < FeedbackDelayNetwork::getLineCountNames().size(); ++lineCountIndex)
+    {
+        for (int matrix = 0; matrix < matrixNames.size(); ++matrix)
+        {
+            auto numLines = FeedbackDelayNetwork::getLineCountForIndex (lineCountIndex);
+
+            auto fdn = std::make_unique<FeedbackDelayNetwork>();
+            fdn->prepare (sampleRate);
+            fdn->setParameters (numLines, (FeedbackDelayNetwork::MixingMatrix) matrix, 0.08f, 2.0f, 0.3f);
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.makeCopyOf (stimulus, true);
+                fdn->process (block.getArrayOfWritePointers(), numChannels, blockSize, nullptr, 0.5f);
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            auto numFrames = (double) numBlocks * blockSize;
+
+            results.add ({ juce::String (numLines) + " lines, " + matrixNames[matrix], blockSize,
+                           elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate) });
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> MultiTapBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    DelayRing delayBuffer;
+    delayBuffer.setSize (numChannels, (int) (sampleRate * 2.0), blockSize + 1);
+    auto delayBufferSize = delayBuffer.getNumSamples();
+    juce::AudioBuffer<float> output (numChannels, blockSize);
+    juce::Random random (0x5eed);
+    fillWithNoise (delayBuffer, random);
+
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+    for (auto numTaps : tapCounts)
+    {
+        numTaps = juce::jlimit (1, MultiTapDelay::maxNumTaps, numTaps);
+
+        // the taps the plugin builds: evenly spaced up to the longest delay, decaying, alternating sides
+        MultiTapDelay::Tap taps[MultiTapDelay::maxNumTaps];
+
+        for (int t = 0; t < numTaps; ++t)
+            taps[t] = { (delayBufferSize - blockSize) * (t + 1.0) / numTaps + 0.37, std::pow (0.8f, (float) t), t % 2 == 0 ? -0.7f : 0.7f };
+
+        auto time = [&] (const juce::String& name, bool singlePass)
+        {
+            MultiTapDelay multiTap;
+            output.clear();
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                multiTap.setTaps (taps, numTaps, delayBuffer.getMask(), writePosition);
+
+                if (singlePass)
+                    multiTap.process (output.getArrayOfWritePointers(), delayBuffer.getArrayOfReadPointers(), numChannels,
+                                      blockSize, nullptr, 0.5f);
+                else
+                    multiTap.processPerTap (output.getArrayOfWritePointers(), delayBuffer.getArrayOfReadPointers(), numChannels,
+                                            blockSize, 0.5f);
+
+                writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            auto numFrames = (double) numBlocks * blockSize;
+            results.add ({ juce::String (numTaps) + " taps, " + name, blockSize,
+                           elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate), numTaps });
+        };
+
+        time ("per tap", false);
+        time ("single pass", true);
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> RingBufferBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    juce::Random random (0x5eed);
+
+    for (auto blockSize : blockSizes)
+    {
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+        juce::AudioBuffer<float> output (numChannels, blockSize);
+        output.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                block.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        // the same delay sequence for both buffers, whole samples so only the buffer handling differs
+        juce::Array<int> delayTimes;
+
+        for (int i = 0; i < numBlocks; ++i)
+            delayTimes.add (blockSize + random.nextInt ((int) (3.9 * sampleRate) - blockSize));
+
+        auto addResult = [&] (const juce::String& name, double elapsedSeconds)
+        {
+            auto numFrames = (double) numBlocks * blockSize;
+            results.add ({ name, blockSize, elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate) });
+        };
+
+        // the original fillDelayBuffer / readDelayBuffer / updateBufferPositions: test for the wrap, split the copy
+        // in two when it's hit, and wrap the write position with %
+        {
+            auto delayBufferSize = (int) (sampleRate * 4.0);
+            juce::AudioBuffer<float> delayBuffer (numChannels, delayBufferSize);
+            delayBuffer.clear();
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    if (delayBufferSize > blockSize + writePosition)
+                    {
+                        delayBuffer.copyFrom (channel, writePosition, block.getReadPointer (channel), blockSize);
+                    }
+                    else
+                    {
+                        auto numSamplesToEnd = delayBufferSize - writePosition;
+                        delayBuffer.copyFrom (channel, writePosition, block.getReadPointer (channel), numSamplesToEnd);
+                        delayBuffer.copyFrom (channel, 0, block.getReadPointer (channel, numSamplesToEnd), blockSize - numSamplesToEnd);
+                    }
+
+                    auto readPosition = writePosition - delayTimes.getUnchecked (b);
+
+                    if (readPosition < 0)
+                        readPosition += delayBufferSize;
+
+                    if (readPosition + blockSize < delayBufferSize)
+                    {
+                        output.addFrom (channel, 0, delayBuffer.getReadPointer (channel, readPosition), blockSize, 0.5f);
+                    }
+                    else
+                    {
+                        auto numSamplesToEnd = delayBufferSize - readPosition;
+                        output.addFrom (channel, 0, delayBuffer.getReadPointer (channel, readPosition), numSamplesToEnd, 0.5f);
+                        output.addFrom (channel, numSamplesToEnd, delayBuffer.getReadPointer (channel), blockSize - numSamplesToEnd, 0.5f);
+                    }
+                }
+
+                writePosition += blockSize;
+                writePosition %= delayBufferSize;
+            }
+
+            addResult ("two-segment copy (original)", juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+        }
+
+        // the power-of-two ring: one masked index and one contiguous span each way
+        {
+            DelayRing delayBuffer;
+            delayBuffer.setSize (numChannels, (int) (sampleRate * 4.0), blockSize);
+            auto mask = delayBuffer.getMask();
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    delayBuffer.write (channel, writePosition, block.getReadPointer (channel), blockSize);
+                    auto readPosition = (writePosition - delayTimes.getUnchecked (b)) & mask;
+                    output.addFrom (channel, 0, delayBuffer.getReadPointer (channel) + readPosition, blockSize, 0.5f);
+                }
+
+                writePosition = (writePosition + blockSize) & mask;
+            }
+
+            addResult ("mirrored ring", juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> DelayLineBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    constexpr float wetGain = 0.5f, mainGain = 0.8f;
+    juce::Random random (0x5eed);
+
+    for (auto blockSize : blockSizes)
+    {
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+        juce::AudioBuffer<float> input (numChannels, blockSize);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        // the same delay sequence for both, fractional and longer than the block
+        juce::Array<double> delayTimes;
+
+        for (int i = 0; i < numBlocks; ++i)
+            delayTimes.add (blockSize + 4 + random.nextDouble() * (3.9 * sampleRate - blockSize - 4));
+
+        for (auto type : { InterpolationType::none, InterpolationType::hermite })
+        {
+            auto group = (int) type;
+            auto typeName = FractionalDelayReader::getTypeNames()[(int) type].toLowerCase();
+
+            auto addResult = [&] (const juce::String& name, double elapsedSeconds)
+            {
+                auto numFrames = (double) numBlocks * blockSize;
+                results.add ({ name + ", " + typeName, blockSize, elapsedSeconds * 1.0e9 / numFrames,
+                               100.0 * elapsedSeconds / (numFrames / sampleRate), group });
+            };
+
+            DelayRing delayBuffer;
+            delayBuffer.setSize (numChannels, (int) (sampleRate * 4.0), blockSize + FractionalDelayReader::maxReadSpan);
+
+            FractionalDelayReader reader;
+            reader.prepare (numChannels);
+            reader.setType (type);
+
+            // fill, read, fill again for the feedback, then the gain: four passes over each channel
+            {
+                delayBuffer.clear();
+                int writePosition = 0;
+                auto startTicks = juce::Time::getHighResolutionTicks();
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    block.makeCopyOf (input, true);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        auto* samples = block.getWritePointer (channel);
+
+                        delayBuffer.write (channel, writePosition, samples, blockSize);
+                        reader.addFrom (samples, blockSize, delayBuffer.getReadPointer (channel), delayBuffer.getMask(),
+                                        writePosition, delayTimes.getUnchecked (b), wetGain, channel);
+                        delayBuffer.write (channel, writePosition, samples, blockSize);
+                        juce::FloatVectorOperations::multiply (samples, mainGain, blockSize);
+                    }
+
+                    writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+                }
+
+                addResult ("separate (4 passes)", juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+            }
+
+            // the fused kernel: one pass reads the echo, writes the feedback and the gained output
+            {
+                delayBuffer.clear();
+                reader.reset();
+                int writePosition = 0;
+                auto startTicks = juce::Time::getHighResolutionTicks();
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    block.makeCopyOf (input, true);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        reader.processFeedback (block.getWritePointer (channel), blockSize, delayBuffer.getWritePointer (channel),
+                                                delayBuffer.getMask(), writePosition, delayTimes.getUnchecked (b), wetGain,
+                                                nullptr, mainGain, channel);
+                        delayBuffer.commit (channel, writePosition, blockSize);
+                    }
+
+                    writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+                }
+
+                addResult ("fused (1 pass)", juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+            }
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> ChannelScalingBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+    juce::Random random (0x5eed);
+    int group = 0;
+
+    for (auto numChannels : channelCounts)
+    {
+        numChannels = juce::jlimit (1, FractionalDelayReader::maxNumChannels, numChannels);
+
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+        juce::AudioBuffer<float> input (numChannels, blockSize);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        DelayRing delayBuffer;
+        delayBuffer.setSize (numChannels, (int) (sampleRate * 2.0), blockSize + FractionalDelayReader::maxReadSpan);
+
+        // a slow glide between two delays longer than the block, the way the smoothing ramps them
+        juce::HeapBlock<double> delays ((size_t) blockSize);
+        juce::HeapBlock<float> gains ((size_t) blockSize);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            delays[i] = 0.5 * sampleRate + 0.25 * i;
+            gains[i] = 0.5f;
+        }
+
+        struct Variant
+        {
+            const char* name;
+            InterpolationType type;
+            bool ramping;
+        };
+
+        for (auto variant : { Variant { "hermite ramp", InterpolationType::hermite, true },
+                              Variant { "allpass", InterpolationType::allpass, false },
+                              Variant { "hermite", InterpolationType::hermite, false } })
+        {
+            FractionalDelayReader reader;
+            reader.prepare (numChannels);
+            reader.setType (variant.type);
+
+            auto name = juce::String (numChannels) + " ch " + variant.name;
+
+            for (auto together : { false, true })
+            {
+                delayBuffer.clear();
+                reader.reset();
+                int writePosition = 0;
+                auto startTicks = juce::Time::getHighResolutionTicks();
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    block.makeCopyOf (input, true);
+
+                    if (together && variant.ramping)
+                        reader.processFeedback (block.getArrayOfWritePointers(), numChannels, blockSize, delayBuffer.getArrayOfWritePointers(),
+                                                delayBuffer.getMask(), writePosition, delays, gains, nullptr, 0.8f);
+                    else if (together)
+                        reader.processFeedback (block.getArrayOfWritePointers(), numChannels, blockSize, delayBuffer.getArrayOfWritePointers(),
+                                                delayBuffer.getMask(), writePosition, delays[0], 0.5f, nullptr, 0.8f);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        if (! together && variant.ramping)
+                            reader.processFeedback (block.getWritePointer (channel), blockSize, delayBuffer.getWritePointer (channel),
+                                                    delayBuffer.getMask(), writePosition, delays, gains, nullptr, 0.8f, channel);
+                        else if (! together)
+                            reader.processFeedback (block.getWritePointer (channel), blockSize, delayBuffer.getWritePointer (channel),
+                                                    delayBuffer.getMask(), writePosition, delays[0], 0.5f, nullptr, 0.8f, channel);
+
+                        delayBuffer.commit (channel, writePosition, blockSize);
+                    }
+
+                    writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+                }
+
+                auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+                auto numFrames = (double) numBlocks * blockSize;
+
+                results.add ({ name + (together ? ", together" : ", per channel"), blockSize, elapsedSeconds * 1.0e9 / numFrames,
+                               100.0 * elapsedSeconds / (numFrames / sampleRate), group });
+            }
+
+            ++group;
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> ParallelScalingBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+    juce::SharedResourcePointer<WorkerPool> pool; // the one the processors share
+
+    auto numThreads = maxThreads > 0 ? juce::jmin (maxThreads, pool->getNumWorkers() + 1) : pool->getNumWorkers() + 1;
+    std::cout << pool->getNumWorkers() << " workers in the pool" << std::endl;
+
+    // 60 dB down by the end, written out so the processor can load it like any other impulse response
+    juce::TemporaryFile impulseFile (".wav");
+
+    {
+        juce::Random random (0x5eed);
+        juce::AudioBuffer<float> impulse (2, juce::jmax (1, (int) (impulseSeconds * sampleRate)));
+
+        for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+            for (int i = 0; i < impulse.getNumSamples(); ++i)
+                impulse.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * std::pow (10.0f, -3.0f * (float) i / impulse.getNumSamples()));
+
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::FileOutputStream> outputStream (impulseFile.getFile().createOutputStream());
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (outputStream != nullptr)
+            writer.reset (wavFormat.createWriterFor (outputStream.get(), sampleRate, (unsigned int) impulse.getNumChannels(), 32, {}, 0));
+
+        if (writer == nullptr)
+            return results;
+
+        outputStream.release();
+        writer->writeFromAudioSampleBuffer (impulse, 0, impulse.getNumSamples());
+    }
+
+    struct Variant
+    {
+        juce::String name;
+        juce::StringPairArray parameters;
+        bool convolution;
+    };
+
+    juce::StringPairArray saturation;
+    saturation.set ("SATURATION", "1");
+    saturation.set ("SATURATION_DRIVE", "12");
+    saturation.set ("SATURATION_OVERSAMPLING", "3");
+
+    // the router mixes the channels between the two parallel halves
+    auto saturationPingPong = saturation;
+    saturationPingPong.set ("ROUTING", "1");
+
+    juce::StringPairArray convolution;
+    convolution.set ("CONVOLUTION", "1");
+    convolution.set ("CONVOLUTION_MIX", "0.5");
+
+    int group = 0;
+
+    for (auto& variant : { Variant { "sat 8x", saturation, false },
+                           Variant { "sat 8x ping-pong", saturationPingPong, false },
+                           Variant { "conv " + juce::String (impulseSeconds, 1) + " s", convolution, true } })
+    {
+        for (auto blockSize : blockSizes)
+        {
+            auto file = variant.convolution ? impulseFile.getFile() : juce::File();
+            juce::AudioBuffer<float> singleThreaded, output;
+
+            auto parameters = variant.parameters;
+            parameters.set ("PARALLEL", "0");
+
+            auto nanos = runOne (parameters, file, blockSize, singleThreaded);
+            results.add ({ variant.name + ", off", blockSize, nanos, 100.0 * nanos * sampleRate * 1.0e-9, group });
+
+            parameters.set ("PARALLEL", "1");
+
+            for (int threads = 1; threads <= numThreads; ++threads)
+            {
+                pool->setMaxNumWorkers (threads - 1);
+                nanos = runOne (parameters, file, blockSize, output);
+
+                results.add ({ variant.name + ", " + juce::String (threads) + (threads == 1 ? " thread" : " threads"), blockSize, nanos,
+                               100.0 * nanos * sampleRate * 1.0e-9, group });
+
+                auto maxError = 0.0f;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    for (int i = 0; i < output.getNumSamples(); ++i)
+                        maxError = juce::jmax (maxError, std::abs (output.getSample (channel, i) - singleThreaded.getSample (channel, i)));
+
+                if (! (maxError == 0.0f))
+                    std::cout << variant.name << ", " << threads << " threads, block " << blockSize
+                              << ": output differs from single-threaded by " << maxError << std::endl;
+            }
+
+            ++group;
+        }
+    }
+
+    pool->setMaxNumWorkers (WorkerPool::maxNumWorkers);
+
+    // each of these kept the workers out of the following second, so the timings around it are the audio thread's own
+    if (pool->getNumLateRuns() > 0)
+        std::cout << pool->getNumLateRuns() << " runs waited past the deadline for a worker" << std::endl;
+
+    return results;
+}
+
+double ParallelScalingBenchmark::runOne (const juce::StringPairArray& parameters, const juce::File& impulseFile, int blockSize,
+                                         juce::AudioBuffer<float>& output)
+{
+    OfflineRenderer renderer;
+
+    for (auto& parameterID : parameters.getAllKeys())
+        renderer.setParameter (parameterID, parameters[parameterID].getFloatValue());
+
+    if (! renderer.prepare (sampleRate, numChannels, blockSize))
+        return 0.0;
+
+    auto& processor = renderer.getProcessor();
+
+    // the convolver is built in the background and swapped in by the first block after it's ready
+    if (impulseFile != juce::File())
+    {
+        processor.loadImpulseResponse (impulseFile);
+
+        while (processor.isLoadingImpulseResponse())
+            juce::Thread::sleep (10);
+
+        juce::Thread::sleep (100);
+    }
+
+    juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+    juce::Random random (0x5eed);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    output.setSize (numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+    auto numWarmUpBlocks = juce::jmax (1, numBlocks / 10);
+
+    for (int i = 0; i < numWarmUpBlocks; ++i)
+    {
+        output.makeCopyOf (stimulus, true);
+        processor.processBlock (output, midi);
+    }
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        output.makeCopyOf (stimulus, true);
+        processor.processBlock (output, midi);
+    }
+
+    auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    return elapsedSeconds * 1.0e9 / ((double) numBlocks * blockSize);
+}
+
+//==============================================================================
+juce::Array<DelayRegressionTest::Result> DelayRegressionTest::run()
+{
+    juce::Array<Result> results;
+
+    for (auto type : { InterpolationType::none, InterpolationType::linear })
+        for (auto blockSize : blockSizes)
+            for (auto delay : delaysInSamples)
+                results.add (runOne (type, blockSize, delay));
+
+    return results;
+}
+
+DelayRegressionTest::Result DelayRegressionTest::runOne (InterpolationType type, int blockSize, double delay)
+{
+    constexpr float wetGain = 0.5f, mainGain = 0.8f;
+
+    Result result;
+    result.interpolation = FractionalDelayReader::getTypeNames()[(int) type];
+    result.blockSize = blockSize;
+    result.delayInSamples = delay;
+
+    // set before prepare, so the ramps start at these values and nothing glides
+    OfflineRenderer renderer;
+    renderer.setParameter ("DELAY_LENGTH", (float) (delay / sampleRate));
+    renderer.setParameter ("WET_GAIN", wetGain);
+    renderer.setParameter ("GAIN", mainGain);
+    renderer.setParameter ("INTERPOLATION", (float) (int) type);
+
+    if (! renderer.prepare (sampleRate, numChannels, blockSize))
+    {
+        result.maxError = std::numeric_limits<double>::infinity();
+        return result;
+    }
+
+    // the delay as the processor sees it, after the parameter's own rounding
+    auto delayInSamples = (double) renderer.getProcessor().apvts.getRawParameterValue ("DELAY_LENGTH")->load() * sampleRate;
+    auto minimumDelay = FractionalDelayReader::getMinimumFeedbackDelay (type);
+    delayInSamples = juce::jmax (delayInSamples, minimumDelay);
+
+    auto numSamples = (int) (secondsOfAudio * sampleRate);
+    juce::AudioBuffer<float> buffer (numChannels, numSamples);
+    juce::Random random (0x5eed);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    juce::AudioBuffer<float> input (buffer);
+    renderer.process (buffer);
+
+    std::vector<double> y ((size_t) numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int n = 0; n < numSamples; ++n)
+        {
+            auto readPosition = (double) n - (type == InterpolationType::none ? std::floor (delayInSamples) : delayInSamples);
+            auto whole = (int) std::floor (readPosition);
+            auto a = readPosition - whole;
+
+            auto at = [&y] (int index) { return index >= 0 ? y[(size_t) index] : 0.0; };
+            auto delayed = at (whole) + a * (at (whole + 1) - at (whole));
+
+            y[(size_t) n] = input.getSample (channel, n) + wetGain * delayed;
+
+            result.maxError = juce::jmax (result.maxError, std::abs (mainGain * y[(size_t) n] - buffer.getSample (channel, n)));
+        }
+    }
+
+    return result;
+}
+
+void DelayRegressionTest::print (const juce::Array<Result>& results) const
+{
+    std::cout << juce::String ("interpolation").paddedRight (' ', 15)
+              << juce::String ("block").paddedLeft (' ', 7)
+              << juce::String ("delay").paddedLeft (' ', 10)
+              << juce::String ("max error").paddedLeft (' ', 12)
+              << juce::String ("result").paddedLeft (' ', 8) << std::endl;
+
+    for (auto& r : results)
+        std::cout << r.interpolation.paddedRight (' ', 15)
+                  << juce::String (r.blockSize).paddedLeft (' ', 7)
+                  << juce::String (r.delayInSamples, 1).paddedLeft (' ', 10)
+                  << juce::String (r.maxError, 9).paddedLeft (' ', 12)
+                  << juce::String (r.maxError <= tolerance ? "ok" : "FAILED").paddedLeft (' ', 8) << std::endl;
+}
+
+bool DelayRegressionTest::passed (const juce::Array<Result>& results) const
+{
+    for (auto& r : results)
+        if (! (r.maxError <= tolerance))
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+juce::Array<KernelResult> SaturationBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    juce::Random random (0x5eed);
+    auto factorNames = Saturator::getOversamplingNames();
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+        for (int factor = 0; factor <= Saturator::maxOversamplingIndex; ++factor)
+        {
+            auto saturator = std::make_unique<Saturator>();
+            saturator->prepare (numChannels, blockSize);
+            saturator->setParameters (12.0f, factor);
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.makeCopyOf (stimulus, true);
+                juce::dsp::AudioBlock<float> audioBlock (block);
+                saturator->process (audioBlock);
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            auto numFrames = (double) numBlocks * blockSize;
+
+            results.add ({ factorNames[factor] + ", " + juce::String (saturator->getLatencyInSamples(), 2) + " smp latency", blockSize,
+                           elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate) });
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> ConvolutionBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+    int group = 0;
+
+    if (impulseFiles.isEmpty())
+    {
+        juce::Random random (0x5eed);
+
+        // 60 dB down by the end, with the channels decorrelated like a real room
+        for (auto seconds : impulseSeconds)
+        {
+            juce::AudioBuffer<float> impulse (2, juce::jmax (1, (int) (seconds * sampleRate)));
+
+            for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+                for (int i = 0; i < impulse.getNumSamples(); ++i)
+                    impulse.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * std::pow (10.0f, -3.0f * (float) i / impulse.getNumSamples()));
+
+            runOne (juce::String (seconds, 1) + " s", impulse, group++, results);
+        }
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    for (auto& file : impulseFiles)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+        if (reader == nullptr)
+        {
+            std::cout << "couldn't read " << file.getFullPathName() << std::endl;
+            continue;
+        }
+
+        // timed at the file's own length in samples, whatever its rate
+        juce::AudioBuffer<float> impulse (juce::jlimit (1, 2, (int) reader->numChannels), (int) reader->lengthInSamples);
+        reader->read (&impulse, 0, impulse.getNumSamples(), 0, true, true);
+
+        runOne (file.getFileName(), impulse, group++, results);
+    }
+
+    return results;
+}
+
+void ConvolutionBenchmark::runOne (const juce::String& name, const juce::AudioBuffer<float>& impulse, int group, juce::Array<KernelResult>& results)
+{
+    constexpr int numChannels = 2;
+    juce::Random random (0x5eed);
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+        auto numFrames = (double) numBlocks * blockSize;
+
+        auto addResult = [&] (const juce::String& engine, double elapsedSeconds)
+        {
+            results.add ({ name + ", " + engine, blockSize, elapsedSeconds * 1.0e9 / numFrames,
+                           100.0 * elapsedSeconds / (numFrames / sampleRate), group });
+        };
+
+        {
+            PartitionedConvolver convolver;
+            convolver.prepare (impulse, numChannels, partitionSize);
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.makeCopyOf (stimulus, true);
+                convolver.process (block.getArrayOfWritePointers(), numChannels, blockSize, 1.0f);
+            }
+
+            addResult ("partitioned", juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+        }
+
+        // the juce engine loads on its own thread, so keep feeding it until the whole impulse response is in
+        auto timeJuceConvolution = [&] (juce::dsp::Convolution& convolution, const juce::String& engine)
+        {
+            convolution.prepare ({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+            convolution.loadImpulseResponse (juce::AudioBuffer<float> (impulse), sampleRate,
+                                             impulse.getNumChannels() > 1 ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
+                                             juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+
+            for (int attempt = 0; convolution.getCurrentIRSize() != impulse.getNumSamples() && attempt < 2000; ++attempt)
+            {
+                juce::dsp::AudioBlock<float> audioBlock (block);
+                convolution.process (juce::dsp::ProcessContextReplacing<float> (audioBlock));
+                juce::Thread::sleep (1);
+            }
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.makeCopyOf (stimulus, true);
+                juce::dsp::AudioBlock<float> audioBlock (block);
+                convolution.process (juce::dsp::ProcessContextReplacing<float> (audioBlock));
+            }
+
+            jassert (convolution.getLatency() == 0);
+            addResult (engine, juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+        };
+
+        {
+            juce::dsp::Convolution convolution;
+            timeJuceConvolution (convolution, "juce uniform");
+        }
+
+        {
+            juce::dsp::Convolution convolution { juce::dsp::Convolution::NonUniform { partitionSize } };
+            timeJuceConvolution (convolution, "juce non-uniform");
+        }
+    }
+}
+
+//==============================================================================
+juce::Array<KernelResult> ModulationBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    auto maxBlockSize = 1;
+
+    for (auto blockSize : blockSizes)
+        maxBlockSize = juce::jmax (maxBlockSize, blockSize);
+
+    DelayRing delayBuffer;
+    delayBuffer.setSize (numChannels, (int) (sampleRate * 2.0), maxBlockSize + FractionalDelayReader::maxReadSpan);
+    juce::Random random (0x5eed);
+    fillWithNoise (delayBuffer, random);
+
+    auto delayInSamples = 0.02 * sampleRate;
+    auto maxDelay = (double) (delayBuffer.getNumSamples() - maxBlockSize);
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<float> output (numChannels, blockSize);
+        juce::HeapBlock<double> delays ((size_t) blockSize);
+        juce::HeapBlock<float> gains ((size_t) blockSize);
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+        auto numFrames = (double) numBlocks * blockSize;
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            delays[i] = delayInSamples;
+            gains[i] = 0.5f;
+        }
+
+        // block is called with the write position, once per block
+        auto time = [&] (const juce::String& name, int group, const std::function<void (int)>& block)
+        {
+            output.clear();
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block (writePosition);
+                writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            results.add ({ name, blockSize, elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate), group });
+        };
+
+        FractionalDelayReader reader;
+        reader.prepare (numChannels);
+        reader.setType (InterpolationType::hermite);
+
+        time ("single tap", 0, [&] (int writePosition)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                reader.addFrom (output.getWritePointer (channel), blockSize, delayBuffer.getReadPointer (channel),
+                                delayBuffer.getMask(), writePosition, delayInSamples, 0.5f, channel);
+        });
+
+        time ("single tap, per-sample delay", 0, [&] (int writePosition)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                reader.addFrom (output.getWritePointer (channel), blockSize, delayBuffer.getReadPointer (channel),
+                                delayBuffer.getMask(), writePosition, delays.getData(), gains.getData(), channel);
+        });
+
+        auto timeModulated = [&] (const juce::String& name, ModulatedDelay::Mode mode, int numVoices)
+        {
+            ModulatedDelay modulatedDelay;
+            modulatedDelay.prepare (sampleRate, numChannels, blockSize);
+            modulatedDelay.setParameters (mode, LfoBank::Shape::sine, 0.8f, 0.5f, numVoices, InterpolationType::hermite, numChannels);
+
+            time (name, 0, [&] (int writePosition)
+            {
+                modulatedDelay.advance (blockSize);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    modulatedDelay.addFrom (output.getWritePointer (channel), channel, blockSize, delayBuffer.getReadPointer (channel),
+                                            delayBuffer.getMask(), writePosition, nullptr, delayInSamples, nullptr, 0.5f, maxDelay);
+            });
+        };
+
+        timeModulated ("flanger, 1 voice", ModulatedDelay::Mode::flanger, 1);
+
+        for (auto numVoices : voiceCounts)
+            timeModulated ("chorus, " + juce::String (numVoices) + " voices", ModulatedDelay::Mode::chorus, numVoices);
+
+        // the oscillators on their own
+        auto numOscillators = numChannels * ModulatedDelay::maxNumVoices;
+        auto oscillatorName = juce::String (numOscillators) + " lfos, ";
+        juce::AudioBuffer<float> lfoOutput (numOscillators, blockSize);
+        double phases[numChannels * ModulatedDelay::maxNumVoices] {};
+        auto phaseIncrement = juce::MathConstants<double>::twoPi * 0.8 / sampleRate;
+
+        time (oscillatorName + "std::sin", 1, [&] (int)
+        {
+            for (int osc = 0; osc < numOscillators; ++osc)
+            {
+                auto* samples = lfoOutput.getWritePointer (osc);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    samples[i] = (float) std::sin (phases[osc]);
+                    phases[osc] += phaseIncrement;
+                }
+            }
+        });
+
+        auto shapeNames = LfoBank::getShapeNames();
+
+        for (int shape = 0; shape < shapeNames.size(); ++shape)
+        {
+            LfoBank lfos;
+            float startPhases[numChannels * ModulatedDelay::maxNumVoices];
+
+            for (int osc = 0; osc < numOscillators; ++osc)
+                startPhases[osc] = (float) osc / (float) numOscillators;
+
+            lfos.prepare (sampleRate, numOscillators, blockSize);
+            lfos.setParameters ((LfoBank::Shape) shape, 0.8f);
+            lfos.setPhases (startPhases, numOscillators);
+
+            time (oscillatorName + shapeNames[shape].toLowerCase(), 1, [&] (int) { lfos.process (blockSize); });
+        }
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> FeedbackFilterBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    juce::Random random (0x5eed);
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+    auto numFrames = (double) numBlocks * blockSize;
+
+    for (auto numChannels : channelCounts)
+    {
+        numChannels = juce::jlimit (1, FeedbackFilter::maxNumChannels, numChannels);
+
+        juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        auto time = [&] (const juce::String& name, bool perChannel, bool sweep)
+        {
+            FeedbackFilter filter;
+            filter.prepare (sampleRate);
+            filter.setParameters (120.0f, 5000.0f, -3.0f, numChannels);
+
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                // a slow sweep that never repeats a value, so every block recalculates
+                if (sweep)
+                    filter.setParameters (120.0f + (float) (i % 1000), 5000.0f - (float) (i % 1000), -3.0f, numChannels);
+
+                block.makeCopyOf (stimulus, true);
+
+                if (perChannel)
+                    filter.processPerChannel (block.getArrayOfWritePointers(), blockSize);
+                else
+                    filter.process (block.getArrayOfWritePointers(), blockSize);
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            results.add ({ juce::String (numChannels) + " ch, " + name, blockSize,
+                           elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate), numChannels });
+        };
+
+        time ("per channel", true, false);
+        time ("simd lanes", false, false);
+        time ("simd lanes, cutoffs moving", false, true);
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> DuckingBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+    constexpr int numChannels = 2;
+
+    juce::Random random (0x5eed);
+
+    for (auto blockSize : blockSizes)
+    {
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+        auto numFrames = (double) numBlocks * blockSize;
+
+        // a second of input in 100 ms bursts, loud then quiet, and the echoes as plain noise
+        auto stimulusLength = juce::jmax (blockSize, (int) sampleRate);
+        juce::AudioBuffer<float> input (numChannels, stimulusLength);
+        juce::AudioBuffer<float> wet (numChannels, blockSize);
+        juce::AudioBuffer<float> output (numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < stimulusLength; ++i)
+            {
+                auto level = (i / (int) (0.1 * sampleRate)) % 2 == 0 ? 0.8f : 0.01f;
+                input.setSample (channel, i, level * (random.nextFloat() * 2.0f - 1.0f));
+            }
+
+            for (int i = 0; i < blockSize; ++i)
+                wet.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+        }
+
+        auto time = [&] (const juce::String& name, const std::function<void (const float* const*)>& mix)
+        {
+            const float* detector[numChannels];
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                auto start = (i * blockSize) % (stimulusLength - blockSize + 1);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    detector[channel] = input.getReadPointer (channel, start);
+
+                mix (detector);
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            results.add ({ name, blockSize, elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate), 0 });
+        };
+
+        time ("plain add, no ducking", [&] (const float* const*)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::add (output.getWritePointer (channel), wet.getReadPointer (channel), blockSize);
+        });
+
+        auto timeDucked = [&] (const juce::String& name, Ducker::Detector detector, bool separatePass)
+        {
+            Ducker ducker;
+            ducker.prepare (sampleRate, blockSize);
+            ducker.setParameters (detector, -30.0f, -12.0f, 5.0f, 250.0f);
+
+            time (name, [&] (const float* const* channels)
+            {
+                ducker.process (channels, numChannels, blockSize);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    if (separatePass)
+                    {
+                        juce::FloatVectorOperations::multiply (wet.getWritePointer (channel), ducker.getGains(), blockSize);
+                        juce::FloatVectorOperations::add (output.getWritePointer (channel), wet.getReadPointer (channel), blockSize);
+                    }
+                    else
+                    {
+                        juce::FloatVectorOperations::addWithMultiply (output.getWritePointer (channel), wet.getReadPointer (channel),
+                                                                      ducker.getGains(), blockSize);
+                    }
+                }
+            });
+        };
+
+        timeDucked ("ducked, peak, in the mix", Ducker::Detector::peak, false);
+        timeDucked ("ducked, rms, in the mix", Ducker::Detector::rms, false);
+        timeDucked ("ducked, peak, separate pass", Ducker::Detector::peak, true);
+
+        // the output would only grow, start each block size from silence
+        output.clear();
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> GranularBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    constexpr float grainSizeMs = 100.0f;
+    auto maxBlockSize = 1;
+
+    for (auto blockSize : blockSizes)
+        maxBlockSize = juce::jmax (maxBlockSize, blockSize);
+
+    DelayRing delayBuffer;
+    delayBuffer.setSize (numChannels, (int) (sampleRate * 2.0), maxBlockSize + FractionalDelayReader::maxReadSpan);
+    juce::Random random (0x5eed);
+    fillWithNoise (delayBuffer, random);
+
+    auto delayInSamples = 0.2 * sampleRate;
+    auto maxDelay = (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize());
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<float> output (numChannels, blockSize);
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+        auto numFrames = (double) numBlocks * blockSize;
+
+        auto time = [&] (const juce::String& name, int group, bool reverse, float grainsPerSecond, float pitch)
+        {
+            GranularDelay granular;
+            granular.prepare (sampleRate, numChannels, blockSize);
+
+            output.clear();
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                granular.setParameters (reverse, delayInSamples, maxDelay, grainSizeMs, grainsPerSecond, pitch, 0.5f);
+                granular.process (output.getArrayOfWritePointers(), delayBuffer.getArrayOfReadPointers(), numChannels, blockSize,
+                                  delayBuffer.getMask(), writePosition, nullptr, 0.5f);
+                writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            results.add ({ name + " (" + juce::String (granular.getNumActiveGrains (0)) + " playing)", blockSize,
+                           elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate), group });
+        };
+
+        for (auto numGrains : grainCounts)
+            time (juce::String (numGrains) + " grains/ch, original pitch", 0, false, (float) numGrains * 1000.0f / grainSizeMs, 0.0f);
+
+        for (auto numGrains : grainCounts)
+            time (juce::String (numGrains) + " grains/ch, +7 semitones", 1, false, (float) numGrains * 1000.0f / grainSizeMs, 7.0f);
+
+        time ("reverse", 2, true, 0.0f, 0.0f);
+    }
+
+    return results;
+}
+
+//==============================================================================
+juce::Array<KernelResult> PitchShiftBenchmark::run()
+{
+    juce::Array<KernelResult> results;
+
+    constexpr int numChannels = 2;
+    auto maxBlockSize = 1;
+
+    for (auto blockSize : blockSizes)
+        maxBlockSize = juce::jmax (maxBlockSize, blockSize);
+
+    DelayRing delayBuffer;
+    delayBuffer.setSize (numChannels, (int) (sampleRate * 2.0), maxBlockSize + FractionalDelayReader::maxReadSpan);
+    juce::Random random (0x5eed);
+    fillWithNoise (delayBuffer, random);
+
+    auto delayInSamples = 0.3 * sampleRate;
+    auto maxDelay = (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize());
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<float> output (numChannels, blockSize);
+        auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+        auto numFrames = (double) numBlocks * blockSize;
+
+        auto time = [&] (const juce::String& name, int group, const std::function<void (int)>& block)
+        {
+            output.clear();
+            int writePosition = 0;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block (writePosition);
+                writePosition = (writePosition + blockSize) & delayBuffer.getMask();
+            }
+
+            auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            results.add ({ name, blockSize, elapsedSeconds * 1.0e9 / numFrames, 100.0 * elapsedSeconds / (numFrames / sampleRate), group });
+        };
+
+        FractionalDelayReader reader;
+        reader.prepare (numChannels);
+        reader.setType (InterpolationType::hermite);
+
+        time ("plain read", 0, [&] (int writePosition)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                reader.addFrom (output.getWritePointer (channel), blockSize, delayBuffer.getReadPointer (channel),
+                                delayBuffer.getMask(), writePosition, delayInSamples, 0.5f, channel);
+        });
+
+        for (auto windowMs : windowsMs)
+        {
+            PitchShifter pitchShifter;
+            pitchShifter.prepare (sampleRate, numChannels, blockSize);
+            pitchShifter.setParameters (semitones, (float) windowMs, InterpolationType::hermite, numChannels);
+
+            // the latency is in the summary, the name has to fit the table's column
+            time (juce::String (windowMs) + " ms window", 0, [&] (int writePosition)
+            {
+                pitchShifter.advance (blockSize);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    pitchShifter.addFrom (output.getWritePointer (channel), channel, blockSize, delayBuffer.getReadPointer (channel),
+                                          delayBuffer.getMask(), writePosition, nullptr, delayInSamples, nullptr, 0.5f, maxDelay);
+            });
+        }
+
+        // a whole instance, with whatever else the wet path costs once the pitch shifter takes it off the fused plain delay
+        juce::AudioBuffer<float> stimulus (numChannels, blockSize), block (numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        for (auto pitchShift : { false, true })
+        {
+            OfflineRenderer renderer;
+            renderer.setParameter ("MODE", 0.0f);
+            renderer.setParameter ("DELAY_LENGTH", 0.3f);
+            renderer.setParameter ("PITCH", pitchShift ? 1.0f : 0.0f);
+            renderer.setParameter ("PITCH_SHIFT", semitones);
+
+            if (! renderer.prepare (sampleRate, numChannels, blockSize))
+                continue;
+
+            auto& processor = renderer.getProcessor();
+
+            time (pitchShift ? "processBlock, pitch shift" : "processBlock, plain delay", 1, [&] (int)
+            {
+                block.makeCopyOf (stimulus, true);
+                processor.processBlock (block, midi);
+            });
+        }
+    }
+
+    return results;
+}
+
+void PitchShiftBenchmark::printSummary (const juce::Array<KernelResult>& results) const
+{
+    std::cout << std::endl;
+
+    // the shifter's own figure, so this can't drift from what the processor compensates for
+    for (auto windowMs : windowsMs)
+    {
+        PitchShifter pitchShifter;
+        pitchShifter.prepare (sampleRate, 1, 1);
+        pitchShifter.setParameters (semitones, (float) windowMs, InterpolationType::hermite, 1);
+
+        auto latencyInSamples = pitchShifter.getLatencyInSamples();
+
+        std::cout << "latency, " << windowMs << " ms window: " << juce::String (1000.0 * latencyInSamples / sampleRate, 1)
+                  << " ms (" << juce::roundToInt (latencyInSamples) << " samples at " << sampleRate << " Hz)" << std::endl;
+    }
+
+    // the whole-instance rows come in pairs, PITCH off then on, for each block size
+    for (int i = 0; i + 1 < results.size(); ++i)
+    {
+        auto& off = results.getReference (i);
+        auto& on = results.getReference (i + 1);
+
+        if (off.group == 1 && on.group == 1 && off.blockSize == on.blockSize)
+        {
+            std::cout << "per instance, block " << off.blockSize << ": " << juce::String (on.percentOfCore, 3)
+                      << "% of a core with PITCH on, " << juce::String (on.percentOfCore - off.percentOfCore, 3)
+                      << "% more than off" << std::endl;
+            ++i;
+        }
+    }
+}
+
+//==============================================================================
+RealtimeProfiler::Snapshot ProfileRun::run()
+{
+    OfflineRenderer renderer;
+
+    for (auto& parameterID : parameters.getAllKeys())
+        renderer.setParameter (parameterID, parameters[parameterID].getFloatValue());
+
+    if (! renderer.prepare (sampleRate, numChannels, blockSize))
+        return {};
+
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::Random random (0x5eed);
+    auto& profiler = renderer.getProcessor().getProfiler();
+
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int s = 0; s < blockSize; ++s)
+                block.setSample (channel, s, random.nextFloat() * 2.0f - 1.0f);
+
+        renderer.process (block);
+
+        // offline the aggregator thread isn't running, so empty the FIFO well before it fills
+        if (i % 256 == 255)
+            profiler.collect();
+    }
+
+    profiler.collect();
+    return profiler.getSnapshot();
+}
+
+void ProfileRun::print (const RealtimeProfiler::Snapshot& snapshot)
+{
+    auto stageNames = RealtimeProfiler::getStageNames();
+
+    std::cout << juce::String ("stage").paddedRight (' ', 12)
+              << juce::String ("p50 us").paddedLeft (' ', 10)
+              << juce::String ("p99 us").paddedLeft (' ', 10)
+              << juce::String ("max us").paddedLeft (' ', 10) << std::endl;
+
+    for (int stage = 0; stage < RealtimeProfiler::numStages; ++stage)
+    {
+        auto& stats = snapshot.stages[stage];
+
+        std::cout << stageNames[stage].paddedRight (' ', 12)
+                  << juce::String (stats.p50, 2).paddedLeft (' ', 10)
+                  << juce::String (stats.p99, 2).paddedLeft (' ', 10)
+                  << juce::String (stats.max, 2).paddedLeft (' ', 10) << std::endl;
+    }
+
+    std::cout << std::endl
+              << "dsp load: p50 " << juce::String (snapshot.loadP50, 2) << "%, p99 " << juce::String (snapshot.loadP99, 2)
+              << "%, max " << juce::String (snapshot.loadMax, 2) << "%" << std::endl
+              << "deadline misses: " << snapshot.deadlineMisses << " of " << snapshot.numBlocks << " blocks ("
+              << snapshot.droppedBlocks << " dropped)" << std::endl;
+}
+
+bool ProfileRun::writeCsv (const RealtimeProfiler::Snapshot& snapshot, const juce::File& file)
+{
+    auto stageNames = RealtimeProfiler::getStageNames();
+
+    juce::StringArray lines;
+    lines.add ("stage,p50_us,p99_us,max_us");
+
+    for (int stage = 0; stage < RealtimeProfiler::numStages; ++stage)
+    {
+        auto& stats = snapshot.stages[stage];
+        lines.add (juce::StringArray { stageNames[stage],
+                                       juce::String (stats.p50, 3),
+                                       juce::String (stats.p99, 3),
+                                       juce::String (stats.max, 3) }.joinIntoString (","));
+    }
+
+    // the block totals as a share of each block's duration, in percent
+    lines.add (juce::StringArray { "load_percent",
+                                   juce::String (snapshot.loadP50, 3),
+                                   juce::String (snapshot.loadP99, 3),
+                                   juce::String (snapshot.loadMax, 3) }.joinIntoString (","));
+
+    return file.replaceWithText (lines.joinIntoString ("\n") + "\n");
+}
+
+bool ProfileRun::writeJson (const RealtimeProfiler::Snapshot& snapshot, const juce::File& file)
+{
+    auto stageNames = RealtimeProfiler::getStageNames();
+    auto* stages = new juce::DynamicObject();
+
+    for (int stage = 0; stage < RealtimeProfiler::numStages; ++stage)
+    {
+        auto* stats = new juce::DynamicObject();
+        stats->setProperty ("p50_us", snapshot.stages[stage].p50);
+        stats->setProperty ("p99_us", snapshot.stages[stage].p99);
+        stats->setProperty ("max_us", snapshot.stages[stage].max);
+        stages->setProperty (stageNames[stage], juce::var (stats));
+    }
+
+    auto* load = new juce::DynamicObject();
+    load->setProperty ("p50_percent", snapshot.loadP50);
+    load->setProperty ("p99_percent", snapshot.loadP99);
+    load->setProperty ("max_percent", snapshot.loadMax);
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("stages", juce::var (stages));
+    root->setProperty ("load", juce::var (load));
+    root->setProperty ("blocks", snapshot.numBlocks);
+    root->setProperty ("deadline_misses", snapshot.deadlineMisses);
+    root->setProperty ("dropped_blocks", snapshot.droppedBlocks);
+    root->setProperty ("window_blocks", snapshot.windowSize);
+
+    return file.replaceWithText (juce::JSON::toString (juce::var (root)) + "\n");
+}
+
+//==============================================================================
+CommandStressTest::Result CommandStressTest::run()
+{
+    Result result;
+    runQueue (result);
+    runProcessor (result);
+    return result;
+}
+
+void CommandStressTest::runQueue (Result& result)
+{
+    CommandQueue queue;
+    std::atomic<juce::int64> rejected {0};
+    std::vector<std::thread> producers;
+
+    // each producer numbers its own commands, the value says whose they are
+    for (int p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back ([&, p]
+        {
+            for (int i = 0; i < commandsPerProducer; ++i)
+            {
+                while (! queue.push ({ Command::Type::clear, (juce::int64) i, (float) p }))
+                {
+                    rejected.fetch_add (1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<juce::int64> nextExpected ((size_t) numProducers, 0);
+    auto total = (juce::int64) numProducers * commandsPerProducer;
+    juce::int64 received = 0;
+    Command command;
+
+    // the one consumer, like the audio thread. give up once the producers are done and the queue stays empty.
+    for (int idlePolls = 0; received < total && idlePolls < 1000;)
+    {
+        if (! queue.pop (command))
+        {
+            ++idlePolls;
+            std::this_thread::yield();
+            continue;
+        }
+
+        idlePolls = 0;
+        ++received;
+
+        auto producer = juce::jlimit (0, numProducers - 1, (int) command.value);
+
+        if (command.samplePosition != nextExpected[(size_t) producer])
+            ++result.queueOutOfOrder;
+
+        nextExpected[(size_t) producer] = command.samplePosition + 1;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    while (queue.pop (command))
+        ++received;
+
+    result.queuePushed = total;
+    result.queueRejected = rejected.load();
+    result.queueLost = total - received;
+}
+
+void CommandStressTest::runProcessor (Result& result)
+{
+    constexpr int numChannels = 2;
+
+    OfflineRenderer renderer;
+
+    if (! renderer.prepare (sampleRate, numChannels, blockSize))
+        return;
+
+    auto& processor = renderer.getProcessor();
+    std::atomic<bool> stop {false};
+    std::atomic<juce::int64> posted {0}, rejected {0};
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back ([&, p]
+        {
+            juce::Random random (0x5eed + p);
+
+            while (! stop.load (std::memory_order_relaxed))
+            {
+                // anything from a block ago to a block ahead, so some land mid-block and some are already late
+                Command command;
+                command.type = (Command::Type) random.nextInt (6);
+                command.samplePosition = processor.getSamplePositionNow() + random.nextInt (2 * blockSize) - blockSize;
+                command.value = random.nextFloat();
+
+                if (processor.postCommand (command))
+                    posted.fetch_add (1, std::memory_order_relaxed);
+                else
+                    rejected.fetch_add (1, std::memory_order_relaxed);
+
+                std::this_thread::sleep_for (std::chrono::microseconds (random.nextInt (200)));
+            }
+        });
+    }
+
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::Random random (0x5eed);
+    auto numBlocks = juce::jmax (1, (int) ((double) commandsPerProducer / 1000.0 * sampleRate / blockSize));
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int s = 0; s < blockSize; ++s)
+                block.setSample (channel, s, random.nextFloat() * 2.0f - 1.0f);
+
+        renderer.process (block);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int s = 0; s < blockSize; ++s)
+                if (! std::isfinite (block.getSample (channel, s)))
+                    result.outputFinite = false;
+    }
+
+    stop = true;
+
+    for (auto& producer : producers)
+        producer.join();
+
+    result.processorPosted = posted.load();
+    result.processorRejected = rejected.load();
+    result.processorBlocks = numBlocks;
+}
+
+void CommandStressTest::print (const Result& result)
+{
+    std::cout << "queue: " << result.queuePushed << " commands pushed, " << result.queueRejected << " pushes retried on a full queue, "
+              << result.queueLost << " lost, " << result.queueOutOfOrder << " out of order" << std::endl
+              << "processor: " << result.processorPosted << " commands over " << result.processorBlocks << " blocks, "
+              << result.processorRejected << " rejected, output " << (result.outputFinite ? "finite" : "NOT finite") << std::endl
+              << (result.passed() ? "passed" : "FAILED") << std::endl;
+}
+
+//==============================================================================
+juce::Array<StateBenchmark::Result> StateBenchmark::run()
+{
+    juce::Array<Result> results;
+
+    for (auto maxDelay : maxDelaySeconds)
+    {
+        results.add (runOne (maxDelay, false));
+        results.add (runOne (maxDelay, true));
+    }
+
+    return results;
+}
+
+StateBenchmark::Result StateBenchmark::runOne (double maxDelay, bool decaying)
+{
+    Result result;
+    result.signal = decaying ? "decaying tail" : "white noise";
+
+    // the shortest MAX_DELAY choice that holds maxDelay
+    auto maxDelayIndex = 0;
+
+    while (maxDelayIndex < NewProjectAudioProcessor::getMaxDelayNames().size() - 1
+            && NewProjectAudioProcessor::getMaxDelaySeconds (maxDelayIndex) < maxDelay)
+        ++maxDelayIndex;
+
+    OfflineRenderer source;
+    source.setParameter ("MAX_DELAY", (float) maxDelayIndex);
+
+    if (! source.prepare (sampleRate, numChannels, blockSize))
+        return result;
+
+    auto& processor = source.getProcessor();
+
+    juce::MemoryBlock state;
+    processor.getStateInformation (state);
+    result.parameterBytes = state.getSize();
+
+    source.setParameter ("BUFFER_SNAPSHOT", 1.0f);
+
+    // enough to fill the whole ring, which is a power of two and so longer than MAX_DELAY
+    auto bufferSeconds = juce::nextPowerOfTwo ((int) (NewProjectAudioProcessor::getMaxDelaySeconds (maxDelayIndex) * sampleRate) + 1) / sampleRate;
+    auto numSamples = (int) (bufferSeconds * sampleRate) + blockSize;
+    result.bufferSeconds = bufferSeconds;
+
+    // the tail falls 120 dB over the buffer, the newest half of it is close to silence
+    juce::AudioBuffer<float> input (numChannels, numSamples);
+    juce::Random random (0x5eed);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < numSamples; ++i)
+            input.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f)
+                                             * (decaying ? std::pow (10.0f, -6.0f * (float) i / (float) numSamples) : 1.0f));
+
+    source.process (input);
+
+    // saving, as a host does it while the audio runs
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < repeats; ++i)
+        processor.getStateInformation (state);
+
+    result.saveMs = (juce::Time::getMillisecondCounterHiRes() - start) / repeats;
+    result.stateBytes = state.getSize();
+
+    // restoring into a processor that's playing: the snapshot is decoded into a new buffer and offered to the
+    // audio thread. preparing again in between drops the offer, so each restore does the whole job.
+    OfflineRenderer target;
+    target.prepare (sampleRate, numChannels, blockSize);
+
+    for (int i = 0; i < repeats; ++i)
+    {
+        target.prepare (sampleRate, numChannels, blockSize);
+
+        auto restoreStart = juce::Time::getMillisecondCounterHiRes();
+        target.getProcessor().setStateInformation (state.getData(), (int) state.getSize());
+        result.restoreMs += juce::Time::getMillisecondCounterHiRes() - restoreStart;
+    }
+
+    result.restoreMs /= repeats;
+
+    // restored before it's prepared, the snapshot goes straight into the new buffer. saved again it's the same bytes.
+    OfflineRenderer roundTrip;
+    roundTrip.getProcessor().setStateInformation (state.getData(), (int) state.getSize());
+    roundTrip.prepare (sampleRate, numChannels, blockSize);
+
+    juce::MemoryBlock restored;
+    roundTrip.getProcessor().getStateInformation (restored);
+    result.roundTripMatched = restored == state;
+
+    return result;
+}
+
+void StateBenchmark::print (const juce::Array<Result>& results) const
+{
+    std::cout << juce::String ("signal").paddedRight (' ', 16)
+              << juce::String ("buffer s").paddedLeft (' ', 10)
+              << juce::String ("params B").paddedLeft (' ', 10)
+              << juce::String ("state KiB").paddedLeft (' ', 11)
+              << juce::String ("ratio").paddedLeft (' ', 7)
+              << juce::String ("save ms").paddedLeft (' ', 9)
+              << juce::String ("restore ms").paddedLeft (' ', 12)
+              << juce::String ("x" + juce::String (numInstances) + " MiB").paddedLeft (' ', 11)
+              << juce::String ("x" + juce::String (numInstances) + " s").paddedLeft (' ', 9)
+              << juce::String ("round trip").paddedLeft (' ', 12) << std::endl;
+
+    for (auto& r : results)
+    {
+        auto rawBytes = r.bufferSeconds * sampleRate * numChannels * sizeof (float);
+
+        std::cout << r.signal.paddedRight (' ', 16)
+                  << juce::String (r.bufferSeconds, 2).paddedLeft (' ', 10)
+                  << juce::String ((juce::int64) r.parameterBytes).paddedLeft (' ', 10)
+                  << juce::String ((double) r.stateBytes / 1024.0, 1).paddedLeft (' ', 11)
+                  << juce::String ((double) r.stateBytes / rawBytes, 3).paddedLeft (' ', 7)
+                  << juce::String (r.saveMs, 2).paddedLeft (' ', 9)
+                  << juce::String (r.restoreMs, 2).paddedLeft (' ', 12)
+                  << juce::String ((double) r.stateBytes * numInstances / (1024.0 * 1024.0), 1).paddedLeft (' ', 11)
+                  << juce::String ((r.saveMs + r.restoreMs) * numInstances / 1000.0, 2).paddedLeft (' ', 9)
+                  << juce::String (r.roundTripMatched ? "same" : "DIFFERENT").paddedLeft (' ', 12) << std::endl;
+    }
+}
@@ -0,0 +1,479 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    Throughput numbers for the delay DSP, measured through processBlock().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/DelayRing.h"
+#include "../../Source/FractionalDelayReader.h"
+#include "../../Source/FeedbackDelayNetwork.h"
+#include "../../Source/MultiTapDelay.h"
+#include "../../Source/Saturator.h"
+#include "../../Source/RealtimeProfiler.h"
+#include "../../Source/CommandQueue.h"
+#include "../../Source/PartitionedConvolver.h"
+#include "../../Source/WorkerPool.h"
+#include "../../Source/ModulatedDelay.h"
+#include "../../Source/FeedbackFilter.h"
+#include "../../Source/Ducker.h"
+#include "../../Source/GranularDelay.h"
+#include "../../Source/PitchShifter.h"
+
+//==============================================================================
+/**
+    One row of the throughput table.
+*/
+struct BenchmarkResult
+{
+    int blockSize {0};
+    double sampleRate {0.0};
+    int numChannels {0};
+
+    double samplesPerSecond {0.0}; // processed samples (frames * channels) per wall-clock second
+    double nanosPerSample {0.0};
+    double realtimeFactor {0.0};   // seconds of audio processed per wall-clock second
+};
+
+//==============================================================================
+/**
+    Sweeps block size, sample rate and channel count and times processBlock()
+    on white noise with the current default parameters.
+*/
+class ThroughputBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    juce::Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0, 384000.0 };
+    juce::Array<int> channelCounts { 1, 2 };
+
+    double secondsOfAudio {10.0}; // audio rendered per configuration, after warm-up
+    juce::StringPairArray parameters; // parameter ID -> real-world value, applied before each run
+
+    juce::Array<BenchmarkResult> run();
+
+    static void printTable (const juce::Array<BenchmarkResult>& results);
+    static bool writeCsv (const juce::Array<BenchmarkResult>& results, const juce::File& file);
+
+private:
+    BenchmarkResult runOne (double sampleRate, int numChannels, int blockSize);
+};
+
+//==============================================================================
+/**
+    One row of a kernel micro-benchmark: a named kernel at one block size.
+*/
+struct KernelResult
+{
+    juce::String name;
+    int blockSize {0};
+    double nanosPerSample {0.0};
+    double percentOfCore {0.0}; // share of one core needed to keep up in real time
+    int group {0};              // rows are only compared within the same block size and group
+};
+
+// prints kernel timings, with each row relative to the first row of the same block size and group
+void printKernelTable (const juce::Array<KernelResult>& results);
+
+//==============================================================================
+/**
+    Times each FractionalDelayReader interpolator against the original
+    whole-sample addFrom() read, on a 4 second mono delay buffer with a new
+    random delay time every block.
+*/
+class InterpolatorBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512, 4096 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the feedback delay network for every line count and mixing matrix,
+    on stereo white noise.
+*/
+class FdnBenchmark
+{
+public:
+    int blockSize {512};
+    double sampleRate {96000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the single-pass multi-tap read against reading the block once per
+    tap, for each tap count, with the taps spread over a 2 second stereo
+    delay buffer.
+*/
+class MultiTapBenchmark
+{
+public:
+    juce::Array<int> tapCounts { 8, 32, 64 };
+    int blockSize {512};
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times a write, a whole-sample read and a write position update on the
+    original two-segment circular buffer and on the mirrored power-of-two
+    DelayRing, stereo, with a new random delay time every block.
+*/
+class RingBufferBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 16, 64, 256, 1024, 4096 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the plain delay line the way it used to run, as separate passes
+    over each channel (write the input, add the echo, write again for the
+    feedback, apply the main gain), against the fused kernel that does it
+    all in one. Stereo, with a new random delay longer than the block every
+    block.
+*/
+class DelayLineBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512, 2048 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the delay line for growing channel counts, one channel at a time
+    against every channel in one call: hermite with the delay ramping, where
+    the read position and weights are shared between channels, the allpass,
+    where the channels' recursions overlap, and hermite with a steady delay
+    for comparison. Each row is per frame, so for N independent passes it
+    grows N times with the channel count.
+*/
+class ChannelScalingBenchmark
+{
+public:
+    juce::Array<int> channelCounts { 1, 2, 6, 12, 16 };
+    int blockSize {512};
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times processBlock() with PARALLEL on, sharing the wet path's channels
+    between one thread (the audio thread on its own) and every worker of the
+    pool plus the audio thread, in the modes with heavy per-channel work:
+    oversampled saturation and convolution with a long impulse response.
+    The first row of each group has PARALLEL off. The times are wall clock,
+    which is what the deadline sees, so "% core" is the share of the block's
+    time the render took rather than the CPU it used.
+
+    Sharing the work out mustn't change a sample, so each run's output is
+    also checked against the single-threaded one.
+*/
+class ParallelScalingBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 256, 1024 };
+    int numChannels {16};
+    int maxThreads {0}; // 0 for all of the pool's workers plus the audio thread
+    double impulseSeconds {2.0};
+    double sampleRate {48000.0};
+    double secondsOfAudio {5.0};
+
+    juce::Array<KernelResult> run();
+
+private:
+    // ns per frame. output is the last block rendered.
+    double runOne (const juce::StringPairArray& parameters, const juce::File& impulseFile, int blockSize, juce::AudioBuffer<float>& output);
+};
+
+//==============================================================================
+/**
+    Checks processBlock() in plain delay mode against a reference model
+    written the slow, obvious way, one sample at a time: y[n] = x[n] + wet *
+    y[n - delay] and output = gain * y[n]. Covers every channel, whole and
+    fractional (linear) delays, delays shorter and longer than the block and
+    block sizes that don't divide the delay.
+*/
+class DelayRegressionTest
+{
+public:
+    juce::Array<int> blockSizes { 32, 512, 1000 };
+    juce::Array<double> delaysInSamples { 7.0, 100.0, 4410.0, 4410.5 };
+    double sampleRate {44100.0};
+    int numChannels {2};
+    double secondsOfAudio {1.0};
+    double tolerance {1.0e-5};
+
+    struct Result
+    {
+        juce::String interpolation;
+        int blockSize {0};
+        double delayInSamples {0.0};
+        double maxError {0.0};
+    };
+
+    juce::Array<Result> run();
+
+    void print (const juce::Array<Result>& results) const;
+    bool passed (const juce::Array<Result>& results) const;
+
+private:
+    Result runOne (InterpolationType type, int blockSize, double delay);
+};
+
+//==============================================================================
+/**
+    Times the saturator at every oversampling factor, stereo, with a drive
+    hot enough that the clipper is working on most samples. Each factor is
+    compared against running the clipper at the base rate.
+*/
+class SaturationBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the partitioned convolver against juce::dsp::Convolution, uniform
+    and non-uniform, on stereo white noise. Without impulse response files
+    it uses a set of synthetic ones: exponentially decaying stereo noise with
+    a room, a hall and a long ambient tail. Every engine runs with no added
+    latency.
+*/
+class ConvolutionBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512 };
+    juce::Array<double> impulseSeconds { 0.5, 2.0, 6.0 }; // the synthetic set, unless files are given
+    juce::Array<juce::File> impulseFiles;
+    int partitionSize {256};
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+
+private:
+    void runOne (const juce::String& name, const juce::AudioBuffer<float>& impulse, int group, juce::Array<KernelResult>& results);
+};
+
+//==============================================================================
+/**
+    Times the modulated read against the plain one, stereo, hermite, on a
+    2 second noise buffer with the delay at 20 ms: a single tap at a fixed
+    delay, a single tap with a delay per sample (the ramped path every voice
+    uses), then the flanger's one voice and the chorus at each voice count.
+    The LFO bank is timed on its own as well, for the oscillators of a stereo
+    chorus at the most voices, against calling std::sin for every sample.
+*/
+class ModulationBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512 };
+    juce::Array<int> voiceCounts { 2, 4, 8 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the feedback filter (low cut, high cut and tilt) with the channels
+    in SIMD lanes against the same cascade run a channel at a time, for each
+    channel count, on white noise. A third row moves the cutoffs every block,
+    the price of recalculating the coefficients under automation.
+*/
+class FeedbackFilterBenchmark
+{
+public:
+    juce::Array<int> channelCounts { 1, 2, 4, 8, 16 };
+    int blockSize {512};
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times mixing a block of echoes into the output with the ducking, stereo,
+    on white noise with bursts so the follower keeps moving: the plain add
+    it replaces, the peak and RMS followers multiplied in as the echoes are
+    added, and the peak follower applied to the echoes in a pass of its own
+    before the add.
+*/
+class DuckingBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the grain engine, stereo, reading 100 ms grains out of a noise
+    filled ring around a 200 ms delay, at each number of grains overlapping
+    per channel (the density is set to give that many). Once at the
+    original pitch, where the grains read whole samples, and once a fifth
+    up, where every read interpolates. Reverse mode's two grains come last.
+*/
+class GranularBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 512 };
+    juce::Array<int> grainCounts { 8, 32, 64, 128 };
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+};
+
+//==============================================================================
+/**
+    Times the pitch shifter's two heads against the plain read, stereo,
+    hermite, on a noise buffer with the delay at 300 ms, for each window
+    size. Then one whole instance, processBlock() on white noise in plain
+    delay mode with PITCH off and on, for the cost per instance.
+
+    printSummary() follows the table with the latency each window adds to
+    the echoes, and what turning PITCH on adds to an instance.
+*/
+class PitchShiftBenchmark
+{
+public:
+    juce::Array<int> blockSizes { 64, 512 };
+    juce::Array<int> windowsMs { 10, 40, 100 };
+    float semitones {12.0f};
+    double sampleRate {48000.0};
+    double secondsOfAudio {10.0};
+
+    juce::Array<KernelResult> run();
+    void printSummary (const juce::Array<KernelResult>& results) const;
+};
+
+//==============================================================================
+/**
+    Renders white noise through processBlock() with the built-in profiler
+    collecting each block, and reports its per-stage percentiles, DSP load
+    and the blocks that would have missed their deadline in real time.
+*/
+class ProfileRun
+{
+public:
+    int blockSize {512};
+    double sampleRate {48000.0};
+    int numChannels {2};
+    double secondsOfAudio {10.0};
+    juce::StringPairArray parameters; // parameter ID -> real-world value
+
+    RealtimeProfiler::Snapshot run();
+
+    static void print (const RealtimeProfiler::Snapshot& snapshot);
+    static bool writeCsv (const RealtimeProfiler::Snapshot& snapshot, const juce::File& file);
+    static bool writeJson (const RealtimeProfiler::Snapshot& snapshot, const juce::File& file);
+};
+
+//==============================================================================
+/**
+    Hammers the command queue from several threads at once. First the queue
+    on its own, with one consumer checking that every producer's commands
+    arrive complete and in order. Then the processor, with the producers
+    posting random timestamped commands while white noise is rendered
+    through it in small blocks.
+*/
+class CommandStressTest
+{
+public:
+    int numProducers {4};
+    int commandsPerProducer {100000};
+    int blockSize {64};
+    double sampleRate {48000.0};
+
+    struct Result
+    {
+        juce::int64 queuePushed {0}, queueRejected {0}, queueLost {0}, queueOutOfOrder {0};
+        juce::int64 processorPosted {0}, processorRejected {0};
+        int processorBlocks {0};
+        bool outputFinite {true};
+
+        bool passed() const { return queueLost == 0 && queueOutOfOrder == 0 && outputFinite; }
+    };
+
+    Result run();
+
+    static void print (const Result& result);
+
+private:
+    void runQueue (Result& result);
+    void runProcessor (Result& result);
+};
+
+//==============================================================================
+/**
+    Times getStateInformation() and setStateInformation() with the buffer
+    snapshot on, for each MAX_DELAY, once with the buffer full of white
+    noise and once holding a tail decaying into silence. Also checks that a
+    state saved, restored into a fresh processor and saved again comes back
+    byte for byte the same.
+*/
+class StateBenchmark
+{
+public:
+    juce::Array<double> maxDelaySeconds { 2.0, 8.0 };
+    double sampleRate {48000.0};
+    int numChannels {2};
+    int blockSize {512};
+    int repeats {10};
+    int numInstances {100}; // the totals are for a session with this many instances
+
+    struct Result
+    {
+        juce::String signal;
+        double bufferSeconds {0.0};       // what the ring holds, MAX_DELAY rounded up to a power of two
+        size_t parameterBytes {0};        // the state with the snapshot off
+        size_t stateBytes {0};
+        double saveMs {0.0}, restoreMs {0.0};
+        bool roundTripMatched {false};
+    };
+
+    juce::Array<Result> run();
+
+    void print (const juce::Array<Result>& results) const;
+
+private:
+    Result runOne (double maxDelay, bool decaying);
+};
@@ -0,0 +1,374 @@
+/*
+  ==============================================================================
+
+    BenchmarkSuite.cpp
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuite.h"
+#include "OfflineRenderer.h"
+#include "../../Source/DelayRing.h"
+#include "../../Source/FractionalDelayReader.h"
+
+//==============================================================================
+juce::String BenchmarkSuite::Entry::getKey() const
+{
+    return name + " / " + juce::String (blockSize) + " / " + juce::String (numChannels) + " ch / "
+         + juce::String (delaySeconds, 3) + " s / " + juce::String ((int) sampleRate);
+}
+
+//==============================================================================
+juce::Array<BenchmarkSuite::Entry> BenchmarkSuite::run()
+{
+    juce::Array<Entry> entries;
+
+    for (auto sampleRate : sampleRates)
+        for (auto numChannels : channelCounts)
+            for (auto blockSize : blockSizes)
+                for (auto delay : delaySeconds)
+                {
+                    runKernels (blockSize, numChannels, delay, sampleRate, entries);
+                    runModes (blockSize, numChannels, delay, sampleRate, entries);
+                }
+
+    return entries;
+}
+
+template <typename Function>
+BenchmarkSuite::Entry BenchmarkSuite::measure (const juce::String& name, int blockSize, int numChannels, double delay, double sampleRate,
+                                               Function&& processOneBlock)
+{
+    auto numBlocks = juce::jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+
+    for (int i = 0; i < juce::jmax (1, numBlocks / 10); ++i)
+        processOneBlock();
+
+    std::vector<double> seconds;
+
+    for (int repeat = 0; repeat < juce::jmax (1, repeats); ++repeat)
+    {
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numBlocks; ++i)
+            processOneBlock();
+
+        seconds.push_back (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+    }
+
+    std::sort (seconds.begin(), seconds.end());
+    auto median = seconds[seconds.size() / 2];
+    auto numFrames = (double) numBlocks * blockSize;
+
+    return { name, blockSize, numChannels, delay, sampleRate, median * 1.0e9 / numFrames, 100.0 * median / (numFrames / sampleRate) };
+}
+
+void BenchmarkSuite::runKernels (int blockSize, int numChannels, double delay, double sampleRate, juce::Array<Entry>& entries)
+{
+    auto delayInSamples = delay * sampleRate;
+
+    juce::AudioBuffer<float> input (numChannels, blockSize);
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::Random random (0x5eed);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    // sized the way the processor sizes it, and full of noise so nothing reads silence or denormals
+    DelayRing ring;
+    ring.setSize (numChannels, (int) std::ceil (delayInSamples) + blockSize + FractionalDelayReader::maxReadSpan,
+                  blockSize + FractionalDelayReader::maxReadSpan);
+
+    for (int position = 0; position < ring.getNumSamples(); position += blockSize)
+        for (int channel = 0; channel < numChannels; ++channel)
+            ring.write (channel, position, input.getReadPointer (channel), blockSize);
+
+    FractionalDelayReader reader;
+    reader.prepare (numChannels);
+
+    int writePosition = 0;
+    std::atomic<juce::int64> samplesWritten {0};
+
+    // the same as the end of every processBlock(): the absolute position for other threads, the masked one for us
+    auto advance = [&]
+    {
+        auto written = samplesWritten.load (std::memory_order_relaxed) + blockSize;
+        samplesWritten.store (written, std::memory_order_release);
+        writePosition = (int) (written & ring.getMask());
+    };
+
+    entries.add (measure ("position update", blockSize, numChannels, delay, sampleRate, advance));
+
+    // every kernel below advances too, it's part of each block and too cheap to take out again
+    entries.add (measure ("fill", blockSize, numChannels, delay, sampleRate, [&]
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            ring.write (channel, writePosition, input.getReadPointer (channel), blockSize);
+
+        advance();
+    }));
+
+    // out of place, otherwise the block decays into denormals
+    entries.add (measure ("gain", blockSize, numChannels, delay, sampleRate, [&]
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply (block.getWritePointer (channel), input.getReadPointer (channel), 0.8f, blockSize);
+
+        advance();
+    }));
+
+    juce::HeapBlock<float> gainRamp ((size_t) blockSize);
+
+    for (int i = 0; i < blockSize; ++i)
+        gainRamp[i] = 0.5f + 0.3f * (float) i / (float) blockSize;
+
+    entries.add (measure ("gain, ramped", blockSize, numChannels, delay, sampleRate, [&]
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply (block.getWritePointer (channel), input.getReadPointer (channel), gainRamp, blockSize);
+
+        advance();
+    }));
+
+    for (auto type : { InterpolationType::none, InterpolationType::linear, InterpolationType::hermite,
+                       InterpolationType::lagrange, InterpolationType::allpass })
+    {
+        auto typeName = FractionalDelayReader::getTypeNames()[(int) type].toLowerCase();
+        auto feedbackDelay = juce::jmax (delayInSamples, FractionalDelayReader::getMinimumFeedbackDelay (type));
+        auto longestRun = FractionalDelayReader::getLongestRun (type, feedbackDelay);
+
+        reader.setType (type);
+        reader.reset();
+
+        // the block is refilled each time, the way a host hands over a new buffer every callback
+        entries.add (measure ("read, " + typeName, blockSize, numChannels, delay, sampleRate, [&]
+        {
+            block.makeCopyOf (input, true);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                reader.addFrom (block.getWritePointer (channel), blockSize, ring.getReadPointer (channel), ring.getMask(),
+                                writePosition, delayInSamples, 0.5f, channel);
+
+            advance();
+        }));
+
+        // fill, read, feedback and gain in one pass, in runs when the delay is shorter than the block
+        entries.add (measure ("delay line, " + typeName, blockSize, numChannels, delay, sampleRate, [&]
+        {
+            block.makeCopyOf (input, true);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                for (int start = 0; start < blockSize; start += longestRun)
+                {
+                    auto numThisRun = juce::jmin (longestRun, blockSize - start);
+
+                    reader.processFeedback (block.getWritePointer (channel) + start, numThisRun, ring.getWritePointer (channel),
+                                            ring.getMask(), writePosition + start, feedbackDelay, 0.5f, nullptr, 0.8f, channel);
+                    ring.commit (channel, writePosition + start, numThisRun);
+                }
+            }
+
+            advance();
+        }));
+    }
+}
+
+void BenchmarkSuite::runModes (int blockSize, int numChannels, double delay, double sampleRate, juce::Array<Entry>& entries)
+{
+    struct Mode
+    {
+        juce::String name;
+        juce::StringPairArray parameters;
+        bool frozen;
+    };
+
+    auto withParameters = [] (std::initializer_list<std::pair<const char*, float>> values)
+    {
+        juce::StringPairArray parameters;
+
+        for (auto& value : values)
+            parameters.set (value.first, juce::String (value.second));
+
+        return parameters;
+    };
+
+    const Mode modes[] {
+        { "processBlock, delay none", withParameters ({ { "MODE", 0.0f }, { "INTERPOLATION", 0.0f } }), false },
+        { "processBlock, delay hermite", withParameters ({ { "MODE", 0.0f }, { "INTERPOLATION", 2.0f } }), false },
+        { "processBlock, saturation 4x", withParameters ({ { "MODE", 0.0f }, { "SATURATION", 1.0f }, { "SATURATION_OVERSAMPLING", 2.0f } }), false },
+        { "processBlock, ping-pong", withParameters ({ { "MODE", 0.0f }, { "ROUTING", 1.0f } }), false },
+        { "processBlock, looper", withParameters ({ { "MODE", 0.0f } }), true },
+        { "processBlock, fdn", withParameters ({ { "MODE", 1.0f } }), false },
+        { "processBlock, multi-tap", withParameters ({ { "MODE", 2.0f } }), false },
+        { "processBlock, pitch shift", withParameters ({ { "MODE", 0.0f }, { "PITCH", 1.0f } }), false },
+        { "processBlock, reverse", withParameters ({ { "MODE", 3.0f } }), false },
+        { "processBlock, granular", withParameters ({ { "MODE", 4.0f } }), false }
+    };
+
+    // the smallest buffer that holds the delay, like a user would pick
+    int maxDelayIndex = 0;
+
+    while (maxDelayIndex < NewProjectAudioProcessor::getMaxDelayNames().size() - 1
+           && NewProjectAudioProcessor::getMaxDelaySeconds (maxDelayIndex) < delay)
+        ++maxDelayIndex;
+
+    juce::AudioBuffer<float> stimulus (numChannels, blockSize);
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::Random random (0x5eed);
+    juce::MidiBuffer midi;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            stimulus.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+    for (auto& mode : modes)
+    {
+        OfflineRenderer renderer;
+        renderer.setParameter ("MAX_DELAY", (float) maxDelayIndex);
+        renderer.setParameter (NewProjectAudioProcessor::getDelayLengthParameterID (maxDelayIndex), (float) delay);
+
+        for (auto& parameterID : mode.parameters.getAllKeys())
+            renderer.setParameter (parameterID, mode.parameters[parameterID].getFloatValue());
+
+        if (! renderer.prepare (sampleRate, numChannels, blockSize))
+            continue;
+
+        auto& processor = renderer.getProcessor();
+
+        if (mode.frozen)
+            processor.postCommand ({ Command::Type::freeze, 0, 1.0f });
+
+        entries.add (measure (mode.name, blockSize, numChannels, delay, sampleRate, [&]
+        {
+            block.makeCopyOf (stimulus, true);
+            processor.processBlock (block, midi);
+        }));
+    }
+}
+
+//==============================================================================
+void BenchmarkSuite::print (const juce::Array<Entry>& entries) const
+{
+    std::cout << juce::String ("kernel").paddedRight (' ', 30)
+              << juce::String ("block").paddedLeft (' ', 7)
+              << juce::String ("ch").paddedLeft (' ', 4)
+              << juce::String ("delay").paddedLeft (' ', 8)
+              << juce::String ("rate").paddedLeft (' ', 8)
+              << juce::String ("ns/frame").paddedLeft (' ', 11)
+              << juce::String ("% core").paddedLeft (' ', 9)
+              << juce::String ("x" + juce::String (numInstances)).paddedLeft (' ', 9) << std::endl;
+
+    for (auto& e : entries)
+    {
+        auto sessionPercent = e.percentOfCore * numInstances;
+
+        std::cout << e.name.paddedRight (' ', 30)
+                  << juce::String (e.blockSize).paddedLeft (' ', 7)
+                  << juce::String (e.numChannels).paddedLeft (' ', 4)
+                  << juce::String (e.delaySeconds, 3).paddedLeft (' ', 8)
+                  << juce::String ((int) e.sampleRate).paddedLeft (' ', 8)
+                  << juce::String (e.nanosPerFrame, 2).paddedLeft (' ', 11)
+                  << juce::String (e.percentOfCore, 3).paddedLeft (' ', 9)
+                  << (juce::String (sessionPercent, 1) + (sessionPercent > 100.0 ? "!" : " ")).paddedLeft (' ', 9) << std::endl;
+    }
+
+    std::cout << "x" << numInstances << ": percent of one core for a session with that many instances, ! over a whole core" << std::endl;
+}
+
+bool BenchmarkSuite::writeJson (const juce::Array<Entry>& entries, const juce::File& file) const
+{
+    juce::Array<juce::var> results;
+
+    for (auto& e : entries)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty ("name", e.name);
+        result->setProperty ("block_size", e.blockSize);
+        result->setProperty ("channels", e.numChannels);
+        result->setProperty ("delay_seconds", e.delaySeconds);
+        result->setProperty ("sample_rate", e.sampleRate);
+        result->setProperty ("ns_per_frame", e.nanosPerFrame);
+        result->setProperty ("percent_of_core", e.percentOfCore);
+        results.add (juce::var (result));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("label", label);
+    root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+    root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+    root->setProperty ("seconds_per_repeat", secondsOfAudio);
+    root->setProperty ("repeats", repeats);
+    root->setProperty ("results", results);
+
+    return file.replaceWithText (juce::JSON::toString (juce::var (root)) + "\n");
+}
+
+bool BenchmarkSuite::readJson (const juce::File& file, juce::Array<Entry>& entries)
+{
+    auto root = juce::JSON::parse (file);
+    auto* results = root["results"].getArray();
+
+    if (results == nullptr)
+        return false;
+
+    for (auto& result : *results)
+        entries.add ({ result["name"].toString(), (int) result["block_size"], (int) result["channels"],
+                       (double) result["delay_seconds"], (double) result["sample_rate"],
+                       (double) result["ns_per_frame"], (double) result["percent_of_core"] });
+
+    return true;
+}
+
+juce::Array<BenchmarkSuite::Comparison> BenchmarkSuite::compare (const juce::Array<Entry>& before, const juce::Array<Entry>& after)
+{
+    juce::Array<Comparison> comparisons;
+    std::map<juce::String, double> beforeByKey;
+
+    for (auto& e : before)
+        beforeByKey[e.getKey()] = e.nanosPerFrame;
+
+    for (auto& e : after)
+    {
+        auto key = e.getKey();
+        auto found = beforeByKey.find (key);
+        auto beforeNanos = found != beforeByKey.end() ? found->second : 0.0;
+
+        comparisons.add ({ key, beforeNanos, e.nanosPerFrame,
+                           beforeNanos > 0.0 ? 100.0 * (e.nanosPerFrame - beforeNanos) / beforeNanos : 0.0 });
+
+        if (found != beforeByKey.end())
+            beforeByKey.erase (found);
+    }
+
+    for (auto& [key, beforeNanos] : beforeByKey)
+        comparisons.add ({ key, beforeNanos, 0.0, 0.0 });
+
+    std::stable_sort (comparisons.begin(), comparisons.end(),
+                      [] (const Comparison& a, const Comparison& b) { return a.change > b.change; });
+
+    return comparisons;
+}
+
+void BenchmarkSuite::printComparison (const juce::Array<Comparison>& comparisons, double thresholdPercent)
+{
+    std::cout << juce::String ("kernel / block / channels / delay / rate").paddedRight (' ', 60)
+              << juce::String ("before").paddedLeft (' ', 10)
+              << juce::String ("after").paddedLeft (' ', 10)
+              << juce::String ("change").paddedLeft (' ', 10) << std::endl;
+
+    for (auto& c : comparisons)
+    {
+        auto change = c.before == 0.0 ? juce::String ("new")
+                    : c.after == 0.0 ? juce::String ("gone")
+                    : (c.change > 0.0 ? "+" : "") + juce::String (c.change, 1) + "%";
+
+        std::cout << c.key.paddedRight (' ', 60)
+                  << juce::String (c.before, 2).paddedLeft (' ', 10)
+                  << juce::String (c.after, 2).paddedLeft (' ', 10)
+                  << change.paddedLeft (' ', 10)
+                  << (c.change > thresholdPercent ? "  REGRESSED" : "") << std::endl;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    BenchmarkSuite.h
+    The cost of every DSP kernel and engine mode over a grid of
+    configurations, saved as JSON so runs can be compared over time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    For every block size, channel count, delay length and sample rate it
+    times the delay's kernels on their own (fill, read, position update,
+    gain and the fused delay line) and then processBlock() in each engine
+    mode. Every entry is the median of several repeats, so one preempted
+    repeat doesn't turn into a regression.
+
+    The results are written as JSON with the machine they were measured on.
+    compare() matches two result files entry by entry, which is how a change
+    is held to the CPU budget: a session with a few hundred instances can
+    only afford a fraction of a percent of a core each.
+*/
+class BenchmarkSuite
+{
+public:
+    juce::Array<int> blockSizes { 64, 512 };
+    juce::Array<int> channelCounts { 1, 2 };
+    juce::Array<double> delaySeconds { 0.01, 0.5 };
+    juce::Array<double> sampleRates { 48000.0, 96000.0 };
+    double secondsOfAudio {1.0}; // per repeat
+    int repeats {5};
+    int numInstances {200};      // the budget the table reports against
+    juce::String label;          // saved with the results, e.g. a commit hash
+
+    struct Entry
+    {
+        juce::String name;
+        int blockSize {0};
+        int numChannels {0};
+        double delaySeconds {0.0};
+        double sampleRate {0.0};
+
+        double nanosPerFrame {0.0};
+        double percentOfCore {0.0}; // share of one core needed to keep up in real time
+
+        // identifies the same measurement in another result file
+        juce::String getKey() const;
+    };
+
+    struct Comparison
+    {
+        juce::String key;
+        double before {0.0}, after {0.0}; // ns per frame, 0 when the entry is only on one side
+        double change {0.0};              // percent, positive is slower
+    };
+
+    juce::Array<Entry> run();
+
+    void print (const juce::Array<Entry>& entries) const;
+    bool writeJson (const juce::Array<Entry>& entries, const juce::File& file) const;
+
+    // false if the file isn't a result file
+    static bool readJson (const juce::File& file, juce::Array<Entry>& entries);
+
+    // every entry of either run, the largest slowdown first
+    static juce::Array<Comparison> compare (const juce::Array<Entry>& before, const juce::Array<Entry>& after);
+    static void printComparison (const juce::Array<Comparison>& comparisons, double thresholdPercent);
+
+private:
+    void runKernels (int blockSize, int numChannels, double delay, double sampleRate, juce::Array<Entry>& entries);
+    void runModes (int blockSize, int numChannels, double delay, double sampleRate, juce::Array<Entry>& entries);
+
+    // the median of the repeats of processOneBlock(), as an entry
+    template <typename Function>
+    Entry measure (const juce::String& name, int blockSize, int numChannels, double delay, double sampleRate, Function&& processOneBlock);
+};
@@ -0,0 +1,478 @@
+/*
+  ==============================================================================
+
+    GoldenOutputTest.cpp
+
+  ==============================================================================
+*/
+
+#include "GoldenOutputTest.h"
+#include "OfflineRenderer.h"
+
+//==============================================================================
+std::vector<GoldenOutputTest::Case> GoldenOutputTest::getCases()
+{
+    // a 1 s MAX_DELAY keeps the ring at 65536 samples at 44.1k, so two seconds of audio wraps it at least once.
+    // everything else is set explicitly, the goldens shouldn't change when a default does.
+    auto delayMode = [] (float delaySeconds, int interpolation, float wetGain, float gain)
+    {
+        juce::StringPairArray parameters;
+        parameters.set ("MODE", "0");
+        parameters.set ("MAX_DELAY", "0");
+        parameters.set ("DELAY_LENGTH", juce::String (delaySeconds, 6));
+        parameters.set ("INTERPOLATION", juce::String (interpolation));
+        parameters.set ("WET_GAIN", juce::String (wetGain, 6));
+        parameters.set ("GAIN", juce::String (gain, 6));
+        return parameters;
+    };
+
+    std::vector<Case> cases;
+
+    // echoes of a single sample, whole-sample and fractional reads
+    cases.push_back ({ "impulse-none", Stimulus::impulse, 2.0, delayMode (0.25f, 0, 0.7f, 0.9f), {} });
+    cases.push_back ({ "impulse-hermite", Stimulus::impulse, 2.0, delayMode (0.123457f, 2, 0.7f, 0.9f), {} });
+    cases.push_back ({ "impulse-allpass", Stimulus::impulse, 2.0, delayMode (0.0771f, 4, 0.8f, 1.0f), {} });
+
+    // a delay just under the buffer, every read is from the other side of the wrap
+    cases.push_back ({ "clicks-long-delay", Stimulus::clicks, 3.0, delayMode (0.95f, 1, 0.6f, 1.0f), {} });
+
+    cases.push_back ({ "sine-linear", Stimulus::sine, 2.0, delayMode (0.3f, 1, 0.5f, 0.8f), {} });
+    cases.push_back ({ "sine-lagrange", Stimulus::sine, 2.0, delayMode (0.0413f, 3, 0.5f, 0.8f), {} });
+
+    // shorter than most of the block sizes, the feedback is read back from inside the block
+    cases.push_back ({ "noise-short-delay", Stimulus::noise, 2.0, delayMode (0.0007f, 1, 0.6f, 0.8f), {} });
+
+    // the echoes bounce between the channels
+    auto pingPong = delayMode (0.2f, 0, 0.6f, 0.8f);
+    pingPong.set ("ROUTING", "1");
+    pingPong.set ("ROUTING_AMOUNT", "1");
+    cases.push_back ({ "noise-ping-pong", Stimulus::noise, 2.0, pingPong, {} });
+
+    // automation sweeps, the delay time glides and the gains ramp
+    cases.push_back ({ "noise-delay-sweep", Stimulus::noise, 2.5, delayMode (0.05f, 2, 0.5f, 0.8f),
+                       { { "DELAY_LENGTH", 0.4, 0.3f }, { "DELAY_LENGTH", 0.9, 0.01f }, { "DELAY_LENGTH", 1.3, 0.6f },
+                         { "DELAY_LENGTH", 1.31, 0.2f }, { "DELAY_LENGTH", 2.0, 0.7f } } });
+
+    cases.push_back ({ "sine-gain-sweep", Stimulus::sine, 2.0, delayMode (0.1f, 1, 0.5f, 1.0f),
+                       { { "GAIN", 0.3, 0.2f }, { "WET_GAIN", 0.5, 0.9f }, { "GAIN", 0.7, 1.0f },
+                         { "WET_GAIN", 1.1, 0.0f }, { "WET_GAIN", 1.5, 0.6f }, { "GAIN", 1.5, 0.5f } } });
+
+    return cases;
+}
+
+//==============================================================================
+bool GoldenOutputTest::record()
+{
+    if (! directory.createDirectory())
+        return false;
+
+    juce::WavAudioFormat wavFormat;
+
+    for (auto& testCase : getSelectedCases())
+    {
+        juce::AudioBuffer<float> output;
+
+        if (! render (testCase, referenceBlockSize, output))
+            return false;
+
+        auto file = getGoldenFile (testCase);
+        file.deleteFile();
+
+        std::unique_ptr<juce::FileOutputStream> outputStream (file.createOutputStream());
+
+        if (outputStream == nullptr)
+            return false;
+
+        // 32-bit float, it reads back exactly what was rendered
+        std::unique_ptr<juce::AudioFormatWriter> writer (wavFormat.createWriterFor (outputStream.get(), sampleRate, (unsigned int) numChannels, 32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        outputStream.release();
+
+        if (! writer->writeFromAudioSampleBuffer (output, 0, output.getNumSamples()))
+            return false;
+
+        std::cout << "recorded " << file.getFullPathName() << std::endl;
+    }
+
+    return true;
+}
+
+juce::Array<GoldenOutputTest::Result> GoldenOutputTest::run()
+{
+    juce::Array<Result> results;
+    juce::WavAudioFormat wavFormat;
+
+    for (auto& testCase : getSelectedCases())
+    {
+        juce::AudioBuffer<float> golden;
+        auto fromModel = false;
+
+        // only when asked, a golden file that isn't there is a failure rather than something to stand in for
+        if (againstModel)
+            fromModel = renderReference (testCase, golden);
+        else if (auto* input = getGoldenFile (testCase).createInputStream().release())
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (wavFormat.createReaderFor (input, true));
+
+            if (reader != nullptr && (int) reader->numChannels == numChannels && reader->sampleRate == sampleRate)
+            {
+                golden.setSize (numChannels, (int) reader->lengthInSamples);
+                reader->read (&golden, 0, golden.getNumSamples(), 0, true, true);
+            }
+        }
+
+        for (auto blockSize : blockSizes)
+        {
+            Result result;
+            result.caseName = testCase.name;
+            result.blockSize = blockSize;
+            result.fromModel = fromModel;
+
+            juce::AudioBuffer<float> output;
+
+            if (golden.getNumSamples() == 0)
+            {
+                result.missing = true;
+            }
+            else if (! render (testCase, blockSize, output) || output.getNumSamples() != golden.getNumSamples())
+            {
+                result.maxError = std::numeric_limits<double>::infinity();
+                result.firstMismatch = 0;
+            }
+            else
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    auto* expected = golden.getReadPointer (channel);
+                    auto* actual = output.getReadPointer (channel);
+
+                    for (int i = 0; i < output.getNumSamples(); ++i)
+                    {
+                        auto error = (double) std::abs (actual[i] - expected[i]);
+
+                        // a nan fails the comparison either way round
+                        if (! (error <= tolerance) && (result.firstMismatch < 0 || i < result.firstMismatch))
+                            result.firstMismatch = i;
+
+                        result.maxError = std::isnan (error) ? std::numeric_limits<double>::infinity()
+                                                             : juce::jmax (result.maxError, error);
+                    }
+                }
+            }
+
+            results.add (result);
+        }
+    }
+
+    return results;
+}
+
+void GoldenOutputTest::print (const juce::Array<Result>& results) const
+{
+    std::cout << juce::String ("case").paddedRight (' ', 22)
+              << juce::String ("against").paddedLeft (' ', 9)
+              << juce::String ("block").paddedLeft (' ', 7)
+              << juce::String ("max error").paddedLeft (' ', 14)
+              << juce::String ("first bad").paddedLeft (' ', 11)
+              << juce::String ("result").paddedLeft (' ', 9) << std::endl;
+
+    for (auto& r : results)
+    {
+        auto status = r.missing ? "missing" : r.maxError == 0.0 ? "exact" : r.maxError <= tolerance ? "ok" : "FAILED";
+
+        std::cout << r.caseName.paddedRight (' ', 22)
+                  << juce::String (r.missing ? "-" : r.fromModel ? "model" : "golden").paddedLeft (' ', 9)
+                  << juce::String (r.blockSize).paddedLeft (' ', 7)
+                  << (r.missing ? juce::String ("-") : juce::String (r.maxError, 10)).paddedLeft (' ', 14)
+                  << (r.firstMismatch < 0 ? juce::String ("-") : juce::String (r.firstMismatch)).paddedLeft (' ', 11)
+                  << juce::String (status).paddedLeft (' ', 9) << std::endl;
+    }
+
+    for (auto& r : results)
+    {
+        if (r.missing)
+        {
+            if (againstModel)
+                std::cout << "the model can't render every case, check those against golden outputs" << std::endl;
+            else
+                std::cout << "no golden output in " << directory.getFullPathName() << ", record them from a known-good build with --record" << std::endl;
+
+            break;
+        }
+    }
+}
+
+bool GoldenOutputTest::passed (const juce::Array<Result>& results) const
+{
+    for (auto& r : results)
+        if (r.missing || ! (r.maxError <= tolerance))
+            return false;
+
+    return ! results.isEmpty();
+}
+
+//==============================================================================
+std::vector<GoldenOutputTest::Case> GoldenOutputTest::getSelectedCases() const
+{
+    std::vector<Case> selected;
+
+    for (auto& testCase : getCases())
+        if (caseNames.isEmpty() || caseNames.contains (testCase.name))
+            selected.push_back (testCase);
+
+    return selected;
+}
+
+juce::File GoldenOutputTest::getGoldenFile (const Case& testCase) const
+{
+    return directory.getChildFile (testCase.name + ".wav");
+}
+
+juce::AudioBuffer<float> GoldenOutputTest::makeStimulus (const Case& testCase) const
+{
+    auto numSamples = (int) (testCase.seconds * sampleRate);
+    juce::AudioBuffer<float> stimulus (numChannels, numSamples);
+    stimulus.clear();
+
+    // each channel a little different, so a channel mix-up can't hide
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = stimulus.getWritePointer (channel);
+
+        switch (testCase.stimulus)
+        {
+            case Stimulus::impulse:
+                samples[channel] = 1.0f;
+                break;
+
+            case Stimulus::sine:
+            {
+                auto frequency = 220.0 * (channel + 2);
+
+                for (int i = 0; i < numSamples; ++i)
+                    samples[i] = 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * frequency * i / sampleRate);
+
+                break;
+            }
+
+            case Stimulus::noise:
+            {
+                juce::Random random (0x5eed + channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    samples[i] = random.nextFloat() * 2.0f - 1.0f;
+
+                break;
+            }
+
+            case Stimulus::clicks:
+            {
+                // every 0.3 s, a prime number of samples off so they don't line up with a block
+                for (int i = channel; i < numSamples; i += 13229)
+                    samples[i] = 1.0f;
+
+                break;
+            }
+        }
+    }
+
+    return stimulus;
+}
+
+bool GoldenOutputTest::render (const Case& testCase, int blockSize, juce::AudioBuffer<float>& output) const
+{
+    // parameters before prepare, so the ramps start at them instead of gliding in from the defaults
+    OfflineRenderer renderer;
+
+    for (auto& parameterID : testCase.parameters.getAllKeys())
+        if (! renderer.setParameter (parameterID, testCase.parameters[parameterID].getFloatValue()))
+            return false;
+
+    for (auto& point : testCase.automation)
+        if (! renderer.addAutomationPoint (point.parameterID, (juce::int64) (point.seconds * sampleRate), point.value))
+            return false;
+
+    if (! renderer.prepare (sampleRate, numChannels, blockSize))
+        return false;
+
+    output = makeStimulus (testCase);
+    renderer.process (output);
+    return true;
+}
+
+bool GoldenOutputTest::renderReference (const Case& testCase, juce::AudioBuffer<float>& output) const
+{
+    // the plain delay, its gains and ping-pong. anything else the model doesn't do.
+    const juce::StringArray modelled { "MODE", "MAX_DELAY", "DELAY_LENGTH", "INTERPOLATION", "WET_GAIN", "GAIN", "ROUTING", "ROUTING_AMOUNT" };
+    const juce::StringArray ramped { "DELAY_LENGTH", "WET_GAIN", "GAIN" };
+
+    for (auto& parameterID : testCase.parameters.getAllKeys())
+        if (! modelled.contains (parameterID))
+            return false;
+
+    for (auto& point : testCase.automation)
+        if (! ramped.contains (point.parameterID))
+            return false;
+
+    // only for the parameters' ranges and defaults, it never processes anything
+    OfflineRenderer renderer;
+    auto& apvts = renderer.getProcessor().apvts;
+
+    // what the processor reads back after the range has snapped the value
+    auto snapped = [&apvts] (const juce::String& parameterID, float value)
+    {
+        auto* parameter = apvts.getParameter (parameterID);
+        return parameter->convertFrom0to1 (parameter->convertTo0to1 (value));
+    };
+
+    auto initial = [&] (const juce::String& parameterID)
+    {
+        return testCase.parameters.getAllKeys().contains (parameterID) ? snapped (parameterID, testCase.parameters[parameterID].getFloatValue())
+                                                                       : apvts.getRawParameterValue (parameterID)->load();
+    };
+
+    auto routing = (ChannelRouter::Mode) (int) initial ("ROUTING");
+
+    if ((int) initial ("MODE") != 0 || (routing != ChannelRouter::Mode::independent && routing != ChannelRouter::Mode::pingPong))
+        return false;
+
+    auto type = (InterpolationType) (int) initial ("INTERPOLATION");
+    auto pingPong = routing == ChannelRouter::Mode::pingPong;
+    auto amount = pingPong ? initial ("ROUTING_AMOUNT") : 0.0f;
+    auto maxDelay = NewProjectAudioProcessor::getMaxDelaySeconds ((int) initial ("MAX_DELAY")) * sampleRate;
+
+    juce::SmoothedValue<float> mainGain, wetGain;
+    juce::SmoothedValue<double> delay;
+    mainGain.reset (sampleRate, NewProjectAudioProcessor::gainRampSeconds);
+    wetGain.reset (sampleRate, NewProjectAudioProcessor::gainRampSeconds);
+    delay.reset (sampleRate, NewProjectAudioProcessor::delayRampSeconds);
+    mainGain.setCurrentAndTargetValue (initial ("GAIN"));
+    wetGain.setCurrentAndTargetValue (initial ("WET_GAIN"));
+    delay.setCurrentAndTargetValue (juce::jmin ((double) initial ("DELAY_LENGTH") * sampleRate, maxDelay));
+
+    auto automation = testCase.automation;
+    std::stable_sort (automation.begin(), automation.end(), [] (const Automation& a, const Automation& b) { return a.seconds < b.seconds; });
+    size_t nextPoint = 0;
+
+    output = makeStimulus (testCase);
+    auto numSamples = output.getNumSamples();
+
+    // everything fed back, from the start. the processor's ring wraps, but never by less than the delay.
+    juce::AudioBuffer<float> history (numChannels, numSamples);
+    history.clear();
+
+    std::vector<float> allpassStates ((size_t) numChannels, 0.0f);
+    std::vector<float> input ((size_t) numChannels), echoes ((size_t) numChannels);
+
+    auto read = [&] (int channel, double readPosition) -> float
+    {
+        auto* y = history.getReadPointer (channel);
+        auto at = [y] (int index) { return index >= 0 ? y[index] : 0.0f; };
+
+        auto whole = (int) std::floor (readPosition);
+        auto a = (float) (readPosition - whole);
+        auto ym1 = at (whole - 1), y0 = at (whole), y1 = at (whole + 1), y2 = at (whole + 2);
+
+        switch (type)
+        {
+            case InterpolationType::none:
+                return y0;
+
+            case InterpolationType::linear:
+                return y0 + a * (y1 - y0);
+
+            case InterpolationType::hermite:
+            {
+                // catmull-rom
+                auto a2 = a * a, a3 = a2 * a;
+
+                return (-0.5f * a3 + a2 - 0.5f * a) * ym1 + (1.5f * a3 - 2.5f * a2 + 1.0f) * y0
+                       + (-1.5f * a3 + 2.0f * a2 + 0.5f * a) * y1 + (0.5f * a3 - 0.5f * a2) * y2;
+            }
+
+            case InterpolationType::lagrange:
+                return -a * (a - 1.0f) * (a - 2.0f) / 6.0f * ym1 + (a + 1.0f) * (a - 1.0f) * (a - 2.0f) / 2.0f * y0
+                       - (a + 1.0f) * a * (a - 2.0f) / 2.0f * y1 + (a + 1.0f) * a * (a - 1.0f) / 6.0f * y2;
+
+            case InterpolationType::allpass:
+            {
+                // a first-order allpass between the two samples either side, its delay kept in [0.618, 1.618)
+                auto fraction = 1.0f - a;
+                auto newer = y1, older = y0;
+
+                if (fraction < 0.618f)
+                {
+                    fraction += 1.0f;
+                    newer = y2;
+                    older = y1;
+                }
+
+                auto eta = (1.0f - fraction) / (1.0f + fraction);
+                auto& state = allpassStates[(size_t) channel];
+                state = eta * (newer - state) + older;
+                return state;
+            }
+
+            default:
+                break;
+        }
+
+        return 0.0f;
+    };
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // a point lands on its sample, and the ramps start moving from there
+        while (nextPoint < automation.size() && (juce::int64) (automation[nextPoint].seconds * sampleRate) <= n)
+        {
+            auto& point = automation[nextPoint++];
+            auto value = snapped (point.parameterID, point.value);
+
+            if (point.parameterID == "GAIN")
+                mainGain.setTargetValue (value);
+            else if (point.parameterID == "WET_GAIN")
+                wetGain.setTargetValue (value);
+            else
+                delay.setTargetValue (juce::jmin ((double) value * sampleRate, maxDelay));
+        }
+
+        auto gain = mainGain.getNextValue();
+        auto wet = wetGain.getNextValue();
+        auto delayInSamples = juce::jmax (delay.getNextValue(), FractionalDelayReader::getMinimumFeedbackDelay (type));
+
+        if (type == InterpolationType::none)
+            delayInSamples = std::floor (delayInSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            input[(size_t) channel] = output.getSample (channel, n);
+            echoes[(size_t) channel] = wet * read (channel, (double) n - delayInSamples);
+        }
+
+        // ping-pong moves every echo one channel along, and feeds the first line from the input's mono sum
+        if (pingPong)
+            std::rotate (echoes.begin(), echoes.end() - 1, echoes.end());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto feed = input[(size_t) channel];
+
+            if (pingPong && numChannels > 1)
+            {
+                feed *= 1.0f - amount;
+
+                if (channel == 0)
+                    for (auto x : input)
+                        feed += x * (amount / (float) numChannels);
+            }
+
+            history.setSample (channel, n, feed + echoes[(size_t) channel]);
+            output.setSample (channel, n, gain * (input[(size_t) channel] + echoes[(size_t) channel]));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    GoldenOutputTest.h
+    Renders fixed stimuli through processBlock() and compares the result
+    with stored golden outputs, or on request with a sample-by-sample model
+    of the delay.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Each case is a deterministic stimulus (an impulse, a sine, seeded white
+    noise or a click train) with a set of parameters and, optionally,
+    automation. All of them run for longer than the delay buffer, so every
+    case reads and writes across the ring's wrap point.
+
+    Recording renders every case at referenceBlockSize and writes it to the
+    golden directory as a 32-bit float wav. Checking renders every case at
+    each block size (size 1 and odd sizes included) and compares it with its
+    golden file, sample by sample. Anything the DSP core does differently,
+    or differently depending on how the host splits the audio, shows up as
+    an error above the tolerance.
+
+    A case with no golden file is missing, and fails: the goldens are what a
+    known-good build did, and nothing else stands in for them unasked. With
+    againstModel set, every case is compared with renderReference() instead:
+    the plain delay written the slow, obvious way, one sample at a time from
+    a linear history, with every interpolator, the parameter ramps and
+    ping-pong spelled out. It's what the processor did before any of the
+    optimised paths, so it checks a build before there's anything recorded,
+    though only for the cases using parameters the model knows.
+*/
+class GoldenOutputTest
+{
+public:
+    juce::File directory;
+    juce::Array<int> blockSizes { 1, 7, 64, 333, 512, 4096 };
+    int referenceBlockSize {512};
+    double sampleRate {44100.0};
+    int numChannels {2};
+    double tolerance {1.0e-5};
+    juce::StringArray caseNames; // only these cases, all of them when empty
+    bool againstModel {false};   // compare with renderReference() rather than the golden files
+
+    enum class Stimulus
+    {
+        impulse,
+        sine,
+        noise,
+        clicks
+    };
+
+    struct Automation
+    {
+        juce::String parameterID;
+        double seconds;
+        float value;
+    };
+
+    struct Case
+    {
+        juce::String name;
+        Stimulus stimulus;
+        double seconds;
+        juce::StringPairArray parameters; // parameter ID -> real-world value
+        std::vector<Automation> automation;
+    };
+
+    struct Result
+    {
+        juce::String caseName;
+        int blockSize {0};
+        bool missing {false};    // there's no golden file for this case, or with againstModel the model can't render it
+        bool fromModel {false};  // compared with renderReference() rather than a golden file
+        double maxError {0.0};
+        juce::int64 firstMismatch {-1}; // the first sample over the tolerance
+    };
+
+    static std::vector<Case> getCases();
+
+    // writes a golden file for every case, false if one couldn't be written
+    bool record();
+    juce::Array<Result> run();
+
+    void print (const juce::Array<Result>& results) const;
+    bool passed (const juce::Array<Result>& results) const;
+
+private:
+    std::vector<Case> getSelectedCases() const;
+    juce::File getGoldenFile (const Case& testCase) const;
+
+    juce::AudioBuffer<float> makeStimulus (const Case& testCase) const;
+    bool render (const Case& testCase, int blockSize, juce::AudioBuffer<float>& output) const;
+
+    // the expected output from the model, false if the case uses anything beyond the plain delay and ping-pong
+    bool renderReference (const Case& testCase, juce::AudioBuffer<float>& output) const;
+};
@@ -0,0 +1,664 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Command line front end for rendering files and benchmarking the delay DSP
+    without a plugin host.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+#include "Benchmark.h"
+#include "BenchmarkSuite.h"
+#include "GoldenOutputTest.h"
+
+//==============================================================================
+namespace
+{
+    // applies every --param=ID=value argument, e.g. --param=DELAY_LENGTH=0.25
+    juce::StringPairArray getParameterArguments (const juce::ArgumentList& args)
+    {
+        juce::StringPairArray parameters;
+
+        for (auto& arg : args.arguments)
+        {
+            if (arg.text.startsWith ("--param="))
+            {
+                auto assignment = arg.text.fromFirstOccurrenceOf ("--param=", false, false);
+
+                if (! assignment.containsChar ('='))
+                    juce::ConsoleApplication::fail ("Expected --param=ID=value, got " + arg.text);
+
+                parameters.set (assignment.upToFirstOccurrenceOf ("=", false, false),
+                                assignment.fromFirstOccurrenceOf ("=", false, false));
+            }
+        }
+
+        return parameters;
+    }
+
+    // schedules every --automate=ID@seconds=value argument, e.g. --automate=DELAY_LENGTH@2.5=0.125
+    void addAutomationArguments (const juce::ArgumentList& args, OfflineRenderer& renderer, double sampleRate)
+    {
+        for (auto& arg : args.arguments)
+        {
+            if (! arg.text.startsWith ("--automate="))
+                continue;
+
+            auto point = arg.text.fromFirstOccurrenceOf ("--automate=", false, false);
+            auto parameterID = point.upToFirstOccurrenceOf ("@", false, false);
+            auto seconds = point.fromFirstOccurrenceOf ("@", false, false).upToFirstOccurrenceOf ("=", false, false);
+            auto value = point.fromFirstOccurrenceOf ("=", false, false);
+
+            if (! point.containsChar ('@') || ! point.containsChar ('=') || value.isEmpty())
+                juce::ConsoleApplication::fail ("Expected --automate=ID@seconds=value, got " + arg.text);
+
+            if (! renderer.addAutomationPoint (parameterID, (juce::int64) (seconds.getDoubleValue() * sampleRate), value.getFloatValue()))
+                juce::ConsoleApplication::fail ("Unknown parameter " + parameterID);
+        }
+    }
+
+    // posts every --command=type@seconds[=value] argument, e.g. --command=freeze@2.0=1 --command=freeze@6.0=0
+    void addCommandArguments (const juce::ArgumentList& args, OfflineRenderer& renderer, double sampleRate)
+    {
+        const juce::StringArray typeNames { "clear", "freeze", "tap" };
+        const Command::Type types[] { Command::Type::clear, Command::Type::freeze, Command::Type::tapTempo };
+
+        for (auto& arg : args.arguments)
+        {
+            if (! arg.text.startsWith ("--command="))
+                continue;
+
+            auto point = arg.text.fromFirstOccurrenceOf ("--command=", false, false);
+            auto typeIndex = typeNames.indexOf (point.upToFirstOccurrenceOf ("@", false, false));
+            auto seconds = point.fromFirstOccurrenceOf ("@", false, false).upToFirstOccurrenceOf ("=", false, false);
+
+            if (! point.containsChar ('@') || typeIndex < 0)
+                juce::ConsoleApplication::fail ("Expected --command=clear|freeze|tap@seconds[=value], got " + arg.text);
+
+            // timestamped from the start of the render, the processor holds on to them until they're due
+            Command command { types[typeIndex], (juce::int64) (seconds.getDoubleValue() * sampleRate),
+                              point.containsChar ('=') ? point.fromFirstOccurrenceOf ("=", false, false).getFloatValue() : 1.0f };
+
+            if (! renderer.getProcessor().postCommand (command))
+                juce::ConsoleApplication::fail ("Too many commands");
+        }
+    }
+
+    int getIntOption (const juce::ArgumentList& args, const juce::String& option, int defaultValue)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option).getIntValue() : defaultValue;
+    }
+
+    double getDoubleOption (const juce::ArgumentList& args, const juce::String& option, double defaultValue)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option).getDoubleValue() : defaultValue;
+    }
+
+    // turns "16,32,64" into an array, or leaves the defaults alone when the option is absent
+    template <typename Type>
+    void getListOption (const juce::ArgumentList& args, const juce::String& option, juce::Array<Type>& destination)
+    {
+        if (! args.containsOption (option))
+            return;
+
+        destination.clearQuick();
+
+        for (auto& token : juce::StringArray::fromTokens (args.getValueForOption (option), ",", {}))
+            destination.add ((Type) token.getDoubleValue());
+    }
+
+    //==============================================================================
+    void render (const juce::ArgumentList& args)
+    {
+        args.checkMinNumArguments (3);
+
+        auto inputFile = args[1].resolveAsExistingFile();
+        auto outputFile = args[2].resolveAsFile();
+
+        OfflineRenderer renderer;
+        renderer.setBlockSize (getIntOption (args, "--block", 512));
+
+        auto parameters = getParameterArguments (args);
+
+        for (auto& parameterID : parameters.getAllKeys())
+            if (! renderer.setParameter (parameterID, parameters[parameterID].getFloatValue()))
+                juce::ConsoleApplication::fail ("Unknown parameter " + parameterID);
+
+        if (args.containsOption ("--ir"))
+            renderer.getProcessor().loadImpulseResponse (juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--ir")));
+
+        // automation times are in seconds, so they need the file's sample rate
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        if (std::unique_ptr<juce::AudioFormatReader> reader { formatManager.createReaderFor (inputFile) })
+        {
+            addAutomationArguments (args, renderer, reader->sampleRate);
+            addCommandArguments (args, renderer, reader->sampleRate);
+
+            // the tempo ramp runs over the length of the input
+            auto bpm = getDoubleOption (args, "--bpm", 120.0);
+            renderer.setTempo (bpm, getDoubleOption (args, "--bpm-end", bpm), reader->lengthInSamples);
+        }
+
+        // by default let the last echo ring out
+        auto tailSeconds = getDoubleOption (args, "--tail", (double) renderer.getProcessor().getDelayLengthSeconds());
+
+        auto result = renderer.renderFile (inputFile, outputFile, tailSeconds, getIntOption (args, "--bits", 24));
+
+        if (result.failed())
+            juce::ConsoleApplication::fail (result.getErrorMessage());
+    }
+
+    void benchmark (const juce::ArgumentList& args)
+    {
+        ThroughputBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        getListOption (args, "--sample-rates", bench.sampleRates);
+        getListOption (args, "--channels", bench.channelCounts);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+        bench.parameters = getParameterArguments (args);
+
+        auto results = bench.run();
+        ThroughputBenchmark::printTable (results);
+
+        if (args.containsOption ("--csv"))
+        {
+            auto csvFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--csv"));
+
+            if (! ThroughputBenchmark::writeCsv (results, csvFile))
+                juce::ConsoleApplication::fail ("Couldn't write " + csvFile.getFullPathName());
+        }
+    }
+
+    void benchmarkInterpolators (const juce::ArgumentList& args)
+    {
+        InterpolatorBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkFdn (const juce::ArgumentList& args)
+    {
+        FdnBenchmark bench;
+        bench.blockSize = getIntOption (args, "--block", bench.blockSize);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkRing (const juce::ArgumentList& args)
+    {
+        RingBufferBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkTaps (const juce::ArgumentList& args)
+    {
+        MultiTapBenchmark bench;
+        getListOption (args, "--taps", bench.tapCounts);
+        bench.blockSize = getIntOption (args, "--block", bench.blockSize);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void profile (const juce::ArgumentList& args)
+    {
+        ProfileRun run;
+        run.blockSize = getIntOption (args, "--block", run.blockSize);
+        run.sampleRate = getDoubleOption (args, "--sample-rate", run.sampleRate);
+        run.numChannels = getIntOption (args, "--channels", run.numChannels);
+        run.secondsOfAudio = getDoubleOption (args, "--seconds", run.secondsOfAudio);
+        run.parameters = getParameterArguments (args);
+
+        auto snapshot = run.run();
+        ProfileRun::print (snapshot);
+
+        if (RealtimeTrap::isEnabled())
+            std::cout << "audio thread allocations: " << RealtimeTrap::getNumAllocations()
+                      << ", locks: " << RealtimeTrap::getNumLocks() << std::endl;
+
+        if (args.containsOption ("--csv"))
+        {
+            auto csvFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--csv"));
+
+            if (! ProfileRun::writeCsv (snapshot, csvFile))
+                juce::ConsoleApplication::fail ("Couldn't write " + csvFile.getFullPathName());
+        }
+
+        if (args.containsOption ("--json"))
+        {
+            auto jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--json"));
+
+            if (! ProfileRun::writeJson (snapshot, jsonFile))
+                juce::ConsoleApplication::fail ("Couldn't write " + jsonFile.getFullPathName());
+        }
+    }
+
+    void benchmarkConvolution (const juce::ArgumentList& args)
+    {
+        ConvolutionBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        getListOption (args, "--lengths", bench.impulseSeconds);
+        bench.partitionSize = getIntOption (args, "--partition", bench.partitionSize);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        if (args.containsOption ("--ir"))
+            for (auto& path : juce::StringArray::fromTokens (args.getValueForOption ("--ir"), ",", {}))
+                bench.impulseFiles.add (juce::File::getCurrentWorkingDirectory().getChildFile (path));
+
+        printKernelTable (bench.run());
+    }
+
+    void stressCommands (const juce::ArgumentList& args)
+    {
+        CommandStressTest test;
+        test.numProducers = getIntOption (args, "--threads", test.numProducers);
+        test.commandsPerProducer = getIntOption (args, "--commands", test.commandsPerProducer);
+        test.blockSize = getIntOption (args, "--block", test.blockSize);
+
+        auto result = test.run();
+        CommandStressTest::print (result);
+
+        if (RealtimeTrap::isEnabled())
+            std::cout << "audio thread allocations: " << RealtimeTrap::getNumAllocations()
+                      << ", locks: " << RealtimeTrap::getNumLocks() << std::endl;
+
+        if (! result.passed() || RealtimeTrap::getNumAllocations() > 0 || RealtimeTrap::getNumLocks() > 0)
+            juce::ConsoleApplication::fail ("Command stress test failed");
+    }
+
+    void benchmarkState (const juce::ArgumentList& args)
+    {
+        StateBenchmark bench;
+        getListOption (args, "--max-delays", bench.maxDelaySeconds);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.repeats = juce::jmax (1, getIntOption (args, "--repeats", bench.repeats));
+        bench.numInstances = getIntOption (args, "--instances", bench.numInstances);
+
+        auto results = bench.run();
+        bench.print (results);
+
+        for (auto& result : results)
+            if (! result.roundTripMatched)
+                juce::ConsoleApplication::fail ("A restored state didn't save back the same");
+    }
+
+    void benchmarkDelayLine (const juce::ArgumentList& args)
+    {
+        DelayLineBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkChannels (const juce::ArgumentList& args)
+    {
+        ChannelScalingBenchmark bench;
+        getListOption (args, "--channels", bench.channelCounts);
+        bench.blockSize = getIntOption (args, "--block", bench.blockSize);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkParallel (const juce::ArgumentList& args)
+    {
+        ParallelScalingBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        bench.numChannels = juce::jlimit (1, NewProjectAudioProcessor::maxNumChannels, getIntOption (args, "--channels", bench.numChannels));
+        bench.maxThreads = getIntOption (args, "--threads", bench.maxThreads);
+        bench.impulseSeconds = getDoubleOption (args, "--ir-length", bench.impulseSeconds);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void checkDelay (const juce::ArgumentList& args)
+    {
+        DelayRegressionTest test;
+        getListOption (args, "--block-sizes", test.blockSizes);
+        getListOption (args, "--delays", test.delaysInSamples);
+        test.sampleRate = getDoubleOption (args, "--sample-rate", test.sampleRate);
+
+        auto results = test.run();
+        test.print (results);
+
+        if (! test.passed (results))
+            juce::ConsoleApplication::fail ("The delay doesn't match the reference model");
+    }
+
+    void benchmarkSuite (const juce::ArgumentList& args)
+    {
+        BenchmarkSuite suite;
+        getListOption (args, "--block-sizes", suite.blockSizes);
+        getListOption (args, "--channels", suite.channelCounts);
+        getListOption (args, "--delays", suite.delaySeconds);
+        getListOption (args, "--sample-rates", suite.sampleRates);
+        suite.secondsOfAudio = getDoubleOption (args, "--seconds", suite.secondsOfAudio);
+        suite.repeats = juce::jmax (1, getIntOption (args, "--repeats", suite.repeats));
+        suite.numInstances = getIntOption (args, "--instances", suite.numInstances);
+        suite.label = args.getValueForOption ("--label");
+
+        auto entries = suite.run();
+        suite.print (entries);
+
+        if (args.containsOption ("--json"))
+        {
+            auto jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--json"));
+
+            if (! suite.writeJson (entries, jsonFile))
+                juce::ConsoleApplication::fail ("Couldn't write " + jsonFile.getFullPathName());
+        }
+    }
+
+    void compareBenchmarks (const juce::ArgumentList& args)
+    {
+        args.checkMinNumArguments (3);
+
+        juce::Array<BenchmarkSuite::Entry> before, after;
+
+        if (! BenchmarkSuite::readJson (args[1].resolveAsExistingFile(), before))
+            juce::ConsoleApplication::fail ("Not a bench-suite result file: " + args[1].text);
+
+        if (! BenchmarkSuite::readJson (args[2].resolveAsExistingFile(), after))
+            juce::ConsoleApplication::fail ("Not a bench-suite result file: " + args[2].text);
+
+        auto threshold = getDoubleOption (args, "--threshold", 5.0);
+        auto comparisons = BenchmarkSuite::compare (before, after);
+        BenchmarkSuite::printComparison (comparisons, threshold);
+
+        for (auto& comparison : comparisons)
+            if (comparison.change > threshold)
+                juce::ConsoleApplication::fail ("Slower than the threshold of " + juce::String (threshold, 1) + "%");
+    }
+
+    void checkGolden (const juce::ArgumentList& args)
+    {
+        GoldenOutputTest test;
+        test.directory = juce::File::getCurrentWorkingDirectory().getChildFile (args.containsOption ("--dir") ? args.getValueForOption ("--dir")
+                                                                                                           : juce::String ("HeadlessRunner/Golden"));
+        getListOption (args, "--block-sizes", test.blockSizes);
+        test.tolerance = getDoubleOption (args, "--tolerance", test.tolerance);
+
+        if (args.containsOption ("--cases"))
+            test.caseNames = juce::StringArray::fromTokens (args.getValueForOption ("--cases"), ",", {});
+        
+        test.againstModel = args.containsOption ("--against-model");
+
+        if (args.containsOption ("--record"))
+        {
+            if (! test.record())
+                juce::ConsoleApplication::fail ("Couldn't record the golden outputs in " + test.directory.getFullPathName());
+
+            return;
+        }
+
+        auto results = test.run();
+        test.print (results);
+
+        if (! test.passed (results))
+            juce::ConsoleApplication::fail (test.againstModel ? "The output doesn't match the model" : "The output doesn't match the golden outputs");
+    }
+
+    void benchmarkSaturation (const juce::ArgumentList& args)
+    {
+        SaturationBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkModulation (const juce::ArgumentList& args)
+    {
+        ModulationBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        getListOption (args, "--voices", bench.voiceCounts);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkFilter (const juce::ArgumentList& args)
+    {
+        FeedbackFilterBenchmark bench;
+        getListOption (args, "--channels", bench.channelCounts);
+        bench.blockSize = getIntOption (args, "--block", bench.blockSize);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkDucking (const juce::ArgumentList& args)
+    {
+        DuckingBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkGranular (const juce::ArgumentList& args)
+    {
+        GranularBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        getListOption (args, "--grains", bench.grainCounts);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        printKernelTable (bench.run());
+    }
+
+    void benchmarkPitchShift (const juce::ArgumentList& args)
+    {
+        PitchShiftBenchmark bench;
+        getListOption (args, "--block-sizes", bench.blockSizes);
+        getListOption (args, "--windows", bench.windowsMs);
+        bench.semitones = (float) getDoubleOption (args, "--semitones", bench.semitones);
+        bench.sampleRate = getDoubleOption (args, "--sample-rate", bench.sampleRate);
+        bench.secondsOfAudio = getDoubleOption (args, "--seconds", bench.secondsOfAudio);
+
+        auto results = bench.run();
+        printKernelTable (results);
+        bench.printSummary (results);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter tree expects a message manager to exist, even with no window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "Usage:", true);
+    app.addVersionCommand ("--version|-v", juce::String (ProjectInfo::projectName) + " " + ProjectInfo::versionString);
+
+    app.addCommand ({ "render",
+                      "render <input> <output> [--block=512] [--tail=seconds] [--bits=24] [--bpm=120] [--bpm-end=bpm] [--ir=file] [--param=ID=value ...] [--automate=ID@seconds=value ...] [--command=type@seconds=value ...]",
+                      "Streams an audio file (wav, aiff, flac, ...) through the delay and writes the result.",
+                      "The output format is picked from the output file's extension. Parameters take real-world values, "
+                      "e.g. --param=DELAY_LENGTH=0.375 --param=WET_GAIN=0.4. The tail defaults to the delay length. "
+                      "Automation points split the host blocks so each change lands on its exact sample. "
+                      "The playhead reports --bpm, ramping to --bpm-end over the input, for --param=SYNC=1. "
+                      "--ir loads an impulse response for --param=CONVOLUTION=1. "
+                      "Commands (clear, freeze, tap) are posted up front and land on their sample.",
+                      render });
+
+    app.addCommand ({ "bench",
+                      "bench [--block-sizes=16,...,8192] [--sample-rates=44100,...,384000] [--channels=1,2] [--seconds=10] [--csv=file] [--param=ID=value ...]",
+                      "Measures processBlock() throughput: samples/sec, ns/sample and realtime factor.",
+                      "Each configuration renders --seconds of white noise after a short warm-up.",
+                      benchmark });
+
+    app.addCommand ({ "profile",
+                      "profile [--block=512] [--sample-rate=48000] [--channels=2] [--seconds=10] [--csv=file] [--json=file] [--param=ID=value ...]",
+                      "Runs the built-in profiler over white noise: p50/p99/max per stage, DSP load and deadline misses.",
+                      "A deadline miss is a block that took longer to process than it lasts. Debug builds with "
+                      "DELAY_REALTIME_TRAP=1 also count allocations and locks on the audio thread.",
+                      profile });
+
+    app.addCommand ({ "bench-interp",
+                      "bench-interp [--block-sizes=64,512,4096] [--sample-rate=48000] [--seconds=10]",
+                      "Times each delay interpolator against the original whole-sample read.",
+                      "Reads a 4 second delay buffer at a new random fractional delay every block.",
+                      benchmarkInterpolators });
+
+    app.addCommand ({ "bench-fdn",
+                      "bench-fdn [--block=512] [--sample-rate=96000] [--seconds=10]",
+                      "Times the feedback delay network for 4, 8 and 16 lines and each mixing matrix.",
+                      "Stereo white noise in; reports ns per frame and the share of one core needed in real time.",
+                      benchmarkFdn });
+
+    app.addCommand ({ "bench-ring",
+                      "bench-ring [--block-sizes=16,64,256,1024,4096] [--sample-rate=48000] [--seconds=10]",
+                      "Times the original two-segment circular buffer against the mirrored power-of-two ring.",
+                      "Each block is written, read back at a random whole-sample delay and the write position advanced.",
+                      benchmarkRing });
+
+    app.addCommand ({ "bench-taps",
+                      "bench-taps [--taps=8,32,64] [--block=512] [--sample-rate=48000] [--seconds=10]",
+                      "Times the single-pass multi-tap read against one pass over the block per tap.",
+                      "Stereo, with the taps spread evenly over a 2 second delay buffer.",
+                      benchmarkTaps });
+
+    app.addCommand ({ "bench-saturation",
+                      "bench-saturation [--block-sizes=64,512] [--sample-rate=48000] [--seconds=10]",
+                      "Times the feedback saturator at 1x, 2x, 4x and 8x oversampling.",
+                      "Stereo white noise at 12 dB of drive; each factor is compared against clipping at the base rate.",
+                      benchmarkSaturation });
+
+    app.addCommand ({ "bench-delay-line",
+                      "bench-delay-line [--block-sizes=64,512,2048] [--sample-rate=48000] [--seconds=10]",
+                      "Times the plain delay as separate passes (fill, read, fill, gain) against the fused one-pass kernel.",
+                      "Stereo white noise with a random fractional delay every block, whole-sample and hermite reads.",
+                      benchmarkDelayLine });
+
+    app.addCommand ({ "bench-channels",
+                      "bench-channels [--channels=1,2,6,12,16] [--block=512] [--sample-rate=48000] [--seconds=10]",
+                      "Times the delay line one channel at a time against all channels in one call, for each channel count.",
+                      "Hermite with a ramping delay, the allpass and hermite with a steady delay; ns per frame, so N independent "
+                      "passes cost N times as much. Up to 16 channels (7.1.4, third order ambisonics).",
+                      benchmarkChannels });
+
+    app.addCommand ({ "bench-parallel",
+                      "bench-parallel [--block-sizes=64,256,1024] [--channels=16] [--threads=N] [--ir-length=2] [--sample-rate=48000] [--seconds=5]",
+                      "Times processBlock() with PARALLEL on from one thread up to the whole worker pool, in the heavy per-channel modes.",
+                      "8x oversampled saturation (alone and with ping-pong routing between the two parallel halves) and convolution. "
+                      "ns per frame of wall clock time against PARALLEL off; also reports any output that differs from it.",
+                      benchmarkParallel });
+
+    app.addCommand ({ "bench-modulation",
+                      "bench-modulation [--block-sizes=64,512] [--voices=2,4,8] [--sample-rate=48000] [--seconds=10]",
+                      "Times the chorus and flanger voices against a single tap, and the LFO bank against std::sin.",
+                      "Stereo hermite reads around a 20 ms delay: a fixed single tap, a single tap with a per-sample delay, the "
+                      "flanger and the chorus at each voice count. Then every LFO shape for 16 oscillators on its own.",
+                      benchmarkModulation });
+
+    app.addCommand ({ "bench-filter",
+                      "bench-filter [--channels=1,2,4,8,16] [--block=512] [--sample-rate=48000] [--seconds=10]",
+                      "Times the feedback filter with the channels in SIMD lanes against running it a channel at a time.",
+                      "Low cut, high cut and tilt on white noise for each channel count, and again with the cutoffs moving "
+                      "every block so the coefficients are recalculated each time.",
+                      benchmarkFilter });
+
+    app.addCommand ({ "bench-duck",
+                      "bench-duck [--block-sizes=64,512] [--sample-rate=48000] [--seconds=10]",
+                      "Times the ducking's envelope follower and gain curve, multiplied into the wet mix, against a plain add.",
+                      "Stereo echoes added to the output with no ducking, then ducked by the peak and the RMS follower as "
+                      "they're added, and by the peak follower applied in a pass of its own first.",
+                      benchmarkDucking });
+
+    app.addCommand ({ "bench-granular",
+                      "bench-granular [--block-sizes=512] [--grains=8,32,64,128] [--sample-rate=48000] [--seconds=10]",
+                      "Times the grain engine against the number of grains overlapping per channel.",
+                      "Stereo 100 ms grains around a 200 ms delay with the density set to give each grain count, at the "
+                      "original pitch (whole-sample reads) and a fifth up (interpolated), then reverse mode. The % of a core "
+                      "is for one instance.",
+                      benchmarkGranular });
+
+    app.addCommand ({ "bench-pitch",
+                      "bench-pitch [--block-sizes=64,512] [--windows=10,40,100] [--semitones=12] [--sample-rate=48000] [--seconds=10]",
+                      "Times the pitch shifter's two read heads against the plain read, and a whole instance with PITCH off and on.",
+                      "Stereo hermite reads around a 300 ms delay for each window size, then processBlock() in plain delay "
+                      "mode on white noise. Under the table, the latency each window adds to the echoes in ms and samples (half "
+                      "of it, taken off the delay time to keep the repeats in time) and the % of a core one instance costs with "
+                      "PITCH on.",
+                      benchmarkPitchShift });
+
+    app.addCommand ({ "check-delay",
+                      "check-delay [--block-sizes=32,512,1000] [--delays=7,100,4410,4410.5] [--sample-rate=44100]",
+                      "Checks processBlock() in plain delay mode against a sample-by-sample reference model.",
+                      "y[n] = x[n] + wet * y[n - delay], output = gain * y[n], for whole-sample and linear reads, every "
+                      "channel and delays shorter and longer than the block. Exits with an error on any mismatch.",
+                      checkDelay });
+
+    app.addCommand ({ "bench-suite",
+                      "bench-suite [--block-sizes=64,512] [--channels=1,2] [--delays=0.01,0.5] [--sample-rates=48000,96000] [--seconds=1] [--repeats=5] [--instances=200] [--label=name] [--json=file]",
+                      "Times every DSP kernel and engine mode over a grid of configurations, for tracking CPU cost over time.",
+                      "Kernels on their own (fill, read and the fused delay line per interpolator, gain, position update), then "
+                      "processBlock() in each mode. Each entry is the median of --repeats; --json saves them for bench-compare.",
+                      benchmarkSuite });
+
+    app.addCommand ({ "bench-compare",
+                      "bench-compare <before.json> <after.json> [--threshold=5]",
+                      "Compares two bench-suite result files and flags every entry that got slower than the threshold.",
+                      "Entries are matched by kernel, block size, channel count, delay and sample rate; the slowest changes "
+                      "are listed first. Exits with an error if anything regressed by more than --threshold percent.",
+                      compareBenchmarks });
+
+    app.addCommand ({ "golden",
+                      "golden [--dir=HeadlessRunner/Golden] [--record] [--against-model] [--block-sizes=1,7,64,333,512,4096] [--cases=name,...] [--tolerance=1e-5]",
+                      "Renders fixed stimuli through processBlock() and compares them with stored golden outputs, or the delay model.",
+                      "Impulses, sines, noise and clicks with parameter sweeps, each longer than the delay buffer so it wraps. "
+                      "--record writes the golden files (32-bit float wav) rendered at 512-sample blocks; without it every case "
+                      "is rendered at each block size and compared with its golden file, and a case without one fails. "
+                      "--against-model compares with a sample-by-sample model of the plain delay instead, for the cases it can render. "
+                      "Exits with an error on any mismatch or missing case.",
+                      checkGolden });
+
+    app.addCommand ({ "bench-convolution",
+                      "bench-convolution [--block-sizes=64,512] [--lengths=0.5,2,6] [--ir=file,...] [--partition=256] [--sample-rate=48000] [--seconds=10]",
+                      "Times the partitioned convolver against juce::dsp::Convolution, uniform and non-uniform.",
+                      "Stereo white noise through each impulse response: --ir files if given, otherwise decaying noise of each length.",
+                      benchmarkConvolution });
+
+    app.addCommand ({ "stress-commands",
+                      "stress-commands [--threads=4] [--commands=100000] [--block=64]",
+                      "Posts commands from several threads at once and checks none are lost, reordered or take a lock.",
+                      "First the queue on its own, then the processor rendering white noise while the threads post random "
+                      "clear, freeze, tap, resize, preset and impulse commands. Exits with an error if anything fails.",
+                      stressCommands });
+
+    app.addCommand ({ "bench-state",
+                      "bench-state [--max-delays=2,8] [--sample-rate=48000] [--repeats=10] [--instances=100]",
+                      "Times saving and restoring the plugin state with the delay buffer snapshot, and reports its size.",
+                      "Stereo, the buffer full of white noise and then of a decaying tail. Restores go into a processor "
+                      "that's playing; a state restored before prepareToPlay is saved again and must match byte for byte.",
+                      benchmarkState });
+
+    return app.findAndRunCommand (argc, argv);
+}
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer()
+    : processor (std::make_unique<NewProjectAudioProcessor>())
+{
+    // wav, aiff, flac, ogg (and mp3 if enabled)
+    formatManager.registerBasicFormats();
+
+    // we never talk to a device, so let the processor know it may take its time
+    processor->setNonRealtime (true);
+    processor->setPlayHead (&playHead);
+}
+
+bool OfflineRenderer::setParameter (const juce::String& parameterID, float value)
+{
+    auto* parameter = processor->apvts.getParameter (parameterID);
+
+    if (parameter == nullptr)
+        return false;
+
+    parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    return true;
+}
+
+bool OfflineRenderer::addAutomationPoint (const juce::String& parameterID, juce::int64 samplePosition, float value)
+{
+    auto* parameter = processor->apvts.getParameter (parameterID);
+
+    if (parameter == nullptr)
+        return false;
+
+    AutomationPoint point { samplePosition, parameter, value };
+
+    // keep points at the same position in the order they were added
+    auto insertPosition = std::upper_bound (automation.begin(), automation.end(), point,
+                                            [] (const AutomationPoint& a, const AutomationPoint& b) { return a.samplePosition < b.samplePosition; });
+    automation.insert (insertPosition, point);
+    return true;
+}
+
+void OfflineRenderer::clearAutomation()
+{
+    automation.clear();
+    nextAutomationPoint = 0;
+}
+
+void OfflineRenderer::setTempo (double startBpm, double endBpm, juce::int64 rampLengthInSamples)
+{
+    playHead.startBpm = startBpm;
+    playHead.endBpm = endBpm;
+    playHead.rampLength = rampLengthInSamples;
+}
+
+juce::Optional<juce::AudioPlayHead::PositionInfo> OfflineRenderer::TransportPlayHead::getPosition() const
+{
+    // tempo and beat position along a linear ramp, then the end tempo from there on
+    auto rampSamples = (double) juce::jmin (samplePosition, rampLength);
+    auto progress = rampLength > 0 ? rampSamples / (double) rampLength : 1.0;
+    auto bpm = startBpm + (endBpm - startBpm) * progress;
+
+    auto rampBeats = rampSamples / sampleRate / 60.0 * (startBpm + bpm) * 0.5;
+    auto beatsAfterRamp = (double) juce::jmax ((juce::int64) 0, samplePosition - rampLength) / sampleRate / 60.0 * endBpm;
+
+    PositionInfo info;
+    info.setBpm (bpm);
+    info.setTimeSignature (juce::AudioPlayHead::TimeSignature { 4, 4 });
+    info.setTimeInSamples (samplePosition);
+    info.setTimeInSeconds ((double) samplePosition / sampleRate);
+    info.setPpqPosition (rampBeats + beatsAfterRamp);
+    info.setIsPlaying (true);
+    return info;
+}
+
+bool OfflineRenderer::prepare (double sampleRate, int channels, int samplesPerBlock)
+{
+    // only the main buses are set, a sidechain stays however it is (disabled unless someone turned it on)
+    auto layout = processor->getBusesLayout();
+    layout.inputBuses.getReference (0) = juce::AudioChannelSet::canonicalChannelSet (channels);
+    layout.outputBuses.getReference (0) = juce::AudioChannelSet::canonicalChannelSet (channels);
+
+    if (! processor->setBusesLayout (layout))
+        return false;
+
+    blockSize = samplesPerBlock;
+    numChannels = channels;
+    playHead.sampleRate = sampleRate;
+
+    processor->releaseResources();
+    processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor->prepareToPlay (sampleRate, blockSize);
+
+    // an impulse response loads in the background, don't render the start of the file without it
+    while (processor->isLoadingImpulseResponse())
+        juce::Thread::sleep (5);
+
+    renderPosition = 0;
+    nextAutomationPoint = 0;
+    return true;
+}
+
+void OfflineRenderer::process (juce::AudioBuffer<float>& buffer)
+{
+    jassert (buffer.getNumChannels() == numChannels);
+
+    auto numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        auto numThisBlock = juce::jmin (blockSize, numSamples - start);
+
+        // wrap the samples in place instead of copying, the way a host hands us its own memory
+        juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numChannels, start, numThisBlock);
+        processBlockWithAutomation (block);
+    }
+}
+
+void OfflineRenderer::processBlockWithAutomation (juce::AudioBuffer<float>& block)
+{
+    auto numSamples = block.getNumSamples();
+    int start = 0;
+
+    while (start < numSamples)
+    {
+        // apply everything that's due at this sample
+        while (nextAutomationPoint < automation.size()
+               && automation[nextAutomationPoint].samplePosition <= renderPosition + start)
+        {
+            auto& point = automation[nextAutomationPoint++];
+            point.parameter->setValueNotifyingHost (point.parameter->convertTo0to1 (point.value));
+        }
+
+        auto end = numSamples;
+
+        if (nextAutomationPoint < automation.size())
+            end = (int) juce::jmin ((juce::int64) numSamples, automation[nextAutomationPoint].samplePosition - renderPosition);
+
+        juce::AudioBuffer<float> subBlock (block.getArrayOfWritePointers(), block.getNumChannels(), start, end - start);
+        playHead.samplePosition = renderPosition + start;
+        processor->processBlock (subBlock, midiBuffer);
+
+        start = end;
+    }
+
+    renderPosition += numSamples;
+}
+
+juce::Result OfflineRenderer::renderFile (const juce::File& inputFile, const juce::File& outputFile, double tailSeconds, int bitsPerSample)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (inputFile));
+
+    if (reader == nullptr)
+        return juce::Result::fail ("Couldn't read " + inputFile.getFullPathName());
+
+    auto* outputFormat = formatManager.findFormatForFileExtension (outputFile.getFileExtension());
+
+    if (outputFormat == nullptr)
+        return juce::Result::fail ("No audio format for " + outputFile.getFileName());
+
+    auto channels = (int) reader->numChannels;
+
+    if (! prepare (reader->sampleRate, channels, blockSize))
+        return juce::Result::fail ("Unsupported channel count: " + juce::String (channels));
+
+    outputFile.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> outputStream (outputFile.createOutputStream());
+
+    if (outputStream == nullptr)
+        return juce::Result::fail ("Couldn't write " + outputFile.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (outputFormat->createWriterFor (outputStream.get(), reader->sampleRate,
+                                                                                   (unsigned int) channels, bitsPerSample, {}, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("Couldn't create a " + juce::String (bitsPerSample) + "-bit " + outputFormat->getFormatName() + " writer");
+
+    // the writer owns the stream now
+    outputStream.release();
+
+    juce::AudioBuffer<float> block (channels, blockSize);
+    auto inputLength = reader->lengthInSamples;
+    auto totalLength = inputLength + (juce::int64) (tailSeconds * reader->sampleRate);
+
+    for (juce::int64 position = 0; position < totalLength; position += blockSize)
+    {
+        auto numThisBlock = (int) juce::jmin ((juce::int64) blockSize, totalLength - position);
+        block.setSize (channels, numThisBlock, false, false, true);
+
+        // past the end of the file the reader fills with silence, which gives us the delay tail
+        reader->read (&block, 0, numThisBlock, position, true, true);
+        processBlockWithAutomation (block);
+
+        if (! writer->writeFromAudioSampleBuffer (block, 0, numThisBlock))
+            return juce::Result::fail ("Write error on " + outputFile.getFullPathName());
+    }
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Drives NewProjectAudioProcessor without a host, a GUI or an audio device.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+/**
+    Owns a NewProjectAudioProcessor and pushes audio through its processBlock()
+    in fixed-size blocks, exactly like a host would.
+*/
+class OfflineRenderer
+{
+public:
+    OfflineRenderer();
+
+    // sets a parameter from its real-world value (e.g. seconds for DELAY_LENGTH)
+    bool setParameter (const juce::String& parameterID, float value);
+
+    // schedules a parameter change at a sample position from the start of the render.
+    // blocks are split at these points, the way a host with sample-accurate automation would.
+    bool addAutomationPoint (const juce::String& parameterID, juce::int64 samplePosition, float value);
+    void clearAutomation();
+
+    // the tempo the processor's playhead reports, ramping linearly to endBpm over rampLengthInSamples
+    void setTempo (double startBpm, double endBpm, juce::int64 rampLengthInSamples);
+
+    // configures the bus layout and calls prepareToPlay(), returns false if the layout isn't supported
+    bool prepare (double sampleRate, int numChannels, int blockSize);
+
+    // processes the whole buffer in place, in blocks of the prepared block size
+    void process (juce::AudioBuffer<float>& buffer);
+
+    // streams the input file through the processor and writes the result, adding tailSeconds of silence at the end
+    juce::Result renderFile (const juce::File& inputFile, const juce::File& outputFile, double tailSeconds, int bitsPerSample);
+
+    NewProjectAudioProcessor& getProcessor() { return *processor; }
+    void setBlockSize (int newBlockSize) { blockSize = newBlockSize; }
+    int getBlockSize() const { return blockSize; }
+
+private:
+    struct AutomationPoint
+    {
+        juce::int64 samplePosition;
+        juce::RangedAudioParameter* parameter;
+        float value;
+    };
+
+    // a transport that is always playing, from sample 0 of the render
+    struct TransportPlayHead  : public juce::AudioPlayHead
+    {
+        juce::Optional<PositionInfo> getPosition() const override;
+
+        double sampleRate {44100.0};
+        double startBpm {120.0}, endBpm {120.0};
+        juce::int64 rampLength {0};
+        juce::int64 samplePosition {0}; // of the block being processed
+    };
+
+    // calls processBlock(), splitting the block at any automation points that fall inside it
+    void processBlockWithAutomation (juce::AudioBuffer<float>& block);
+
+    std::unique_ptr<NewProjectAudioProcessor> processor;
+    juce::AudioFormatManager formatManager;
+    juce::MidiBuffer midiBuffer; // always empty, the delay ignores midi
+    TransportPlayHead playHead;
+
+    std::vector<AutomationPoint> automation; // sorted by position
+    size_t nextAutomationPoint {0};
+    juce::int64 renderPosition {0};
+
+    int blockSize {512};
+    int numChannels {2};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
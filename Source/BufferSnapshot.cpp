@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    BufferSnapshot.cpp
+
+  ==============================================================================
+*/
+
+#include "BufferSnapshot.h"
+
+//==============================================================================
+void BufferSnapshot::write (juce::OutputStream& output, const DelayRing::View& ring, juce::int64 end, int numSamples,
+                            double sampleRate, const Looper::State& loop, const std::atomic<juce::int64>* writeHead)
+{
+    output.writeInt (formatVersion);
+    output.writeDouble (sampleRate);
+    output.writeInt (ring.numChannels);
+    output.writeInt (numSamples);
+
+    output.writeBool (loop.frozen);
+    output.writeInt64 (loop.regionOffset);
+    output.writeInt (loop.regionLength);
+    output.writeInt (loop.fadeLength);
+    output.writeInt (loop.phase);
+
+    juce::GZIPCompressorOutputStream compressor (output, compressionLevel);
+
+    juce::AudioBuffer<float> chunk (juce::jmax (1, ring.numChannels), chunkSize);
+    juce::HeapBlock<juce::uint8> planes ((size_t) chunkSize * 4);
+
+    for (auto position = end - numSamples; position < end; position += chunkSize)
+    {
+        auto numThisTime = (int) juce::jmin ((juce::int64) chunkSize, end - position);
+
+        for (int channel = 0; channel < ring.numChannels; ++channel)
+        {
+            auto* samples = chunk.getWritePointer (channel);
+
+            for (int i = 0; i < numThisTime; ++i)
+                samples[i] = ring.getSample (channel, position + i);
+        }
+
+        // the oldest samples are the next to be overwritten, if the writer got this far while they were copied
+        // they're a mix of then and now
+        if (writeHead != nullptr && position < writeHead->load() + ring.guardSize - ring.getNumSamples())
+            chunk.clear();
+
+        for (int channel = 0; channel < ring.numChannels; ++channel)
+        {
+            auto* samples = chunk.getReadPointer (channel);
+
+            for (int i = 0; i < numThisTime; ++i)
+            {
+                juce::uint32 bits;
+                std::memcpy (&bits, samples + i, sizeof (bits));
+
+                for (int plane = 0; plane < 4; ++plane)
+                    planes[plane * numThisTime + i] = (juce::uint8) (bits >> (8 * plane));
+            }
+
+            compressor.write (planes, (size_t) numThisTime * 4);
+        }
+    }
+
+    compressor.flush();
+}
+
+bool BufferSnapshot::readHeader (juce::InputStream& input, Header& header)
+{
+    header.version = input.readInt();
+    header.sampleRate = input.readDouble();
+    header.numChannels = input.readInt();
+    header.numSamples = input.readInt();
+
+    header.loop.frozen = input.readBool();
+    header.loop.regionOffset = input.readInt64();
+    header.loop.regionLength = input.readInt();
+    header.loop.fadeLength = input.readInt();
+    header.loop.phase = input.readInt();
+
+    return ! input.isExhausted()
+        && header.version >= 1 && header.version <= formatVersion
+        && header.sampleRate > 0.0
+        && header.numChannels > 0 && header.numChannels <= DelayRing::View::maxNumChannels
+        && header.numSamples >= 0;
+}
+
+bool BufferSnapshot::read (const void* data, size_t size, DelayRing& ring, juce::int64 end, double sampleRate, Header& header)
+{
+    juce::MemoryInputStream input (data, size, false);
+
+    // the delay times and the loop are counted in samples, they'd all come back at the wrong pitch
+    if (! readHeader (input, header) || header.sampleRate != sampleRate)
+        return false;
+
+    juce::GZIPDecompressorInputStream decompressor (input);
+
+    juce::AudioBuffer<float> chunk (1, chunkSize);
+    juce::HeapBlock<juce::uint8> planes ((size_t) chunkSize * 4);
+
+    auto start = end - header.numSamples;
+    auto keepFrom = end - juce::jmin ((juce::int64) header.numSamples, (juce::int64) ring.getNumSamples());
+    auto numChannels = juce::jmin (header.numChannels, ring.getNumChannels());
+
+    for (auto position = start; position < end; position += chunkSize)
+    {
+        auto numThisTime = (int) juce::jmin ((juce::int64) chunkSize, end - position);
+        auto numBytes = numThisTime * 4;
+
+        for (int channel = 0; channel < header.numChannels; ++channel)
+        {
+            if (decompressor.read (planes, numBytes) != numBytes)
+                return false;
+
+            // older than the ring reaches, or a channel it doesn't have
+            if (channel >= numChannels || position + numThisTime <= keepFrom)
+                continue;
+
+            auto* samples = chunk.getWritePointer (0);
+
+            for (int i = 0; i < numThisTime; ++i)
+            {
+                juce::uint32 bits = 0;
+
+                for (int plane = 0; plane < 4; ++plane)
+                    bits |= (juce::uint32) planes[plane * numThisTime + i] << (8 * plane);
+
+                std::memcpy (samples + i, &bits, sizeof (bits));
+            }
+
+            // in pieces no longer than the guard, each one is a contiguous write
+            auto first = (int) juce::jmax ((juce::int64) 0, keepFrom - position);
+
+            for (auto offset = first; offset < numThisTime; offset += ring.getGuardSize())
+            {
+                auto numToWrite = juce::jmin (ring.getGuardSize(), numThisTime - offset);
+                ring.write (channel, (int) ((position + offset) & ring.getMask()), samples + offset, numToWrite);
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    BufferSnapshot.h
+    Saves the delay ring, and the loop playing out of it, into the plugin
+    state, and streams it back into a ring.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayRing.h"
+#include "Looper.h"
+
+//==============================================================================
+/**
+    A short header (format version, sample rate, channel and sample counts
+    and the loop's state) followed by one zlib stream. The samples go in
+    chunks of chunkSize, oldest first, each channel's chunk split into four
+    planes of bytes: the low bytes of a float are close to noise, but the
+    sign and exponent bytes of audio barely change, and runs of silence or
+    a decaying tail squeeze to almost nothing. Level 1 keeps saving quick.
+
+    Reading never holds more than a chunk: the stream is inflated straight
+    out of the host's data and each chunk is written into the ring as it
+    comes out.
+*/
+class BufferSnapshot
+{
+public:
+    static constexpr int formatVersion = 1;
+    static constexpr int chunkSize = 1024;
+    static constexpr int compressionLevel = 1;
+
+    struct Header
+    {
+        int version {0};
+        double sampleRate {0.0};
+        int numChannels {0};
+        int numSamples {0};
+        Looper::State loop; // frozenAt isn't stored, the loop is relative to the end of the snapshot
+    };
+
+    // the numSamples samples of the ring before the absolute position end. writeHead is the ring's live write
+    // position when something may still be writing into it (nullptr when not): chunks it could have reached
+    // while they were copied are saved as silence.
+    static void write (juce::OutputStream& output, const DelayRing::View& ring, juce::int64 end, int numSamples,
+                       double sampleRate, const Looper::State& loop, const std::atomic<juce::int64>* writeHead);
+
+    static bool readHeader (juce::InputStream& input, Header& header);
+
+    // streams a snapshot into ring, so that its last sample lands just before the absolute position end. only
+    // the newest samples that fit are kept. false, with the ring untouched, if it was recorded at another sample
+    // rate or is from a newer version; false part way through if it's damaged.
+    static bool read (const void* data, size_t size, DelayRing& ring, juce::int64 end, double sampleRate, Header& header);
+};
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    ChannelRouter.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelRouter.h"
+
+using Vec = juce::dsp::SIMDRegister<float>;
+
+namespace
+{
+    // the buffers only promise a float's alignment, and fromRawArray() wants a whole register's.
+    // a memcpy of one register compiles to a single unaligned load or store.
+    Vec loadUnaligned (const float* source) noexcept
+    {
+        Vec v;
+        std::memcpy (&v, source, sizeof (Vec));
+        return v;
+    }
+
+    void storeUnaligned (Vec v, float* destination) noexcept
+    {
+        std::memcpy (destination, &v, sizeof (Vec));
+    }
+}
+
+//==============================================================================
+juce::StringArray ChannelRouter::getModeNames()
+{
+    return { "Independent", "Ping-pong", "Cross-feed", "Mid/Side" };
+}
+
+void ChannelRouter::setParameters (Mode newMode, float newAmount, int newNumChannels)
+{
+    newAmount = juce::jlimit (0.0f, 1.0f, newAmount);
+    newNumChannels = juce::jlimit (1, maxNumChannels, newNumChannels);
+
+    if (newMode == mode && newAmount == amount && newNumChannels == numChannels)
+        return;
+
+    mode = newMode;
+    amount = newAmount;
+    numChannels = newNumChannels;
+    updateMatrix();
+}
+
+void ChannelRouter::updateMatrix()
+{
+    auto n = numChannels;
+    auto mean = 1.0f / (float) n;
+
+    for (int out = 0; out < n; ++out)
+    {
+        for (int in = 0; in < n; ++in)
+        {
+            auto identity = out == in ? 1.0f : 0.0f;
+
+            switch (mode)
+            {
+                case Mode::pingPong:   matrix[out][in] = (in == (out + n - 1) % n) ? 1.0f : 0.0f; break;
+                case Mode::crossFeed:  matrix[out][in] = (1.0f - amount) * identity + amount * mean; break;
+                // mid passes, side is scaled: mean + s * (identity - mean)
+                case Mode::midSide:    matrix[out][in] = mean + (1.0f - 2.0f * amount) * (identity - mean); break;
+                case Mode::independent:
+                default:               matrix[out][in] = identity; break;
+            }
+        }
+    }
+
+    inputRouted = mode == Mode::pingPong && n > 1 && amount > 0.0f;
+    inputGain = 1.0f - amount;
+
+    bypassed = true;
+
+    for (int out = 0; out < n; ++out)
+        for (int in = 0; in < n; ++in)
+            if (matrix[out][in] != (out == in ? 1.0f : 0.0f))
+                bypassed = false;
+}
+
+void ChannelRouter::routeInput (float* const* destination, const float* const* input, int numSamples) const
+{
+    // every channel keeps (1 - amount) of its input, the first also gets amount times the mono sum
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::multiply (destination[channel], input[channel], inputGain, numSamples);
+
+    auto sumGain = amount / (float) numChannels;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::addWithMultiply (destination[0], input[channel], sumGain, numSamples);
+}
+
+void ChannelRouter::process (float* const* channels, int numSamples) const
+{
+    constexpr auto vecSize = (int) Vec::size();
+    auto numWhole = numSamples / vecSize * vecSize;
+
+    // local copies, so the stores into the channels can't be taken to alias the pointers or the matrix
+    // and have them reloaded on every slot
+    float* data[maxNumChannels];
+    float gains[maxNumChannels][maxNumChannels];
+
+    for (int out = 0; out < numChannels; ++out)
+    {
+        data[out] = channels[out];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            gains[out][channel] = matrix[out][channel];
+    }
+
+    for (int i = 0; i < numWhole; i += vecSize)
+    {
+        // load the frame slot from every channel before any of them is overwritten
+        Vec in[maxNumChannels];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            in[channel] = loadUnaligned (data[channel] + i);
+
+        for (int out = 0; out < numChannels; ++out)
+        {
+            auto mixed = in[0] * gains[out][0];
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                mixed = Vec::multiplyAdd (mixed, in[channel], Vec::expand (gains[out][channel]));
+
+            storeUnaligned (mixed, data[out] + i);
+        }
+    }
+
+    // whatever is left over doesn't fill a register
+    for (int i = numWhole; i < numSamples; ++i)
+    {
+        float in[maxNumChannels];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            in[channel] = channels[channel][i];
+
+        for (int out = 0; out < numChannels; ++out)
+        {
+            auto mixed = 0.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                mixed += matrix[out][channel] * in[channel];
+
+            channels[out][i] = mixed;
+        }
+    }
+}
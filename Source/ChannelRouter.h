@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    ChannelRouter.h
+    Ping-pong, cross-feed and mid/side routing of the echoes between channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Each mode is an N x N matrix applied to the echoes of every channel on
+    their way back into the delay lines, so the routing compounds on every
+    repeat. In cross-feed and mid/side, amount 0 leaves each channel to itself.
+
+    For more than two channels ping-pong rotates the echoes one channel along,
+    cross-feed blends towards the mean of all channels and mid/side treats the
+    mean as mid and each channel's difference from it as side.
+
+    The delay ring and the interpolators are planar, so rather than
+    interleaving frames the mix keeps the channels planar and fills each SIMD
+    register with consecutive samples of one channel, loaded straight from
+    the channel and stored back over it: a whole frame of every channel is
+    mixed per sample slot with no shuffles or scratch copies in or out.
+*/
+class ChannelRouter
+{
+public:
+    // the order matches the choices of the ROUTING parameter
+    enum class Mode
+    {
+        independent = 0,  // each channel only hears its own echoes
+        pingPong,         // the echoes move one channel along every repeat, amount sums the input into the first channel
+        crossFeed,        // amount blends each channel's echoes with every other's
+        midSide           // amount narrows the echoes' side, to mono at 0.5 and swapped at 1
+    };
+
+    static constexpr int maxNumChannels = 16;
+
+    ChannelRouter() = default;
+
+    static juce::StringArray getModeNames();
+
+    // only rebuilds the matrices when something changed
+    void setParameters (Mode newMode, float newAmount, int newNumChannels);
+
+    // true when the matrix is the identity, the echoes can then stay in the per-channel path
+    bool isBypassed() const { return bypassed; }
+
+    // true when the delay lines are fed from a mix of the input rather than the input itself (ping-pong)
+    bool routesInput() const { return inputRouted; }
+
+    // the mix of the input that feeds the delay lines, into destination
+    void routeInput (float* const* destination, const float* const* input, int numSamples) const;
+
+    // mixes the echoes between channels in place
+    void process (float* const* channels, int numSamples) const;
+
+private:
+    void updateMatrix();
+
+    Mode mode {Mode::independent};
+    float amount {-1.0f};
+    int numChannels {0};
+
+    bool bypassed {true};
+    bool inputRouted {false};
+    float inputGain {1.0f}; // of the input each channel keeps, the rest goes into the first channel's sum
+
+    float matrix[maxNumChannels][maxNumChannels] {}; // output row, input column
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelRouter)
+};
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    CommandQueue.cpp
+
+  ==============================================================================
+*/
+
+#include "CommandQueue.h"
+
+//==============================================================================
+CommandQueue::CommandQueue()
+{
+    static_assert ((capacity & (capacity - 1)) == 0, "the capacity has to be a power of two");
+
+    // a cell is free for the producer whose position matches its sequence
+    for (size_t i = 0; i < (size_t) capacity; ++i)
+        cells[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+bool CommandQueue::push (const Command& command) noexcept
+{
+    auto position = enqueuePosition.load (std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& cell = cells[position & mask];
+        auto sequence = cell.sequence.load (std::memory_order_acquire);
+        auto difference = (std::intptr_t) sequence - (std::intptr_t) position;
+
+        if (difference == 0)
+        {
+            // the cell is free, claim it unless another producer got there first
+            if (enqueuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+            {
+                cell.command = command;
+                cell.sequence.store (position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false; // still holds a command from a lap ago, the queue is full
+        }
+        else
+        {
+            position = enqueuePosition.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+bool CommandQueue::pop (Command& command) noexcept
+{
+    auto& cell = cells[dequeuePosition & mask];
+
+    // not published yet, or nothing was pushed
+    if (cell.sequence.load (std::memory_order_acquire) != dequeuePosition + 1)
+        return false;
+
+    command = cell.command;
+
+    // free the cell for the producer one lap ahead
+    cell.sequence.store (dequeuePosition + (size_t) capacity, std::memory_order_release);
+    ++dequeuePosition;
+    return true;
+}
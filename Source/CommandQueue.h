@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    CommandQueue.h
+    Timestamped commands from the message, host and background threads to the
+    audio thread, without locks or allocation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Something the audio thread should do at a given sample.
+*/
+struct Command
+{
+    enum class Type
+    {
+        clear = 0,  // empty the delay lines and silence the rest of the block
+        freeze,     // value >= 0.5 holds what's in the delay buffer and stops taking input, below releases it
+        tapTempo,   // a tap, the delay follows the time between taps
+        resize,     // a resized delay buffer is ready to be swapped in
+        presetSwap, // new parameter values were just loaded, jump to them instead of gliding
+        impulseSwap // a newly loaded impulse response is ready to be swapped in
+    };
+
+    Type type {Type::clear};
+    juce::int64 samplePosition {0}; // on the processor's sample clock, anything already past happens at the start of the next block
+    float value {0.0f};
+};
+
+//==============================================================================
+/**
+    A bounded queue with any number of producers and a single consumer, after
+    Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence number:
+    a producer claims the next cell with one compare-and-swap on the enqueue
+    position, fills it in and then publishes it by bumping its sequence. The
+    consumer is the audio thread alone, so popping needs no compare-and-swap
+    at all. Producers never wait on the consumer: a full queue just makes
+    push() return false.
+*/
+class CommandQueue
+{
+public:
+    static constexpr int capacity = 256; // a power of two
+
+    CommandQueue();
+
+    // any thread. false if the queue is full.
+    bool push (const Command& command) noexcept;
+
+    // the audio thread only. false if there's nothing to pop.
+    bool pop (Command& command) noexcept;
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Command command;
+    };
+
+    static constexpr size_t mask = (size_t) capacity - 1;
+
+    Cell cells[capacity];
+
+    // apart, so producers and the consumer don't fight over a cache line
+    alignas (64) std::atomic<size_t> enqueuePosition {0};
+    alignas (64) size_t dequeuePosition {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CommandQueue)
+};
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    DelayRing.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayRing.h"
+
+//==============================================================================
+void DelayRing::setSize (int numChannels, int minimumLength, int maxSpan)
+{
+    auto length = juce::nextPowerOfTwo (juce::jmax (minimumLength, maxSpan, 1));
+    mask = length - 1;
+    guardSize = maxSpan;
+
+    storage.setSize (numChannels, length + guardSize);
+    clear();
+}
+
+void DelayRing::clear()
+{
+    storage.clear();
+}
+
+void DelayRing::write (int channel, int writePosition, const float* source, int numSamples)
+{
+    jassert (numSamples <= guardSize);
+
+    auto* data = storage.getWritePointer (channel);
+    writePosition &= mask;
+
+    // the guard region takes whatever runs off the end, so the write itself is one copy
+    juce::FloatVectorOperations::copy (data + writePosition, source, numSamples);
+    mirror (data, writePosition, numSamples);
+}
+
+void DelayRing::commit (int channel, int writePosition, int numSamples)
+{
+    jassert (numSamples <= guardSize);
+    mirror (storage.getWritePointer (channel), writePosition & mask, numSamples);
+}
+
+void DelayRing::commit (float* channelData, int writePosition, int numSamples) const
+{
+    jassert (numSamples <= guardSize);
+    mirror (channelData, writePosition & mask, numSamples);
+}
+
+void DelayRing::mirror (float* data, int writePosition, int numSamples) const
+{
+    auto length = mask + 1;
+
+    // brings the two copies back in step: anything written past the end belongs at the start...
+    if (writePosition + numSamples > length)
+        juce::FloatVectorOperations::copy (data, data + length, writePosition + numSamples - length);
+
+    // ...and anything written at the start is mirrored into the guard region.
+    // both are rare and well predicted, cheaper than two empty copy calls on every block.
+    if (writePosition < guardSize)
+        juce::FloatVectorOperations::copy (data + length + writePosition, data + writePosition, juce::jmin (numSamples, guardSize - writePosition));
+}
+
+void DelayRing::copyHistoryFrom (const DelayRing& source, juce::int64 from, juce::int64 to)
+{
+    auto numChannels = juce::jmin (getNumChannels(), source.getNumChannels());
+
+    // only the newest samples that fit in both rings
+    from = juce::jmax (from, to - juce::jmin (getNumSamples(), source.getNumSamples()));
+
+    // both rings have a guard, so a chunk up to the smaller guard is contiguous on each side
+    auto chunkSize = (juce::int64) juce::jmin (guardSize, source.guardSize);
+
+    for (auto position = from; position < to; position += chunkSize)
+    {
+        auto numSamples = (int) juce::jmin (chunkSize, to - position);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            write (channel, (int) (position & mask), source.getReadPointer (channel) + (position & source.mask), numSamples);
+    }
+}
+
+void DelayRing::clearHistory (juce::int64 from, juce::int64 to)
+{
+    from = juce::jmax (from, to - getNumSamples());
+
+    for (auto position = from; position < to; position += guardSize)
+    {
+        auto numSamples = (int) juce::jmin ((juce::int64) guardSize, to - position);
+        auto index = (int) (position & mask);
+
+        for (int channel = 0; channel < getNumChannels(); ++channel)
+        {
+            auto* data = storage.getWritePointer (channel);
+            juce::FloatVectorOperations::clear (data + index, numSamples);
+            mirror (data, index, numSamples);
+        }
+    }
+}
+
+DelayRing::View DelayRing::getView() const
+{
+    View view;
+    view.numChannels = juce::jmin (getNumChannels(), View::maxNumChannels);
+    view.mask = mask;
+    view.guardSize = guardSize;
+
+    // copied out, the buffer's own pointer array moves with it when rings are swapped
+    for (int channel = 0; channel < view.numChannels; ++channel)
+        view.channels[channel] = storage.getReadPointer (channel);
+
+    return view;
+}
+
+void DelayRing::swapWith (DelayRing& other) noexcept
+{
+    std::swap (storage, other.storage);
+    std::swap (mask, other.mask);
+    std::swap (guardSize, other.guardSize);
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    DelayRing.h
+    The circular delay buffer: power-of-two length, mask wrapping and a
+    mirrored tail so reads never have to split at the end.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Each channel holds getNumSamples() samples (a power of two) followed by a
+    guard region that mirrors the first getGuardSize() samples. write() keeps
+    the two copies in step, so a read of up to getGuardSize() samples starting
+    at any masked index is one contiguous span: readers never test for the
+    wrap, they just mask the start index.
+
+    Every channel lives in the same allocation, one after the other, made
+    once when the ring is sized (in prepareToPlay(), or off the audio thread
+    by DelayRingResizer), so a block for every channel walks one arena.
+
+    Positions can also be absolute: the number of samples written so far,
+    which masked gives the index. Two rings of different lengths agree on
+    where an absolute position lives, so history can be carried across when
+    the ring is resized (see DelayRingResizer).
+*/
+class DelayRing
+{
+public:
+    DelayRing() = default;
+
+    // allocates and clears. the length is rounded up to a power of two, maxSpan is the longest read or write.
+    void setSize (int numChannels, int minimumLength, int maxSpan);
+    void clear();
+
+    int getNumChannels() const { return storage.getNumChannels(); }
+    int getNumSamples() const { return mask + 1; } // not counting the guard region
+    int getMask() const { return mask; }
+    int getGuardSize() const { return guardSize; }
+
+    // copies numSamples (at most getGuardSize()) to writePosition onwards, wrapping as needed
+    void write (int channel, int writePosition, const float* source, int numSamples);
+
+    // the start of a channel, valid for getNumSamples() + getGuardSize() samples
+    const float* getReadPointer (int channel) const { return storage.getReadPointer (channel); }
+    const float* const* getArrayOfReadPointers() const { return storage.getArrayOfReadPointers(); }
+
+    // for kernels that write straight into the ring: up to getGuardSize() samples from a masked index, then
+    // commit() them so the mirrored copies are brought back in step before anything reads across the wrap
+    float* getWritePointer (int channel) { return storage.getWritePointer (channel); }
+    float* const* getArrayOfWritePointers() { return storage.getArrayOfWritePointers(); }
+    void commit (int channel, int writePosition, int numSamples);
+
+    // the same through a channel pointer from getArrayOfWritePointers(), fetched once up front, so tasks on other
+    // threads never touch the buffer itself (getWritePointer() writes its isClear flag)
+    void commit (float* channelData, int writePosition, int numSamples) const;
+
+    // copies the samples at the absolute positions [from, to) out of source, as far as both rings can hold them
+    void copyHistoryFrom (const DelayRing& source, juce::int64 from, juce::int64 to);
+
+    // silences the samples at the absolute positions [from, to)
+    void clearHistory (juce::int64 from, juce::int64 to);
+
+    // exchanges the memory of the two rings, without allocating
+    void swapWith (DelayRing& other) noexcept;
+
+    /** The ring's memory as plain pointers, for reading it on another thread (see DelayRingResizer::ScopedReader). */
+    struct View
+    {
+        static constexpr int maxNumChannels = 16;
+
+        const float* channels[maxNumChannels] {};
+        int numChannels {0};
+        int mask {0};
+        int guardSize {0};
+
+        int getNumSamples() const { return mask + 1; }
+        float getSample (int channel, juce::int64 position) const { return channels[channel][position & mask]; }
+    };
+
+    View getView() const;
+
+private:
+    void mirror (float* data, int writePosition, int numSamples) const;
+
+    juce::AudioBuffer<float> storage;
+    int mask {0};
+    int guardSize {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayRing)
+};
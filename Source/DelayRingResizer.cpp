@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    DelayRingResizer.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayRingResizer.h"
+
+//==============================================================================
+DelayRingResizer::DelayRingResizer (DelayRing& ringToResize, const std::atomic<juce::int64>& samplesWrittenCounter)
+    : juce::Thread ("Delay ring resizer"), ring (ringToResize), samplesWritten (samplesWrittenCounter)
+{
+}
+
+DelayRingResizer::~DelayRingResizer()
+{
+    stop();
+}
+
+void DelayRingResizer::start()
+{
+    stop();
+
+    currentLength.store (ring.getNumSamples());
+    requestedLength.store (0);
+    startThread();
+}
+
+void DelayRingResizer::stop()
+{
+    stopThread (1000);
+
+    delete ready.exchange (nullptr);
+    delete retired.exchange (nullptr);
+    delete offered.exchange (nullptr);
+}
+
+bool DelayRingResizer::swapIfReady()
+{
+    auto* newRing = ready.load (std::memory_order_acquire);
+
+    // the background thread frees the last one before it builds another, so retired is empty here
+    if (newRing == nullptr || retired.load (std::memory_order_acquire) != nullptr)
+        return false;
+
+    // someone's reading the ring, it's offered again once they're done
+    if (numReaders.load() > 0)
+    {
+        declined = true;
+        return false;
+    }
+
+    ready.store (nullptr, std::memory_order_relaxed);
+
+    // catch up with what was written while it was being built, usually a few blocks
+    newRing->copyHistoryFrom (ring, readyUpTo, samplesWritten.load (std::memory_order_relaxed));
+
+    generation.fetch_add (1);
+    ring.swapWith (*newRing);
+    generation.fetch_add (1);
+
+    currentLength.store (ring.getNumSamples(), std::memory_order_relaxed);
+    swappedOffered = readyWasOffered;
+    retired.store (newRing, std::memory_order_release);
+    return true;
+}
+
+bool DelayRingResizer::isOfferReady() const
+{
+    return ready.load (std::memory_order_acquire) != nullptr && readyWasOffered;
+}
+
+bool DelayRingResizer::offer (std::unique_ptr<DelayRing> newRing, juce::int64 upTo)
+{
+    DelayRing* expected = nullptr;
+    offeredUpTo.store (upTo, std::memory_order_relaxed);
+
+    if (! offered.compare_exchange_strong (expected, newRing.get(), std::memory_order_acq_rel))
+        return false;
+
+    newRing.release();
+    notify();
+    return true;
+}
+
+//==============================================================================
+DelayRingResizer::ScopedReader::ScopedReader (DelayRingResizer& resizer)
+    : owner (resizer)
+{
+    owner.numReaders.fetch_add (1);
+
+    // a swap that started before the reader was registered may still be going, take the view either side of it
+    for (;;)
+    {
+        auto before = owner.generation.load();
+
+        if ((before & 1) == 0)
+        {
+            view = owner.ring.getView();
+
+            if (owner.generation.load() == before)
+                break;
+        }
+
+        juce::Thread::yield();
+    }
+}
+
+DelayRingResizer::ScopedReader::~ScopedReader()
+{
+    owner.numReaders.fetch_sub (1);
+}
+
+void DelayRingResizer::run()
+{
+    while (! threadShouldExit())
+    {
+        reclaim();
+
+        if (declined.exchange (false))
+            readyAnnounced = false;
+
+        auto canPublish = ready.load (std::memory_order_acquire) == nullptr && retired.load (std::memory_order_acquire) == nullptr;
+        auto requested = requestedLength.load (std::memory_order_relaxed);
+
+        if (canPublish && offered.load (std::memory_order_acquire) != nullptr)
+        {
+            readyUpTo = offeredUpTo.load (std::memory_order_relaxed);
+            readyWasOffered = true;
+            readyAnnounced = false;
+            ready.store (offered.exchange (nullptr, std::memory_order_acq_rel), std::memory_order_release);
+        }
+        else if (requested > 0)
+        {
+            auto length = juce::nextPowerOfTwo (requested);
+
+            if (length != currentLength.load (std::memory_order_relaxed)
+                 && ready.load (std::memory_order_acquire) == nullptr
+                 && retired.load (std::memory_order_acquire) == nullptr)
+                build (length);
+        }
+
+        if (onReady != nullptr && ! readyAnnounced && ready.load (std::memory_order_acquire) != nullptr)
+            readyAnnounced = onReady();
+
+        wait (pollIntervalMs);
+    }
+}
+
+void DelayRingResizer::build (int length)
+{
+    auto newRing = std::make_unique<DelayRing>();
+    newRing->setSize (ring.getNumChannels(), length, ring.getGuardSize());
+
+    // copy the history up to here. the audio thread carries on writing meanwhile...
+    auto copiedUpTo = samplesWritten.load (std::memory_order_acquire);
+    auto copiedFrom = copiedUpTo - newRing->getNumSamples();
+    newRing->copyHistoryFrom (ring, copiedFrom, copiedUpTo);
+
+    // ...over the oldest samples in the ring, so anything it may have reached (and a block in progress) is silenced
+    auto oldestIntact = samplesWritten.load (std::memory_order_acquire) + ring.getGuardSize() - ring.getNumSamples();
+
+    if (oldestIntact > copiedFrom)
+        newRing->clearHistory (copiedFrom, juce::jmin (oldestIntact, copiedUpTo));
+
+    readyUpTo = copiedUpTo;
+    readyWasOffered = false;
+    readyAnnounced = false;
+    ready.store (newRing.release(), std::memory_order_release);
+}
+
+void DelayRingResizer::reclaim()
+{
+    // off the audio thread, big rings can take a while to give back. a reader may still be looking at it.
+    if (numReaders.load() == 0)
+        delete retired.exchange (nullptr, std::memory_order_acq_rel);
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    DelayRingResizer.h
+    Grows or shrinks the delay ring on a background thread and hands the new
+    one to the audio thread without locks or allocation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayRing.h"
+
+//==============================================================================
+/**
+    The audio thread asks for a length with requestLength(), which is just an
+    atomic store. The background thread notices, allocates a ring of that
+    length, copies the newest history it can hold out of the live ring and
+    publishes it through an atomic pointer, and says so through onReady. The
+    audio thread then calls swapIfReady() between sub-blocks: that copies the few samples written while the
+    new ring was being built, swaps the two rings' memory and passes the old
+    one back through a second atomic pointer for the background thread to
+    free. Only one ring is ever in flight each way.
+
+    A ring filled somewhere else (a restored snapshot) can be offered in and
+    goes through the same hand-over. Other threads that need to read the live
+    ring register a ScopedReader: while one exists, rings are neither swapped
+    nor freed.
+*/
+class DelayRingResizer : private juce::Thread
+{
+public:
+    // samplesWritten is the absolute write position of ring, advanced by the audio thread after each write
+    DelayRingResizer (DelayRing& ringToResize, const std::atomic<juce::int64>& samplesWritten);
+    ~DelayRingResizer() override;
+
+    // message thread, while the audio thread isn't running
+    void start();
+    void stop(); // also frees whatever was built or retired but not handed over yet
+
+    // audio thread. the ring will end up at least this long (rounded up to a power of two)
+    void requestLength (int minimumLength) { requestedLength.store (minimumLength, std::memory_order_relaxed); }
+
+    // audio thread, between blocks. returns true if a new ring was swapped in.
+    bool swapIfReady();
+    
+    // background thread, once a ring is ready to swap. returning false means the message didn't get through,
+    // it's tried again on the next poll. set it before start().
+    std::function<bool()> onReady;
+
+    // any thread but the audio thread. the ring is swapped in like a resized one, catching up with what's been
+    // written since upTo. false if another offer is still waiting.
+    bool offer (std::unique_ptr<DelayRing> newRing, juce::int64 upTo);
+
+    // audio thread. whether the ring waiting to be swapped in came from offer(), and after swapIfReady() returned
+    // true, whether the one it swapped in did
+    bool isOfferReady() const;
+    bool lastSwapWasOffered() const { return swappedOffered; }
+
+    /**
+        Lets any thread but the audio thread read the ring's memory. The view
+        is taken while no swap is under way and stays readable, if perhaps no
+        longer live, until the reader is destroyed. Keep it short: resizes
+        wait meanwhile.
+    */
+    class ScopedReader
+    {
+    public:
+        explicit ScopedReader (DelayRingResizer& resizer);
+        ~ScopedReader();
+
+        const DelayRing::View& getView() const { return view; }
+
+    private:
+        DelayRingResizer& owner;
+        DelayRing::View view;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedReader)
+    };
+
+private:
+    void run() override;
+    void build (int length);
+    void reclaim();
+
+    static constexpr int pollIntervalMs = 20;
+
+    DelayRing& ring;
+    const std::atomic<juce::int64>& samplesWritten;
+
+    std::atomic<int> requestedLength {0};
+    std::atomic<int> currentLength {0};         // the live ring's length, as the background thread sees it
+    std::atomic<DelayRing*> ready {nullptr};    // built, waiting for the audio thread
+    std::atomic<DelayRing*> retired {nullptr};  // swapped out, waiting for the background thread to free it
+    juce::int64 readyUpTo {0};                  // absolute position the ready ring has been copied up to
+    bool readyAnnounced {false};                // onReady has been told about the ready ring
+    bool readyWasOffered {false};               // the ready ring came from offer(), not build()
+    bool swappedOffered {false};
+
+    std::atomic<DelayRing*> offered {nullptr};  // from offer(), waiting to be made ready
+    std::atomic<juce::int64> offeredUpTo {0};
+
+    std::atomic<int> numReaders {0};
+    std::atomic<juce::uint32> generation {0};   // odd while a swap is under way
+    std::atomic<bool> declined {false};         // a swap was put off for a reader, announce it again
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayRingResizer)
+};
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    Ducker.cpp
+
+  ==============================================================================
+*/
+
+#include "Ducker.h"
+
+namespace
+{
+    // the share of the gap to the target a one-pole closes each sample, reaching 63% of the way in timeMs
+    float getOnePoleCoefficient (float timeMs, double sampleRate)
+    {
+        auto timeInSamples = juce::jmax (1.0, (double) timeMs * 0.001 * sampleRate);
+        return (float) (1.0 - std::exp (-1.0 / timeInSamples));
+    }
+}
+
+//==============================================================================
+juce::StringArray Ducker::getDetectorNames()
+{
+    return { "Peak", "RMS" };
+}
+
+juce::StringArray Ducker::getSourceNames()
+{
+    return { "Input", "Sidechain" };
+}
+
+void Ducker::prepare (double newSampleRate, int newMaxBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = newMaxBlockSize;
+
+    levels.allocate ((size_t) maxBlockSize, true);
+    gains.allocate ((size_t) maxBlockSize, true);
+    reset();
+}
+
+void Ducker::reset()
+{
+    envelope = 0.0f;
+}
+
+void Ducker::setParameters (Detector newDetector, float thresholdDecibels, float depthDecibels, float attackMs, float releaseMs)
+{
+    // the envelope of one detector means nothing to the other
+    if (newDetector != detector)
+        reset();
+
+    detector = newDetector;
+
+    auto thresholdGain = juce::Decibels::decibelsToGain (thresholdDecibels);
+    threshold = detector == Detector::rms ? thresholdGain * thresholdGain : thresholdGain;
+    floorGain = juce::Decibels::decibelsToGain (juce::jmin (0.0f, depthDecibels));
+
+    attackCoefficient = getOnePoleCoefficient (attackMs, sampleRate);
+    releaseCoefficient = getOnePoleCoefficient (releaseMs, sampleRate);
+}
+
+void Ducker::process (const float* const* channels, int numChannels, int numSamples)
+{
+    jassert (numSamples <= maxBlockSize);
+
+    if (numChannels < 1)
+    {
+        juce::FloatVectorOperations::fill (gains, 1.0f, numSamples);
+        return;
+    }
+
+    // the detector, linked across the channels
+    if (detector == Detector::peak)
+    {
+        juce::FloatVectorOperations::abs (levels, channels[0], numSamples);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            juce::FloatVectorOperations::abs (gains, channels[channel], numSamples);
+            juce::FloatVectorOperations::max (levels, levels, gains, numSamples);
+        }
+    }
+    else
+    {
+        juce::FloatVectorOperations::multiply (levels, channels[0], channels[0], numSamples);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::addWithMultiply (levels, channels[channel], channels[channel], numSamples);
+
+        juce::FloatVectorOperations::multiply (levels, 1.0f / (float) numChannels, numSamples);
+    }
+
+    // the follower, in place
+    auto env = envelope;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto coefficient = levels[i] > env ? attackCoefficient : releaseCoefficient;
+        env += coefficient * (levels[i] - env);
+        levels[i] = env;
+    }
+
+    envelope = env;
+
+    // the gain curve: down to the threshold, not below the floor. a power's gain is the square root of the ratio.
+    constexpr float minimumLevel = 1.0e-9f;
+    auto* envelopes = levels.getData();
+    auto* output = gains.getData();
+
+    if (detector == Detector::peak)
+        for (int i = 0; i < numSamples; ++i)
+            output[i] = juce::jlimit (floorGain, 1.0f, threshold / juce::jmax (minimumLevel, envelopes[i]));
+    else
+        for (int i = 0; i < numSamples; ++i)
+            output[i] = juce::jlimit (floorGain, 1.0f, std::sqrt (threshold / juce::jmax (minimumLevel, envelopes[i])));
+}
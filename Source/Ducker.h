@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    Ducker.h
+    Pulls the echoes down while the input, or a sidechain, is loud, so the
+    repeats bloom in the gaps instead of clouding the playing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    An envelope follower and a gain curve, a gain per sample for the wet mix.
+
+    process() works through a block in three passes over plain arrays:
+
+    - the detector: the loudest channel's level (peak) or the mean of the
+      channels' squares (RMS), linked so every echo ducks together. Whole
+      block vector operations.
+    - the follower: a one-pole smoother that rises at the attack time and
+      falls at the release time. Each sample depends on the last, so this is
+      the one serial loop, with the attack or release picked by a select
+      rather than a branch.
+    - the gain curve: anything over the threshold is brought back down to it,
+      but never by more than the depth. No dependency between samples, so the
+      compiler vectorises it.
+
+    The gains are meant to be multiplied in as the echoes are added to the
+    output, so the ducking doesn't cost a pass over the block of its own.
+*/
+class Ducker
+{
+public:
+    // the order matches the choices of the DUCK_DETECTOR parameter
+    enum class Detector
+    {
+        peak = 0,
+        rms
+    };
+
+    // the order matches the choices of the DUCK_SOURCE parameter
+    enum class Source
+    {
+        input = 0,
+        sidechain   // the second input bus, or the input while that's disabled
+    };
+
+    Ducker() = default;
+
+    static juce::StringArray getDetectorNames();
+    static juce::StringArray getSourceNames();
+
+    void prepare (double sampleRate, int maxBlockSize);
+    void reset();
+
+    // audio thread, once per block. depth is how far down the echoes can go, in negative dB.
+    void setParameters (Detector newDetector, float thresholdDecibels, float depthDecibels, float attackMs, float releaseMs);
+
+    // follows the next numSamples (at most maxBlockSize) of the detector channels into getGains()
+    void process (const float* const* channels, int numChannels, int numSamples);
+
+    const float* getGains() const { return gains.getData(); }
+
+private:
+    double sampleRate {44100.0};
+    int maxBlockSize {0};
+
+    Detector detector {Detector::peak};
+    float threshold {1.0f};         // a level for peak, a power for RMS, like the envelope
+    float floorGain {1.0f};
+    float attackCoefficient {1.0f}, releaseCoefficient {1.0f};
+
+    float envelope {0.0f};
+    juce::HeapBlock<float> levels, gains;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Ducker)
+};
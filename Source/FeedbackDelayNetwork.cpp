@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    FeedbackDelayNetwork.cpp
+
+  ==============================================================================
+*/
+
+#include "FeedbackDelayNetwork.h"
+
+using Vec = juce::dsp::SIMDRegister<float>;
+
+//==============================================================================
+juce::StringArray FeedbackDelayNetwork::getLineCountNames()
+{
+    return { "4", "8", "16" };
+}
+
+juce::StringArray FeedbackDelayNetwork::getMatrixNames()
+{
+    return { "Householder", "Hadamard" };
+}
+
+void FeedbackDelayNetwork::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    numFrames = juce::nextPowerOfTwo ((int) (maxLineSeconds * sampleRate) + 1);
+    frameMask = numFrames - 1;
+
+    // room for the largest network, plus slack to line the start up with a cache line
+    memory.allocate ((size_t) numFrames * maxNumLines * sizeof (float) + 64, true);
+    lines = juce::snapPointerToAlignment (reinterpret_cast<float*> (memory.getData()), (size_t) 64);
+
+    updateLines();
+    reset();
+}
+
+void FeedbackDelayNetwork::reset()
+{
+    if (lines != nullptr)
+        juce::FloatVectorOperations::clear (lines, numFrames * numLines);
+
+    juce::FloatVectorOperations::clear (dampingStates, maxNumLines);
+    writeFrame = 0;
+}
+
+void FeedbackDelayNetwork::setParameters (int newNumLines, MixingMatrix newMatrix, float sizeSeconds, float decaySeconds, float damping)
+{
+    jassert (newNumLines == 4 || newNumLines == 8 || newNumLines == 16);
+
+    auto layoutChanged = newNumLines != numLines;
+    auto linesChanged = layoutChanged || newMatrix != matrixType || sizeSeconds != size || decaySeconds != decay;
+
+    numLines = newNumLines;
+    matrixType = newMatrix;
+    size = sizeSeconds;
+    decay = decaySeconds;
+    dampingCoefficient = 1.0f - 0.95f * juce::jlimit (0.0f, 1.0f, damping);
+
+    // only recompute the lengths, gains and matrix when something they depend on moved
+    if (linesChanged)
+        updateLines();
+
+    if (layoutChanged)
+        reset();
+}
+
+void FeedbackDelayNetwork::updateLines()
+{
+    auto longest = juce::jlimit (2, numFrames - 1, (int) (size * sampleRate));
+
+    for (int line = 0; line < numLines; ++line)
+    {
+        // spread the lengths over an octave below the longest, odd and strictly decreasing so the echoes don't pile up
+        auto length = juce::roundToInt (longest * std::pow (2.0, -(double) line / numLines)) | 1;
+
+        if (line > 0 && length >= lineLengths[line - 1])
+            length = lineLengths[line - 1] - 2;
+
+        lineLengths[line] = juce::jmax (1, length);
+
+        // per-line gain for a 60 dB decay in decaySeconds, so long and short lines die away together
+        lineGains[line] = (float) std::pow (10.0, -3.0 * lineLengths[line] / (decay * sampleRate));
+    }
+
+    // Sylvester's construction: H[j][k] = (-1)^popcount(j & k) / sqrt(N)
+    auto scale = 1.0f / std::sqrt ((float) numLines);
+
+    for (int j = 0; j < numLines; ++j)
+    {
+        for (int k = 0; k < numLines; ++k)
+        {
+            int bits = j & k, parity = 0;
+
+            for (; bits != 0; bits &= bits - 1)
+                parity ^= 1;
+
+            hadamard[j * numLines + k] = parity != 0 ? -scale : scale;
+        }
+    }
+}
+
+void FeedbackDelayNetwork::mix (float* values) const
+{
+    auto numVectors = numLines / (int) Vec::size();
+
+    // 4 lines with 8-wide registers can't be vectorised, fall back to scalar code
+    if (numVectors == 0)
+    {
+        alignas (64) float mixed[maxNumLines];
+
+        if (matrixType == MixingMatrix::householder)
+        {
+            float sum = 0.0f;
+
+            for (int k = 0; k < numLines; ++k)
+                sum += values[k];
+
+            for (int k = 0; k < numLines; ++k)
+                mixed[k] = values[k] - (2.0f / numLines) * sum;
+        }
+        else
+        {
+            for (int k = 0; k < numLines; ++k)
+            {
+                mixed[k] = 0.0f;
+
+                for (int j = 0; j < numLines; ++j)
+                    mixed[k] += hadamard[j * numLines + k] * values[j];
+            }
+        }
+
+        std::copy (mixed, mixed + numLines, values);
+        return;
+    }
+
+    if (matrixType == MixingMatrix::householder)
+    {
+        auto sum = Vec::expand (0.0f);
+
+        for (int v = 0; v < numVectors; ++v)
+            sum += Vec::fromRawArray (values + v * Vec::size());
+
+        auto reflection = Vec::expand (sum.sum() * (2.0f / numLines));
+
+        for (int v = 0; v < numVectors; ++v)
+            (Vec::fromRawArray (values + v * Vec::size()) - reflection).copyToRawArray (values + v * Vec::size());
+    }
+    else
+    {
+        // y = sum over j of x[j] * column j, each column a run of registers
+        Vec mixed[maxNumLines];
+
+        for (int v = 0; v < numVectors; ++v)
+            mixed[v] = Vec::expand (0.0f);
+
+        for (int j = 0; j < numLines; ++j)
+        {
+            auto x = Vec::expand (values[j]);
+            auto* column = hadamard + j * numLines;
+
+            for (int v = 0; v < numVectors; ++v)
+                mixed[v] = Vec::multiplyAdd (mixed[v], x, Vec::fromRawArray (column + v * Vec::size()));
+        }
+
+        for (int v = 0; v < numVectors; ++v)
+            mixed[v].copyToRawArray (values + v * Vec::size());
+    }
+}
+
+void FeedbackDelayNetwork::process (float* const* channels, int numChannels, int numSamples, const float* wetGains, float wetGain)
+{
+    jassert (lines != nullptr && numChannels > 0 && numChannels <= maxNumLines);
+
+    auto numVectors = numLines / (int) Vec::size();
+    auto damping = Vec::expand (dampingCoefficient);
+
+    // each channel feeds, and listens to, every numChannels-th line. alternate signs decorrelate the outputs.
+    // with more channels than lines (7.1.4, ambisonics) the channels take turns on the lines instead, and the
+    // ones sharing a line share its input.
+    auto numConnections = juce::jmax (numLines, numChannels);
+    auto outputScale = std::sqrt ((float) numChannels / numConnections);
+    auto inputScale = std::sqrt ((float) numLines / numConnections);
+
+    alignas (64) float values[maxNumLines];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // gather: every line has its own length, so this is the one strided access
+        for (int line = 0; line < numLines; ++line)
+            values[line] = lines[((writeFrame - lineLengths[line]) & frameMask) * numLines + line];
+
+        // damp (one-pole lowpass) and decay every line at once
+        if (numVectors > 0)
+        {
+            for (int v = 0; v < numVectors; ++v)
+            {
+                auto offset = v * (int) Vec::size();
+                auto out = Vec::fromRawArray (values + offset);
+                auto state = Vec::fromRawArray (dampingStates + offset);
+
+                state = Vec::multiplyAdd (state, damping, out - state);
+                state.copyToRawArray (dampingStates + offset);
+                (state * Vec::fromRawArray (lineGains + offset)).copyToRawArray (values + offset);
+            }
+        }
+        else
+        {
+            for (int line = 0; line < numLines; ++line)
+            {
+                dampingStates[line] += dampingCoefficient * (values[line] - dampingStates[line]);
+                values[line] = dampingStates[line] * lineGains[line];
+            }
+        }
+
+        // the network's output is taken before mixing, the dry input is injected after
+        auto gain = (wetGains != nullptr ? wetGains[i] : wetGain) * outputScale;
+        float outputs[maxNumLines] {};
+
+        for (int k = 0; k < numConnections; ++k)
+        {
+            auto value = values[k % numLines];
+            outputs[k % numChannels] += (k / numChannels + k / numLines) % 2 == 0 ? value : -value;
+        }
+
+        mix (values);
+
+        for (int k = 0; k < numConnections; ++k)
+            values[k % numLines] += channels[k % numChannels][i] * inputScale;
+
+        // the write is one contiguous frame
+        auto* frame = lines + writeFrame * numLines;
+
+        if (numVectors > 0)
+            for (int v = 0; v < numVectors; ++v)
+                Vec::fromRawArray (values + v * Vec::size()).copyToRawArray (frame + v * Vec::size());
+        else
+            std::copy (values, values + numLines, frame);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            channels[channel][i] += gain * outputs[channel];
+
+        writeFrame = (writeFrame + 1) & frameMask;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    FeedbackDelayNetwork.h
+    N delay lines (4, 8 or 16) fed back into each other through a mixing matrix.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    All the lines live in one interleaved buffer: frame f holds sample f of every
+    line side by side (lines[f * numLines + line]). Every sample the network
+    gathers one output per line, then damps, decays, mixes and writes a whole
+    frame back as SIMD registers. The frame count is a power of two so wrapping
+    is a mask.
+*/
+class FeedbackDelayNetwork
+{
+public:
+    // the order matches the choices of the FDN_MATRIX parameter
+    enum class MixingMatrix
+    {
+        householder = 0,  // I - 2/N * ones, O(N)
+        hadamard          // Sylvester construction scaled by 1/sqrt(N), dense N x N
+    };
+
+    static constexpr int maxNumLines = 16;
+    static constexpr double maxLineSeconds = 1.0;
+
+    FeedbackDelayNetwork() = default;
+
+    static juce::StringArray getLineCountNames();
+    static juce::StringArray getMatrixNames();
+    static int getLineCountForIndex (int index) { return 4 << index; }
+
+    // allocates the line memory, this is the only place the network allocates
+    void prepare (double sampleRate);
+    void reset();
+
+    // sizeSeconds sets the longest line, decaySeconds is the time for a 60 dB drop, damping is 0..1.
+    // changing the number of lines changes the frame layout, so it clears the lines.
+    void setParameters (int newNumLines, MixingMatrix newMatrix, float sizeSeconds, float decaySeconds, float damping);
+
+    // adds the network's output to each channel; wetGains is a per-sample ramp or nullptr to use wetGain
+    void process (float* const* channels, int numChannels, int numSamples, const float* wetGains, float wetGain);
+
+private:
+    void updateLines();
+    void mix (float* values) const;
+
+    juce::HeapBlock<char> memory;
+    float* lines {nullptr}; // 64-byte aligned view into memory
+    int numFrames {0};
+    int frameMask {0};
+    int writeFrame {0};
+
+    int numLines {8};
+    MixingMatrix matrixType {MixingMatrix::householder};
+    double sampleRate {44100.0};
+    float size {0.1f};
+    float decay {2.0f};
+    float dampingCoefficient {1.0f};
+
+    int lineLengths[maxNumLines] {};
+    alignas (64) float lineGains[maxNumLines] {};
+    alignas (64) float dampingStates[maxNumLines] {};
+    alignas (64) float hadamard[maxNumLines * maxNumLines] {}; // column j of the matrix starts at j * numLines
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeedbackDelayNetwork)
+};
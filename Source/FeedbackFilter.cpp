@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    FeedbackFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "FeedbackFilter.h"
+
+using Vec = juce::dsp::SIMDRegister<float>;
+
+//==============================================================================
+void FeedbackFilter::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // new coefficients for the new rate at the next setParameters()
+    lowCut = -1.0f;
+    reset();
+}
+
+void FeedbackFilter::reset()
+{
+    std::fill (&states[0][0][0], &states[0][0][0] + maxNumStages * 2 * maxNumChannels, 0.0f);
+}
+
+void FeedbackFilter::setParameters (float lowCutHz, float highCutHz, float tiltDecibels, int newNumChannels)
+{
+    newNumChannels = juce::jlimit (0, maxNumChannels, newNumChannels);
+
+    if (newNumChannels != numChannels)
+    {
+        numChannels = newNumChannels;
+        reset();
+    }
+
+    if (lowCutHz == lowCut && highCutHz == highCut && tiltDecibels == tilt)
+        return;
+
+    lowCut = lowCutHz;
+    highCut = highCutHz;
+    tilt = tiltDecibels;
+    updateStages();
+}
+
+FeedbackFilter::Stage FeedbackFilter::makeStage (double g, double k, double m0, double m1, double m2)
+{
+    Stage stage;
+    auto a1 = 1.0 / (1.0 + g * (g + k));
+    stage.a1 = (float) a1;
+    stage.a2 = (float) (g * a1);
+    stage.a3 = (float) (g * g * a1);
+    stage.m0 = (float) m0;
+    stage.m1 = (float) m1;
+    stage.m2 = (float) m2;
+    return stage;
+}
+
+void FeedbackFilter::updateStages()
+{
+    // butterworth damping, the cutoffs kept clear of nyquist where the prewarp runs away
+    constexpr double k = juce::MathConstants<double>::sqrt2;
+    auto maxFrequency = 0.45 * sampleRate;
+    auto prewarp = [this, maxFrequency] (double frequency)
+    {
+        return std::tan (juce::MathConstants<double>::pi * juce::jlimit (1.0, maxFrequency, frequency) / sampleRate);
+    };
+
+    numStages = 0;
+
+    // high-pass: input - k * band - low
+    stages[numStages++] = makeStage (prewarp (lowCut), k, 1.0, -k, -1.0);
+
+    // low-pass: low
+    stages[numStages++] = makeStage (prewarp (highCut), k, 0.0, 0.0, 1.0);
+
+    if (tilt != 0.0f)
+    {
+        // a high shelf of the whole tilt, with everything scaled down by half of it, pivots around tiltFrequency
+        auto a = std::pow (10.0, tilt / 40.0);
+        auto level = 1.0 / a;
+        stages[numStages++] = makeStage (prewarp (tiltFrequency) * std::sqrt (a), k,
+                                         level * a * a, level * k * (1.0 - a) * a, level * (1.0 - a * a));
+    }
+}
+
+//==============================================================================
+void FeedbackFilter::process (float* const* channels, int numSamples)
+{
+    constexpr auto vecSize = (int) Vec::size();
+    auto numVectors = (numChannels + vecSize - 1) / vecSize;
+
+    // frames of every channel side by side, the lanes past the last channel stay silent
+    alignas (64) float frames[chunkSize][maxNumChannels];
+
+    for (int i = 0; i < chunkSize; ++i)
+        std::fill (frames[i] + numChannels, frames[i] + maxNumChannels, 0.0f);
+
+    Vec a1[maxNumStages], a2[maxNumStages], a3[maxNumStages], m0[maxNumStages], m1[maxNumStages], m2[maxNumStages];
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        a1[s] = Vec::expand (stages[s].a1);
+        a2[s] = Vec::expand (stages[s].a2);
+        a3[s] = Vec::expand (stages[s].a3);
+        m0[s] = Vec::expand (stages[s].m0);
+        m1[s] = Vec::expand (stages[s].m1);
+        m2[s] = Vec::expand (stages[s].m2);
+    }
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        auto numThisChunk = juce::jmin (chunkSize, numSamples - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numThisChunk; ++i)
+                frames[i][channel] = channels[channel][start + i];
+
+        for (int v = 0; v < numVectors; ++v)
+        {
+            auto lane = v * vecSize;
+            Vec ic1[maxNumStages], ic2[maxNumStages];
+
+            for (int s = 0; s < numStages; ++s)
+            {
+                ic1[s] = Vec::fromRawArray (states[s][0] + lane);
+                ic2[s] = Vec::fromRawArray (states[s][1] + lane);
+            }
+
+            for (int i = 0; i < numThisChunk; ++i)
+            {
+                auto x = Vec::fromRawArray (frames[i] + lane);
+
+                for (int s = 0; s < numStages; ++s)
+                {
+                    auto v3 = x - ic2[s];
+                    auto band = a1[s] * ic1[s] + a2[s] * v3;
+                    auto low = ic2[s] + a2[s] * ic1[s] + a3[s] * v3;
+                    ic1[s] = band * 2.0f - ic1[s];
+                    ic2[s] = low * 2.0f - ic2[s];
+                    x = m0[s] * x + m1[s] * band + m2[s] * low;
+                }
+
+                x.copyToRawArray (frames[i] + lane);
+            }
+
+            for (int s = 0; s < numStages; ++s)
+            {
+                ic1[s].copyToRawArray (states[s][0] + lane);
+                ic2[s].copyToRawArray (states[s][1] + lane);
+            }
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numThisChunk; ++i)
+                channels[channel][start + i] = frames[i][channel];
+    }
+}
+
+void FeedbackFilter::processPerChannel (float* const* channels, int numSamples)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = channels[channel];
+
+        for (int s = 0; s < numStages; ++s)
+        {
+            auto& stage = stages[s];
+            auto ic1 = states[s][0][channel];
+            auto ic2 = states[s][1][channel];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = samples[i];
+                auto v3 = x - ic2;
+                auto band = stage.a1 * ic1 + stage.a2 * v3;
+                auto low = ic2 + stage.a2 * ic1 + stage.a3 * v3;
+                ic1 = 2.0f * band - ic1;
+                ic2 = 2.0f * low - ic2;
+                samples[i] = stage.m0 * x + stage.m1 * band + stage.m2 * low;
+            }
+
+            states[s][0][channel] = ic1;
+            states[s][1][channel] = ic2;
+        }
+    }
+}
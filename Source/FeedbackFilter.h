@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    FeedbackFilter.h
+    Low cut, high cut and tilt on the echoes before they're fed back, so
+    every repeat comes back a little darker and thinner than the last.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A cascade of up to three topology-preserving-transform state variable
+    filters: a 12 dB/octave high-pass (the low cut), a 12 dB/octave low-pass
+    (the high cut) and a high shelf around tiltFrequency, with the level
+    pulled down by half its gain, for the tilt. Every stage is the same
+    recursion with a different mix of its outputs, so the cascade is a loop
+    over stages. The trapezoidal integrators keep the filters stable and
+    free of zipper noise when the cutoffs move between blocks.
+
+    A recursive filter can't be vectorised along the block, so the channels
+    go in the SIMD lanes instead: a chunk of every channel is interleaved
+    into frames, each register of channels runs through the cascade a
+    sample at a time, and the result is written back planar. Up to four
+    channels cost the same as one.
+
+    The coefficients only change in setParameters(), and only when a
+    parameter did, so a steady filter costs nothing but the recursion.
+*/
+class FeedbackFilter
+{
+public:
+    static constexpr int maxNumChannels = 16;
+
+    FeedbackFilter() = default;
+
+    void prepare (double sampleRate);
+    void reset();
+
+    // audio thread, once per block. a tilt of 0 dB leaves the shelf out of the cascade.
+    void setParameters (float lowCutHz, float highCutHz, float tiltDecibels, int newNumChannels);
+
+    // filters every channel in place
+    void process (float* const* channels, int numSamples);
+
+    // the same cascade a channel at a time, scalar. kept for the benchmark.
+    void processPerChannel (float* const* channels, int numSamples);
+
+private:
+    static constexpr int chunkSize = 64;
+    static constexpr int maxNumStages = 3;
+    static constexpr double tiltFrequency = 1000.0;
+
+    // one state variable filter: a1..a3 run the integrators, the output is m0 * input + m1 * band + m2 * low
+    struct Stage
+    {
+        float a1 {1.0f}, a2 {0.0f}, a3 {0.0f};
+        float m0 {1.0f}, m1 {0.0f}, m2 {0.0f};
+    };
+
+    static Stage makeStage (double g, double k, double m0, double m1, double m2);
+    void updateStages();
+
+    double sampleRate {44100.0};
+    int numChannels {0};
+    float lowCut {-1.0f}, highCut {-1.0f}, tilt {0.0f};
+
+    Stage stages[maxNumStages];
+    int numStages {0};
+
+    // the two integrator states of every stage, a channel per lane
+    alignas (64) float states[maxNumStages][2][maxNumChannels] {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeedbackFilter)
+};
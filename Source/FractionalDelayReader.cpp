@@ -0,0 +1,553 @@
+/*
+  ==============================================================================
+
+    FractionalDelayReader.cpp
+
+  ==============================================================================
+*/
+
+#include "FractionalDelayReader.h"
+
+//==============================================================================
+juce::StringArray FractionalDelayReader::getTypeNames()
+{
+    return { "None", "Linear", "Hermite", "Lagrange", "Allpass" };
+}
+
+int FractionalDelayReader::getLookahead (InterpolationType type)
+{
+    switch (type)
+    {
+        case InterpolationType::none:     return 0;
+        case InterpolationType::linear:   return 1;
+        case InterpolationType::hermite:
+        case InterpolationType::lagrange: return 2;
+        case InterpolationType::allpass:  return 2;
+    }
+
+    return 0;
+}
+
+void FractionalDelayReader::prepare (int numChannels)
+{
+    allpassStates.resize (numChannels);
+    reset();
+}
+
+void FractionalDelayReader::reset()
+{
+    allpassStates.fill (0.0f);
+}
+
+void FractionalDelayReader::setType (InterpolationType newType)
+{
+    // the allpass is the only one with memory, don't let it pick up a stale output
+    if (newType != type)
+        reset();
+
+    type = newType;
+}
+
+void FractionalDelayReader::addFrom (float* destination, int numSamples,
+                                     const float* delayData, int mask, int writePosition,
+                                     double delayInSamples, float gain, int channel)
+{
+    if (type == InterpolationType::none)
+    {
+        // same truncation as the original readDelayBuffer
+        auto readPosition = (writePosition - (int) delayInSamples) & mask;
+
+        const float weights[] = { gain };
+        addTaps<1> (destination, numSamples, delayData + readPosition, weights);
+        return;
+    }
+
+    // don't read samples that haven't been written yet
+    delayInSamples = juce::jmax (delayInSamples, (double) getLookahead (type));
+
+    // split the read position into a whole sample and a fraction in [0, 1).
+    // the whole part is floored before masking so the fraction keeps its sign right.
+    auto readPosition = (double) writePosition - delayInSamples;
+    auto whole = (int) std::floor (readPosition);
+    auto a = (float) (readPosition - whole);
+    auto index = whole & mask;
+
+    switch (type)
+    {
+        case InterpolationType::linear:
+        {
+            const float weights[] = { gain * (1.0f - a), gain * a };
+            addTaps<2> (destination, numSamples, delayData + index, weights);
+            break;
+        }
+
+        case InterpolationType::hermite:
+        case InterpolationType::lagrange:
+        {
+            float weights[4];
+            getCubicWeights (type, a, weights);
+
+            for (auto& w : weights)
+                w *= gain;
+
+            addTaps<4> (destination, numSamples, delayData + ((whole - 1) & mask), weights);
+            break;
+        }
+
+        case InterpolationType::allpass:
+            addAllpass (destination, numSamples, delayData, mask, index + 1, 1.0f - a, gain, channel);
+            break;
+
+        case InterpolationType::none:
+        default:
+            break;
+    }
+}
+
+void FractionalDelayReader::addFrom (float* destination, int numSamples,
+                                     const float* delayData, int mask, int writePosition,
+                                     const double* delaysInSamples, const float* gains, int channel)
+{
+    auto minimumDelay = (double) getLookahead (type);
+    auto state = allpassStates.getReference (channel);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto delay = type == InterpolationType::none ? std::floor (delaysInSamples[i])
+                                                     : juce::jmax (delaysInSamples[i], minimumDelay);
+
+        destination[i] += gains[i] * readSample (delayData, mask, (double) (writePosition + i) - delay, state);
+    }
+
+    allpassStates.getReference (channel) = state;
+}
+
+void FractionalDelayReader::processFeedback (float* samples, int numSamples, float* delayData, int mask, int writePosition,
+                                             double delayInSamples, float gain, const float* outputGains, float outputGain, int channel)
+{
+    auto* feedback = delayData + (writePosition & mask);
+
+    // the same weights as addFrom(), only with the write and the output gain folded into the pass
+    auto feed = [&] (auto numTaps, const float* source, const float* weights)
+    {
+        constexpr int n = decltype (numTaps)::value;
+
+        if (outputGains != nullptr)
+            feedTaps<n, true> (samples, feedback, numSamples, source, weights, outputGains, outputGain);
+        else
+            feedTaps<n, false> (samples, feedback, numSamples, source, weights, outputGains, outputGain);
+    };
+
+    delayInSamples = juce::jmax (delayInSamples, getMinimumFeedbackDelay (type));
+
+    if (type == InterpolationType::none)
+    {
+        auto readPosition = (writePosition - (int) delayInSamples) & mask;
+
+        const float weights[] = { gain };
+        feed (std::integral_constant<int, 1>(), delayData + readPosition, weights);
+        return;
+    }
+
+    auto readPosition = (double) writePosition - delayInSamples;
+    auto whole = (int) std::floor (readPosition);
+    auto a = (float) (readPosition - whole);
+
+    switch (type)
+    {
+        case InterpolationType::linear:
+        {
+            const float weights[] = { gain * (1.0f - a), gain * a };
+            feed (std::integral_constant<int, 2>(), delayData + (whole & mask), weights);
+            break;
+        }
+
+        case InterpolationType::hermite:
+        case InterpolationType::lagrange:
+        {
+            float weights[4];
+            getCubicWeights (type, a, weights);
+
+            for (auto& w : weights)
+                w *= gain;
+
+            feed (std::integral_constant<int, 4>(), delayData + ((whole - 1) & mask), weights);
+            break;
+        }
+
+        case InterpolationType::allpass:
+            feedAllpass (samples, feedback, numSamples, delayData, mask, (whole & mask) + 1, 1.0f - a, gain, outputGains, outputGain, channel);
+            break;
+
+        case InterpolationType::none:
+        default:
+            break;
+    }
+}
+
+void FractionalDelayReader::processFeedback (float* samples, int numSamples, float* delayData, int mask, int writePosition,
+                                             const double* delaysInSamples, const float* gains, const float* outputGains, float outputGain, int channel)
+{
+    auto* feedback = delayData + (writePosition & mask);
+    auto minimumDelay = getMinimumFeedbackDelay (type);
+    auto state = allpassStates.getReference (channel);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto delay = juce::jmax (delaysInSamples[i], minimumDelay);
+
+        if (type == InterpolationType::none)
+            delay = std::floor (delay);
+
+        auto sample = samples[i] + gains[i] * readSample (delayData, mask, (double) (writePosition + i) - delay, state);
+        feedback[i] = sample;
+        samples[i] = sample * (outputGains != nullptr ? outputGains[i] : outputGain);
+    }
+
+    allpassStates.getReference (channel) = state;
+}
+
+int FractionalDelayReader::getLongestRun (InterpolationType type, double shortestDelay)
+{
+    // the newest sample read for output i is floor (i - delay) + lookahead, it has to come before the first write
+    auto delay = juce::jmax (shortestDelay, getMinimumFeedbackDelay (type));
+    return juce::jmax (1, (int) std::floor (delay) - getLookahead (type));
+}
+
+float FractionalDelayReader::readSample (const float* delayData, int mask, double readPosition, float& allpassState) const
+{
+    auto whole = (int) std::floor (readPosition);
+    auto a = (float) (readPosition - whole);
+
+    // every tap is read from one contiguous span starting a sample before the read position
+    auto* taps = delayData + ((whole - 1) & mask);
+
+    switch (type)
+    {
+        case InterpolationType::none:
+            return taps[1];
+
+        case InterpolationType::linear:
+            return taps[1] + a * (taps[2] - taps[1]);
+
+        case InterpolationType::hermite:
+        case InterpolationType::lagrange:
+        {
+            float weights[4];
+            getCubicWeights (type, a, weights);
+
+            return weights[0] * taps[0] + weights[1] * taps[1] + weights[2] * taps[2] + weights[3] * taps[3];
+        }
+
+        case InterpolationType::allpass:
+        {
+            auto fraction = 1.0f - a;
+            auto newest = 2;
+
+            if (fraction < 0.618f)
+            {
+                fraction += 1.0f;
+                newest = 3;
+            }
+
+            auto eta = (1.0f - fraction) / (1.0f + fraction);
+            allpassState = eta * (taps[newest] - allpassState) + taps[newest - 1];
+            return allpassState;
+        }
+
+        default:
+            break;
+    }
+
+    return 0.0f;
+}
+
+void FractionalDelayReader::getCubicWeights (InterpolationType cubicType, float a, float* weights)
+{
+    if (cubicType == InterpolationType::hermite)
+    {
+        auto a2 = a * a;
+        auto a3 = a2 * a;
+
+        weights[0] = -0.5f * a3 + a2 - 0.5f * a;
+        weights[1] = 1.5f * a3 - 2.5f * a2 + 1.0f;
+        weights[2] = -1.5f * a3 + 2.0f * a2 + 0.5f * a;
+        weights[3] = 0.5f * a3 - 0.5f * a2;
+    }
+    else
+    {
+        weights[0] = -a * (a - 1.0f) * (a - 2.0f) / 6.0f;
+        weights[1] = (a + 1.0f) * (a - 1.0f) * (a - 2.0f) / 2.0f;
+        weights[2] = -(a + 1.0f) * a * (a - 2.0f) / 2.0f;
+        weights[3] = (a + 1.0f) * a * (a - 1.0f) / 6.0f;
+    }
+}
+
+void FractionalDelayReader::addAllpass (float* destination, int numSamples, const float* delayData, int mask, int newestIndex,
+                                        float fraction, float gain, int channel)
+{
+    // keep the fractional delay in [0.618, 1.618), where the filter's pole stays well inside the unit circle
+    if (fraction < 0.618f)
+    {
+        fraction += 1.0f;
+        ++newestIndex;
+    }
+
+    auto eta = (1.0f - fraction) / (1.0f + fraction);
+    auto* source = delayData + ((newestIndex - 1) & mask);
+    auto state = allpassStates.getReference (channel);
+
+    // recursive, so this one stays scalar
+    for (int i = 0; i < numSamples; ++i)
+    {
+        state = eta * (source[i + 1] - state) + source[i];
+        destination[i] += gain * state;
+    }
+
+    allpassStates.getReference (channel) = state;
+}
+
+void FractionalDelayReader::feedAllpass (float* samples, float* feedback, int numSamples, const float* delayData, int mask, int newestIndex,
+                                         float fraction, float gain, const float* outputGains, float outputGain, int channel)
+{
+    if (fraction < 0.618f)
+    {
+        fraction += 1.0f;
+        ++newestIndex;
+    }
+
+    auto eta = (1.0f - fraction) / (1.0f + fraction);
+    auto* source = delayData + ((newestIndex - 1) & mask);
+    auto state = allpassStates.getReference (channel);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        state = eta * (source[i + 1] - state) + source[i];
+
+        auto sample = samples[i] + gain * state;
+        feedback[i] = sample;
+        samples[i] = sample * (outputGains != nullptr ? outputGains[i] : outputGain);
+    }
+
+    allpassStates.getReference (channel) = state;
+}
+
+//==============================================================================
+void FractionalDelayReader::addFrom (float* const* destinations, int numChannels, int numSamples,
+                                     const float* const* delayData, int mask, int writePosition,
+                                     double delayInSamples, float gain)
+{
+    jassert (numChannels <= maxNumChannels);
+
+    if (type == InterpolationType::allpass && numChannels > 1)
+    {
+        processAllpassChannels<false> (destinations, numChannels, numSamples, delayData, nullptr, mask, writePosition,
+                                       juce::jmax (delayInSamples, (double) getLookahead (type)), gain, nullptr, 1.0f);
+        return;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        addFrom (destinations[channel], numSamples, delayData[channel], mask, writePosition, delayInSamples, gain, channel);
+}
+
+void FractionalDelayReader::addFrom (float* const* destinations, int numChannels, int numSamples,
+                                     const float* const* delayData, int mask, int writePosition,
+                                     const double* delaysInSamples, const float* gains)
+{
+    jassert (numChannels <= maxNumChannels);
+    processRampedChannels<false> (destinations, numChannels, numSamples, delayData, nullptr, mask, writePosition,
+                                  delaysInSamples, gains, nullptr, 1.0f);
+}
+
+void FractionalDelayReader::processFeedback (float* const* samples, int numChannels, int numSamples, float* const* delayData, int mask,
+                                             int writePosition, double delayInSamples, float gain, const float* outputGains, float outputGain)
+{
+    jassert (numChannels <= maxNumChannels);
+
+    if (type == InterpolationType::allpass && numChannels > 1)
+    {
+        processAllpassChannels<true> (samples, numChannels, numSamples, delayData, delayData, mask, writePosition,
+                                      juce::jmax (delayInSamples, getMinimumFeedbackDelay (type)), gain, outputGains, outputGain);
+        return;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        processFeedback (samples[channel], numSamples, delayData[channel], mask, writePosition, delayInSamples, gain,
+                         outputGains, outputGain, channel);
+}
+
+void FractionalDelayReader::processFeedback (float* const* samples, int numChannels, int numSamples, float* const* delayData, int mask,
+                                             int writePosition, const double* delaysInSamples, const float* gains,
+                                             const float* outputGains, float outputGain)
+{
+    jassert (numChannels <= maxNumChannels);
+    processRampedChannels<true> (samples, numChannels, numSamples, delayData, delayData, mask, writePosition,
+                                 delaysInSamples, gains, outputGains, outputGain);
+}
+
+template <bool feedback>
+void FractionalDelayReader::processRampedChannels (float* const* samples, int numChannels, int numSamples, const float* const* delayData,
+                                                   float* const* feedbackData, int mask, int writePosition, const double* delaysInSamples,
+                                                   const float* gains, const float* outputGains, float outputGain)
+{
+    auto minimumDelay = feedback ? getMinimumFeedbackDelay (type) : (double) getLookahead (type);
+    auto* states = allpassStates.getRawDataPointer();
+    auto writeIndex = writePosition & mask;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // the same read position as the single channel paths, worked out once for every channel
+        auto delay = feedback || type != InterpolationType::none ? juce::jmax (delaysInSamples[i], minimumDelay)
+                                                                   : delaysInSamples[i];
+
+        if (type == InterpolationType::none)
+            delay = std::floor (delay);
+
+        auto readPosition = (double) (writePosition + i) - delay;
+        auto whole = (int) std::floor (readPosition);
+        auto a = (float) (readPosition - whole);
+        auto tapIndex = (whole - 1) & mask;
+        auto gain = gains[i];
+        auto sampleOutputGain = feedback && outputGains != nullptr ? outputGains[i] : outputGain;
+
+        auto processFrame = [&] (auto&& read)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto echo = gain * read (delayData[channel] + tapIndex, channel);
+
+                if constexpr (feedback)
+                {
+                    auto sample = samples[channel][i] + echo;
+                    feedbackData[channel][writeIndex + i] = sample;
+                    samples[channel][i] = sample * sampleOutputGain;
+                }
+                else
+                {
+                    samples[channel][i] += echo;
+                }
+            }
+        };
+
+        switch (type)
+        {
+            case InterpolationType::none:
+                processFrame ([] (const float* taps, int) { return taps[1]; });
+                break;
+
+            case InterpolationType::linear:
+                processFrame ([a] (const float* taps, int) { return taps[1] + a * (taps[2] - taps[1]); });
+                break;
+
+            case InterpolationType::hermite:
+            case InterpolationType::lagrange:
+            {
+                float w[4];
+                getCubicWeights (type, a, w);
+                processFrame ([&w] (const float* taps, int) { return w[0] * taps[0] + w[1] * taps[1] + w[2] * taps[2] + w[3] * taps[3]; });
+                break;
+            }
+
+            case InterpolationType::allpass:
+            {
+                auto fraction = 1.0f - a;
+                auto newest = 2;
+
+                if (fraction < 0.618f)
+                {
+                    fraction += 1.0f;
+                    newest = 3;
+                }
+
+                auto eta = (1.0f - fraction) / (1.0f + fraction);
+
+                processFrame ([=] (const float* taps, int channel)
+                {
+                    states[channel] = eta * (taps[newest] - states[channel]) + taps[newest - 1];
+                    return states[channel];
+                });
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+template <bool feedback>
+void FractionalDelayReader::processAllpassChannels (float* const* samples, int numChannels, int numSamples, const float* const* delayData,
+                                                    float* const* feedbackData, int mask, int writePosition, double delayInSamples,
+                                                    float gain, const float* outputGains, float outputGain)
+{
+    auto readPosition = (double) writePosition - delayInSamples;
+    auto whole = (int) std::floor (readPosition);
+    auto fraction = 1.0f - (float) (readPosition - whole);
+    auto newestIndex = (whole & mask) + 1;
+
+    if (fraction < 0.618f)
+    {
+        fraction += 1.0f;
+        ++newestIndex;
+    }
+
+    auto eta = (1.0f - fraction) / (1.0f + fraction);
+    auto start = (newestIndex - 1) & mask;
+    auto writeIndex = writePosition & mask;
+    auto* states = allpassStates.getRawDataPointer();
+
+    // a group of channels per pass, each with its state in a register. every sample of one channel waits on the
+    // last, but the channels of a group don't wait on each other, so their recursions overlap.
+    auto processGroup = [&] (auto groupSize, int first)
+    {
+        constexpr int size = decltype (groupSize)::value;
+
+        const float* source[size];
+        float* output[size];
+        float* feedbackOutput[size];
+        float state[size];
+
+        for (int k = 0; k < size; ++k)
+        {
+            source[k] = delayData[first + k] + start;
+            output[k] = samples[first + k];
+            feedbackOutput[k] = feedback ? feedbackData[first + k] + writeIndex : nullptr;
+            state[k] = states[first + k];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sampleOutputGain = feedback && outputGains != nullptr ? outputGains[i] : outputGain;
+
+            for (int k = 0; k < size; ++k)
+            {
+                state[k] = eta * (source[k][i + 1] - state[k]) + source[k][i];
+                auto sample = output[k][i] + gain * state[k];
+
+                if constexpr (feedback)
+                {
+                    feedbackOutput[k][i] = sample;
+                    output[k][i] = sample * sampleOutputGain;
+                }
+                else
+                {
+                    output[k][i] = sample;
+                }
+            }
+        }
+
+        for (int k = 0; k < size; ++k)
+            states[first + k] = state[k];
+    };
+
+    int channel = 0;
+
+    for (; channel + 4 <= numChannels; channel += 4)
+        processGroup (std::integral_constant<int, 4>(), channel);
+
+    for (; channel + 2 <= numChannels; channel += 2)
+        processGroup (std::integral_constant<int, 2>(), channel);
+
+    if (channel < numChannels)
+        processGroup (std::integral_constant<int, 1>(), channel);
+}
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    FractionalDelayReader.h
+    Reads the delay ring at a fractional delay, with a choice of
+    interpolators.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// the order matches the choices of the INTERPOLATION parameter
+enum class InterpolationType
+{
+    none = 0,   // truncates to a whole sample, the original read path
+    linear,
+    hermite,    // 4-point, 3rd order (Catmull-Rom)
+    lagrange,   // 4-point, 3rd order
+    allpass     // 1st order Thiran, flat magnitude response but recursive
+};
+
+//==============================================================================
+/**
+    While the delay time is constant over a block the interpolation weights are
+    constant too, so every interpolator except the allpass boils down to a short
+    FIR over a contiguous run of the delay buffer. Those runs are written as
+    fixed-length loops that the compiler turns into SSE/AVX/NEON code, so a
+    4-tap read costs about the same number of memory passes as the old addFrom().
+
+    The delay data is a DelayRing channel: indices are wrapped with the mask,
+    and the mirrored tail means a block's read (plus the interpolator's
+    lookahead) never has to be split at the end.
+*/
+class FractionalDelayReader
+{
+public:
+    FractionalDelayReader() = default;
+
+    static juce::StringArray getTypeNames();
+
+    // the number of samples the interpolator reads ahead of (newer than) the read position
+    static int getLookahead (InterpolationType type);
+
+    void prepare (int numChannels);
+    void reset();
+
+    void setType (InterpolationType newType);
+    InterpolationType getType() const { return type; }
+
+    // the most samples any interpolator reads around the read position, on top of the block itself
+    static constexpr int maxReadSpan = 4;
+
+    // adds gain * the delay ring delayed by delayInSamples to destination. mask is the ring's getMask().
+    // output sample i lines up with delayData[writePosition + i], which must have been written already.
+    void addFrom (float* destination, int numSamples,
+                  const float* delayData, int mask, int writePosition,
+                  double delayInSamples, float gain, int channel);
+
+    // the same, but with a delay time and gain for every sample, for when either is ramping.
+    // the weights change every sample so this path is scalar.
+    void addFrom (float* destination, int numSamples,
+                  const float* delayData, int mask, int writePosition,
+                  const double* delaysInSamples, const float* gains, int channel);
+
+    // the whole plain delay line in one pass over the samples. each one becomes the input plus gain * the ring
+    // delayed by delayInSamples, which is written into the ring at writePosition as the feedback, and then scaled
+    // by the output gain (outputGains, or outputGain when that's nullptr) in place. delayData is the ring's write
+    // pointer, the caller commits the write. the reads mustn't reach this call's own writes, so numSamples is at
+    // most getLongestRun() for the shortest delay.
+    void processFeedback (float* samples, int numSamples, float* delayData, int mask, int writePosition,
+                          double delayInSamples, float gain, const float* outputGains, float outputGain, int channel);
+
+    // the same, but with a delay time and gain for every sample
+    void processFeedback (float* samples, int numSamples, float* delayData, int mask, int writePosition,
+                          const double* delaysInSamples, const float* gains, const float* outputGains, float outputGain, int channel);
+
+    // every channel at once, up to maxNumChannels. while the delay ramps, the read position and the weights are
+    // worked out once per sample for all of them, so each extra channel only costs its own taps. the allpass runs
+    // the channels side by side so their recursions overlap. the other interpolators are vectorised along the
+    // block already and just go channel by channel.
+    static constexpr int maxNumChannels = 16;
+
+    void addFrom (float* const* destinations, int numChannels, int numSamples,
+                  const float* const* delayData, int mask, int writePosition,
+                  double delayInSamples, float gain);
+
+    void addFrom (float* const* destinations, int numChannels, int numSamples,
+                  const float* const* delayData, int mask, int writePosition,
+                  const double* delaysInSamples, const float* gains);
+
+    void processFeedback (float* const* samples, int numChannels, int numSamples, float* const* delayData, int mask, int writePosition,
+                          double delayInSamples, float gain, const float* outputGains, float outputGain);
+
+    void processFeedback (float* const* samples, int numChannels, int numSamples, float* const* delayData, int mask, int writePosition,
+                          const double* delaysInSamples, const float* gains, const float* outputGains, float outputGain);
+
+    // processFeedback() doesn't go below this: the newest sample the interpolator reads has to be in the ring already
+    static double getMinimumFeedbackDelay (InterpolationType type) { return getLookahead (type) + 1.0; }
+
+    // the most samples processFeedback() can do in one call when no delay is shorter than shortestDelay
+    static int getLongestRun (InterpolationType type, double shortestDelay);
+
+    // fixed-weight fir over numSamples + numTaps - 1 contiguous samples from source
+    template <int numTaps>
+    static void addTaps (float* destination, int numSamples, const float* source, const float* weights);
+
+    // addTaps() into the input, then the sum written to feedback and scaled in place, all in the same pass
+    template <int numTaps, bool rampedOutput>
+    static void feedTaps (float* samples, float* feedback, int numSamples, const float* source, const float* weights,
+                          const float* outputGains, float outputGain);
+
+private:
+    // fills the 4 weights of the cubic interpolators for taps at -1, 0, 1, 2 around the read position
+    static void getCubicWeights (InterpolationType cubicType, float a, float* weights);
+
+    // one interpolated sample, for the paths where the delay moves every sample
+    float readSample (const float* delayData, int mask, double readPosition, float& allpassState) const;
+
+    void addAllpass (float* destination, int numSamples, const float* delayData, int mask, int newestIndex,
+                     float fraction, float gain, int channel);
+
+    void feedAllpass (float* samples, float* feedback, int numSamples, const float* delayData, int mask, int newestIndex,
+                      float fraction, float gain, const float* outputGains, float outputGain, int channel);
+
+    // the multichannel paths. with feedback, samples become the input plus the echo, which is also written to
+    // feedbackData at writePosition, then scaled by the output gain; without it the echo is added to samples.
+    template <bool feedback>
+    void processRampedChannels (float* const* samples, int numChannels, int numSamples, const float* const* delayData,
+                                float* const* feedbackData, int mask, int writePosition, const double* delaysInSamples,
+                                const float* gains, const float* outputGains, float outputGain);
+
+    template <bool feedback>
+    void processAllpassChannels (float* const* samples, int numChannels, int numSamples, const float* const* delayData,
+                                 float* const* feedbackData, int mask, int writePosition, double delayInSamples, float gain,
+                                 const float* outputGains, float outputGain);
+
+    InterpolationType type { InterpolationType::hermite };
+    juce::Array<float> allpassStates; // last allpass output, one per channel
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FractionalDelayReader)
+};
+
+//==============================================================================
+template <int numTaps>
+void FractionalDelayReader::addTaps (float* destination, int numSamples, const float* source, const float* weights)
+{
+    // local copy so the compiler knows the weights don't alias the output
+    float w[numTaps];
+
+    for (int k = 0; k < numTaps; ++k)
+        w[k] = weights[k];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float sum = 0.0f;
+
+        for (int k = 0; k < numTaps; ++k)
+            sum += w[k] * source[i + k];
+
+        destination[i] += sum;
+    }
+}
+
+template <int numTaps, bool rampedOutput>
+void FractionalDelayReader::feedTaps (float* samples, float* feedback, int numSamples, const float* source, const float* weights,
+                                      const float* outputGains, float outputGain)
+{
+    float w[numTaps];
+
+    for (int k = 0; k < numTaps; ++k)
+        w[k] = weights[k];
+
+    // source and feedback are the same ring, but the caller keeps the span read clear of the span written
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float sum = 0.0f;
+
+        for (int k = 0; k < numTaps; ++k)
+            sum += w[k] * source[i + k];
+
+        auto sample = samples[i] + sum;
+        feedback[i] = sample;
+        samples[i] = sample * (rampedOutput ? outputGains[i] : outputGain);
+    }
+}
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    GranularDelay.cpp
+
+  ==============================================================================
+*/
+
+#include "GranularDelay.h"
+
+//==============================================================================
+void GranularDelay::prepare (double newSampleRate, int numChannels, int newMaxBlockSize)
+{
+    sampleRate = newSampleRate;
+    preparedChannels = juce::jlimit (0, maxNumChannels, numChannels);
+    maxBlockSize = newMaxBlockSize;
+
+    pool.allocate ((size_t) (preparedChannels * maxGrainsPerChannel), true);
+    accumulators.setSize (preparedChannels, maxBlockSize);
+
+    // periodic, so windows half a grain apart add up to one
+    window.allocate ((size_t) windowSize + 1, true);
+
+    for (int i = 0; i <= windowSize; ++i)
+        window[i] = (float) (0.5 - 0.5 * std::cos (juce::MathConstants<double>::twoPi * i / windowSize));
+
+    reset();
+}
+
+void GranularDelay::reset()
+{
+    std::fill (numActive, numActive + maxNumChannels, 0);
+    samplesToNextGrain = 0.0;
+}
+
+void GranularDelay::setParameters (bool newReverse, double delayInSamples, double maxDelayInSamples,
+                                   float grainSizeMs, float grainsPerSecond, float pitchSemitones, float spray)
+{
+    reverse = newReverse;
+    centreDelay = delayInSamples;
+    maxDelay = maxDelayInSamples;
+
+    if (reverse)
+    {
+        // a reversed grain reads back twice its length by the time it ends, so it's at most half the ring.
+        // an even length puts the next grain exactly half way.
+        grainLength = juce::jmax (2, 2 * (int) (juce::jmin (delayInSamples, (maxDelay - minDelayInSamples) * 0.5) * 0.5));
+        rate = -1.0f;
+        spread = 0.0f;
+        spawnInterval = grainLength * 0.5;
+        grainGain = 1.0f;
+    }
+    else
+    {
+        grainLength = juce::jmax (2, juce::roundToInt (grainSizeMs * 0.001 * sampleRate));
+        rate = std::pow (2.0f, pitchSemitones / 12.0f);
+        spread = juce::jlimit (0.0f, 1.0f, spray) * (float) delayInSamples;
+        spawnInterval = sampleRate / juce::jmax (0.01f, grainsPerSecond);
+
+        // identical grains add up in step and scattered ones more like noise, so the level is brought back by the
+        // overlap for the first and its square root for the second, with spray deciding how far between the two.
+        // sparse grains aren't brought up.
+        auto overlap = juce::jmin ((double) maxGrainsPerChannel, grainLength / spawnInterval);
+        grainGain = overlap > 2.0 ? (float) std::pow (0.5 * overlap, 0.5 * juce::jlimit (0.0f, 1.0f, spray) - 1.0) : 1.0f;
+    }
+
+    // a shorter interval takes effect now rather than after the last, long one
+    samplesToNextGrain = juce::jmin (samplesToNextGrain, spawnInterval);
+}
+
+//==============================================================================
+void GranularDelay::process (float* const* outputs, const float* const* delayData, int numChannels, int numSamples,
+                             int mask, int writePosition, const float* wetGains, float wetGain)
+{
+    jassert (numSamples <= maxBlockSize);
+    numChannels = juce::jmin (numChannels, preparedChannels);
+    accumulators.clear();
+
+    // the grains already playing, a finished one swapped for the last so the active ones stay packed at the front
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* grains = pool + channel * maxGrainsPerChannel;
+        auto* accumulator = accumulators.getWritePointer (channel);
+
+        for (int g = 0; g < numActive[channel];)
+        {
+            if (render (grains[g], accumulator, delayData[channel], mask, writePosition, 0, numSamples))
+                ++g;
+            else
+                grains[g] = grains[--numActive[channel]];
+        }
+    }
+
+    // then whichever start during this block
+    while (samplesToNextGrain < numSamples)
+    {
+        spawn ((int) samplesToNextGrain, numSamples, numChannels, delayData, mask, writePosition);
+        samplesToNextGrain += spawnInterval;
+    }
+
+    samplesToNextGrain -= numSamples;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (wetGains != nullptr)
+            juce::FloatVectorOperations::addWithMultiply (outputs[channel], accumulators.getReadPointer (channel), wetGains, numSamples);
+        else
+            juce::FloatVectorOperations::addWithMultiply (outputs[channel], accumulators.getReadPointer (channel), wetGain, numSamples);
+    }
+}
+
+void GranularDelay::spawn (int start, int numSamples, int numChannels, const float* const* delayData, int mask, int writePosition)
+{
+    // a grain pitched up catches up with the write, one pitched down falls further behind, so where it can start
+    // depends on how far it travels
+    auto lowest = minDelayInSamples + juce::jmax (0.0, (rate - 1.0) * grainLength);
+    auto highest = maxDelay - juce::jmax (0.0, (1.0 - rate) * grainLength);
+
+    if (reverse)
+        highest = lowest;
+
+    if (lowest > highest)
+        return;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (numActive[channel] == maxGrainsPerChannel)
+            continue;
+
+        Grain grain;
+        grain.rate = rate;
+        grain.windowIncrement = (float) windowSize / (float) grainLength;
+        grain.gain = grainGain;
+        grain.samplesLeft = grainLength;
+        grain.interpolates = rate != 1.0f && rate != -1.0f;
+
+        auto delay = centreDelay + spread * (random.nextFloat() * 2.0f - 1.0f);
+        grain.delay = std::round (juce::jlimit (lowest, highest, delay));
+
+        auto& slot = pool[channel * maxGrainsPerChannel + numActive[channel]];
+        slot = grain;
+
+        if (render (slot, accumulators.getWritePointer (channel), delayData[channel], mask, writePosition, start, numSamples))
+            ++numActive[channel];
+    }
+}
+
+bool GranularDelay::render (Grain& grain, float* accumulator, const float* delayData, int mask, int writePosition,
+                            int start, int numSamples) const
+{
+    auto count = juce::jmin (grain.samplesLeft, numSamples - start);
+    auto* output = accumulator + start;
+    auto gain = grain.gain;
+    auto phase = grain.windowPhase;
+    auto increment = grain.windowIncrement;
+    const auto* table = window.getData();
+
+    if (! grain.interpolates)
+    {
+        // a whole sample at a time. the block's samples are one span whichever way they're read, the ring's mirrored
+        // tail covers the wrap.
+        auto first = writePosition + start - (int) grain.delay;
+
+        if (grain.rate > 0.0f)
+        {
+            auto* source = delayData + (first & mask);
+
+            for (int i = 0; i < count; ++i)
+                output[i] += gain * table[(int) (phase + increment * (float) i)] * source[i];
+        }
+        else
+        {
+            auto* source = delayData + ((first - count + 1) & mask) + count - 1;
+
+            for (int i = 0; i < count; ++i)
+                output[i] += gain * table[(int) (phase + increment * (float) i)] * source[-i];
+        }
+    }
+    else
+    {
+        // linear between the two samples either side. the whole sample the block starts from is split off once, so
+        // the loop only steps a small float offset from it, and the ring's mirrored tail covers the sample after the last.
+        auto first = (double) (writePosition + start) - grain.delay;
+        auto base = (int) std::floor (first);
+        auto offset = (float) (first - base);
+        auto rate = grain.rate;
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto position = offset + rate * (float) i;
+            auto whole = (int) position;
+            auto fraction = position - (float) whole;
+            auto index = (base + whole) & mask;
+
+            auto sample = delayData[index] + fraction * (delayData[index + 1] - delayData[index]);
+            output[i] += gain * table[(int) (phase + increment * (float) i)] * sample;
+        }
+    }
+
+    grain.delay += (1.0 - grain.rate) * count;
+    grain.windowPhase += increment * (float) count;
+    grain.samplesLeft -= count;
+
+    return grain.samplesLeft > 0;
+}
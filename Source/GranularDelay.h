@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    GranularDelay.h
+    Reverse and granular playback: short windowed grains read out of the
+    delay ring, backwards, scattered or pitched.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Every grain is a read head with its own rate and a Hann window, started
+    at some delay behind the write position and played for its length. New
+    grains start at a steady rate and every channel gets its own, spawned
+    together so a stereo pair stays in step unless spray pulls them apart.
+
+    - Reverse: grains as long as the delay time (or half the ring, whichever
+      is shorter) played backwards from the newest sample, two at a time, half
+      a grain apart. Hann windows at that overlap add up to exactly one, so
+      the reversed chunks follow each other with no dip or bump.
+    - Granular: grains of grainSize starting density times a second, read
+      around the delay time give or take spray of it, at rate 2^(pitch / 12).
+
+    Nothing is allocated once prepare() has run: the grains come out of a
+    fixed pool of maxGrainsPerChannel per channel (a spawn is skipped while
+    a channel's pool is full) and the window is a table filled there too.
+    Grains are kept as a delay behind the write position rather than an
+    index, so they carry on across a resized ring.
+
+    A grain's block is a loop with no dependency between samples. Grains
+    that play at the original speed or backwards start on a whole sample,
+    so they read the ring without interpolating.
+*/
+class GranularDelay
+{
+public:
+    static constexpr int maxGrainsPerChannel = 128;
+    static constexpr int maxNumChannels = 16;
+
+    GranularDelay() = default;
+
+    // the grain pool and the window table, and the scratch for maxBlockSize samples
+    void prepare (double sampleRate, int numChannels, int maxBlockSize);
+
+    // stops every grain
+    void reset();
+
+    // audio thread, before each process(). maxDelayInSamples is as far back as the ring can be read.
+    void setParameters (bool reverse, double delayInSamples, double maxDelayInSamples,
+                        float grainSizeMs, float grainsPerSecond, float pitchSemitones, float spray);
+
+    // adds wetGain (or the wetGains ramp, if not nullptr) times the grains to each output. the block must already
+    // be in the ring at writePosition, the newest grains read from it.
+    void process (float* const* outputs, const float* const* delayData, int numChannels, int numSamples,
+                  int mask, int writePosition, const float* wetGains, float wetGain);
+
+    int getNumActiveGrains (int channel) const { return numActive[channel]; }
+
+private:
+    static constexpr int windowSize = 4096;
+    static constexpr double minDelayInSamples = 2.0; // keeps the interpolated read behind the newest sample
+
+    struct Grain
+    {
+        double delay {0.0};         // behind the write position, at the next sample to play
+        float rate {1.0f};          // samples read per sample played, negative backwards
+        float windowPhase {0.0f};   // into the window table
+        float windowIncrement {0.0f};
+        float gain {1.0f};
+        int samplesLeft {0};
+        bool interpolates {true};
+    };
+
+    // starts a grain on every channel at sample start of the block, each played up to numSamples
+    void spawn (int start, int numSamples, int numChannels, const float* const* delayData, int mask, int writePosition);
+
+    // plays a grain into the accumulator from sample start, for up to numSamples - start samples.
+    // returns false once it has finished.
+    bool render (Grain& grain, float* accumulator, const float* delayData, int mask, int writePosition,
+                 int start, int numSamples) const;
+
+    double sampleRate {44100.0};
+    int preparedChannels {0};
+    int maxBlockSize {0};
+
+    // the grains of each channel are the first numActive[channel] of its stretch of the pool
+    juce::HeapBlock<Grain> pool;
+    int numActive[maxNumChannels] {};
+
+    juce::HeapBlock<float> window; // windowSize + 1 samples of a periodic Hann window, the last one wrapping round to 0
+    juce::AudioBuffer<float> accumulators;
+
+    // the next grain's settings, from setParameters()
+    bool reverse {false};
+    double centreDelay {0.0};
+    double maxDelay {0.0};
+    int grainLength {1};
+    float rate {1.0f};
+    float spread {0.0f}; // spray in samples either side of the delay
+    float grainGain {1.0f};
+    double spawnInterval {1.0};
+
+    double samplesToNextGrain {0.0};
+    juce::Random random;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GranularDelay)
+};
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    ImpulseLoader.cpp
+
+  ==============================================================================
+*/
+
+#include "ImpulseLoader.h"
+
+//==============================================================================
+ImpulseLoader::ImpulseLoader()
+    : juce::Thread ("Impulse loader")
+{
+    formatManager.registerBasicFormats();
+}
+
+ImpulseLoader::~ImpulseLoader()
+{
+    stop();
+}
+
+void ImpulseLoader::prepare (double newSampleRate, int newNumChannels)
+{
+    stop();
+
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    {
+        const juce::ScopedLock sl (fileLock);
+        loadPending = file != juce::File();
+        loading = loadPending;
+    }
+
+    startThread();
+}
+
+void ImpulseLoader::stop()
+{
+    stopThread (4000);
+
+    delete ready.exchange (nullptr);
+    delete retired.exchange (nullptr);
+    active.reset();
+}
+
+void ImpulseLoader::load (const juce::File& newFile)
+{
+    const juce::ScopedLock sl (fileLock);
+    file = newFile;
+    loadPending = true;
+    loading = true;
+}
+
+juce::File ImpulseLoader::getFile() const
+{
+    const juce::ScopedLock sl (fileLock);
+    return file;
+}
+
+bool ImpulseLoader::swapIfReady()
+{
+    auto* newConvolver = ready.load (std::memory_order_acquire);
+
+    // the background thread frees the last one before it builds another, so retired is empty here
+    if (newConvolver == nullptr || retired.load (std::memory_order_acquire) != nullptr)
+        return false;
+
+    ready.store (nullptr, std::memory_order_relaxed);
+    retired.store (active.release(), std::memory_order_release);
+    active.reset (newConvolver);
+    return true;
+}
+
+void ImpulseLoader::run()
+{
+    while (! threadShouldExit())
+    {
+        reclaim();
+
+        if (ready.load (std::memory_order_acquire) == nullptr && retired.load (std::memory_order_acquire) == nullptr)
+        {
+            juce::File fileToLoad;
+
+            {
+                const juce::ScopedLock sl (fileLock);
+
+                if (loadPending)
+                    fileToLoad = file;
+
+                loadPending = false;
+            }
+
+            if (fileToLoad != juce::File())
+            {
+                build (fileToLoad);
+                
+                const juce::ScopedLock sl (fileLock);
+                
+                if (! loadPending)
+                    loading = false;
+            }
+        }
+
+        if (onReady != nullptr && ! readyAnnounced && ready.load (std::memory_order_acquire) != nullptr)
+            readyAnnounced = onReady();
+
+        wait (pollIntervalMs);
+    }
+}
+
+void ImpulseLoader::build (const juce::File& fileToLoad)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (fileToLoad));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+    {
+        DBG ("couldn't read an impulse response from " << fileToLoad.getFullPathName());
+        return;
+    }
+
+    auto numFileChannels = juce::jlimit (1, juce::jmax (1, numChannels), (int) reader->numChannels);
+    auto numFileSamples = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (maxImpulseSeconds * reader->sampleRate));
+
+    juce::AudioBuffer<float> fileSamples (numFileChannels, numFileSamples);
+    reader->read (&fileSamples, 0, numFileSamples, 0, true, numFileChannels > 1);
+
+    // at the processor's rate, or the echoes would come out pitched and stretched
+    auto speedRatio = reader->sampleRate / sampleRate;
+    auto numSamples = juce::jmax (1, (int) (numFileSamples / speedRatio));
+    juce::AudioBuffer<float> impulse (numFileChannels, numSamples);
+
+    for (int channel = 0; channel < numFileChannels; ++channel)
+    {
+        if (speedRatio == 1.0)
+        {
+            impulse.copyFrom (channel, 0, fileSamples, channel, 0, numSamples);
+        }
+        else
+        {
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process (speedRatio, fileSamples.getReadPointer (channel), impulse.getWritePointer (channel), numSamples,
+                                  numFileSamples, 0);
+        }
+    }
+
+    // unit energy in the loudest channel, so swapping files doesn't jump the level or run the feedback away
+    double energy = 0.0;
+
+    for (int channel = 0; channel < numFileChannels; ++channel)
+    {
+        double channelEnergy = 0.0;
+        auto* samples = impulse.getReadPointer (channel);
+
+        for (int i = 0; i < numSamples; ++i)
+            channelEnergy += (double) samples[i] * samples[i];
+
+        energy = juce::jmax (energy, channelEnergy);
+    }
+
+    if (energy > 0.0)
+        impulse.applyGain ((float) (1.0 / std::sqrt (energy)));
+
+    auto convolver = std::make_unique<PartitionedConvolver>();
+    convolver->prepare (impulse, numChannels, partitionSize);
+
+    readyAnnounced = false;
+    ready.store (convolver.release(), std::memory_order_release);
+}
+
+void ImpulseLoader::reclaim()
+{
+    // a long impulse response is megabytes of spectra, give them back off the audio thread
+    delete retired.exchange (nullptr, std::memory_order_acq_rel);
+}
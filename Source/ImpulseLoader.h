@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    ImpulseLoader.h
+    Reads, resamples and transforms impulse responses on a background thread
+    and hands the finished convolver to the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+/**
+    The message thread names a file with load(). The background thread reads
+    it, resamples it to the processor's rate, normalises it to unit energy and
+    builds a PartitionedConvolver around it, with every partition already
+    transformed. That's published through an atomic pointer and announced
+    through onReady. The audio thread then calls swapIfReady(), which only
+    exchanges pointers: the convolver it was using goes back through a
+    second atomic pointer for the background thread to free. As with the
+    delay ring resizer, only one convolver is ever in flight each way.
+*/
+class ImpulseLoader : private juce::Thread
+{
+public:
+    ImpulseLoader();
+    ~ImpulseLoader() override;
+
+    static constexpr int partitionSize = 256;       // also the length of the directly convolved head
+    static constexpr double maxImpulseSeconds = 10.0;
+
+    // message thread, while the audio thread isn't running. the current file is loaded again at the new rate.
+    void prepare (double sampleRate, int numChannels);
+    void stop(); // also frees every convolver, including the active one
+
+    // message thread
+    void load (const juce::File& file);
+    juce::File getFile() const;
+    
+    // any thread. true from load() until the convolver is ready to swap in, or the file turned out unreadable.
+    bool isLoading() const noexcept { return loading.load(); }
+
+    // background thread, once a convolver is ready to swap. returning false means the message didn't get
+    // through, it's tried again on the next poll. set it before prepare().
+    std::function<bool()> onReady;
+
+    // audio thread. returns true if a new convolver was swapped in.
+    bool swapIfReady();
+
+    // audio thread. nullptr until the first impulse response has loaded.
+    PartitionedConvolver* getActive() const noexcept { return active.get(); }
+
+private:
+    void run() override;
+    void build (const juce::File& file);
+    void reclaim();
+
+    static constexpr int pollIntervalMs = 50;
+
+    juce::AudioFormatManager formatManager;
+    double sampleRate {0.0};
+    int numChannels {0};
+
+    juce::CriticalSection fileLock; // between the message thread and the background thread only
+    juce::File file;
+    bool loadPending {false};
+    std::atomic<bool> loading {false};
+
+    std::unique_ptr<PartitionedConvolver> active;           // the audio thread's
+    std::atomic<PartitionedConvolver*> ready {nullptr};     // built, waiting for the audio thread
+    std::atomic<PartitionedConvolver*> retired {nullptr};   // swapped out, waiting for the background thread to free it
+    bool readyAnnounced {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImpulseLoader)
+};
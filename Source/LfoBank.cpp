@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    LfoBank.cpp
+
+  ==============================================================================
+*/
+
+#include "LfoBank.h"
+
+using Vec = juce::dsp::SIMDRegister<float>;
+
+//==============================================================================
+juce::StringArray LfoBank::getShapeNames()
+{
+    return { "Sine", "Triangle", "Random" };
+}
+
+void LfoBank::prepare (double newSampleRate, int maxNumOscillators, int maxBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    // whole registers, the sine steps the spare lanes of the last one along with the rest
+    auto vecSize = (int) Vec::size();
+    auto maxRows = (juce::jmax (1, maxNumOscillators) + vecSize - 1) / vecSize * vecSize;
+
+    phases.allocate ((size_t) maxRows, true);
+    randomStarts.allocate ((size_t) maxRows, true);
+    randomTargets.allocate ((size_t) maxRows, true);
+    outputs.setSize (maxRows, maxBlockSize);
+    outputs.clear();
+
+    // the sine loads and stores whole registers of its states, which fromRawArray() needs aligned. malloc only promises 16 bytes.
+    sineMemory.allocate ((size_t) maxRows * 2 * sizeof (float) + 64, true);
+    sineStates = juce::snapPointerToAlignment (reinterpret_cast<float*> (sineMemory.getData()), (size_t) 64);
+
+    numOscillators = 0;
+    numRows = 0;
+    sineSeeded = false;
+}
+
+void LfoBank::setParameters (Shape newShape, float rateHz)
+{
+    if (newShape != shape)
+    {
+        shape = newShape;
+        sineSeeded = false;
+    }
+
+    auto cyclesPerSample = juce::jlimit (0.0, 0.5, (double) rateHz / sampleRate);
+    auto newIncrement = juce::jmax ((juce::uint32) 1, (juce::uint32) (cyclesPerSample * 4294967296.0));
+
+    if (newIncrement != increment)
+    {
+        increment = newIncrement;
+
+        // the same angle the accumulator steps by, worked out in double so the two don't drift apart
+        auto angle = juce::MathConstants<double>::twoPi * increment / 4294967296.0;
+        rotationCos = (float) std::cos (angle);
+        rotationSin = (float) std::sin (angle);
+    }
+}
+
+void LfoBank::setPhases (const float* newPhases, int newNumOscillators)
+{
+    auto vecSize = (int) Vec::size();
+    numOscillators = juce::jlimit (0, outputs.getNumChannels(), newNumOscillators);
+    numRows = (numOscillators + vecSize - 1) / vecSize * vecSize;
+
+    for (int osc = 0; osc < numRows; ++osc)
+    {
+        auto phase = osc < numOscillators ? newPhases[osc] - std::floor (newPhases[osc]) : 0.0f;
+        phases[osc] = (juce::uint32) ((double) phase * 4294967296.0);
+
+        // the glide starts somewhere different for every oscillator
+        randomStarts[osc] = random.nextFloat() * 2.0f - 1.0f;
+        randomTargets[osc] = random.nextFloat() * 2.0f - 1.0f;
+    }
+
+    sineSeeded = false;
+}
+
+void LfoBank::process (int numSamples)
+{
+    jassert (numSamples <= outputs.getNumSamples());
+
+    switch (shape)
+    {
+        case Shape::sine:       processSine (numSamples); break;
+        case Shape::triangle:   processTriangle (numSamples); break;
+        case Shape::random:     processRandom (numSamples); break;
+    }
+
+    // the accumulator keeps going whatever the shape, the sine follows it at the next seed
+    for (int osc = 0; osc < numRows; ++osc)
+        phases[osc] += increment * (juce::uint32) numSamples;
+}
+
+//==============================================================================
+void LfoBank::seedSine()
+{
+    for (int osc = 0; osc < numRows; ++osc)
+    {
+        auto angle = juce::MathConstants<double>::twoPi * phases[osc] / 4294967296.0;
+        sineStates[osc] = (float) std::cos (angle);
+        sineStates[numRows + osc] = (float) std::sin (angle);
+    }
+
+    sineSeeded = true;
+}
+
+void LfoBank::processSine (int numSamples)
+{
+    if (! sineSeeded)
+        seedSine();
+
+    auto vecSize = (int) Vec::size();
+    auto c = Vec::expand (rotationCos);
+    auto s = Vec::expand (rotationSin);
+    alignas (64) float lanes[16];
+    float* rows[16];
+
+    for (int first = 0; first < numRows; first += vecSize)
+    {
+        for (int lane = 0; lane < vecSize; ++lane)
+            rows[lane] = outputs.getWritePointer (first + lane);
+
+        auto x = Vec::fromRawArray (sineStates + first);
+        auto y = Vec::fromRawArray (sineStates + numRows + first);
+
+        // one register of oscillators at a time: a rotation per sample, the sin lane written out to each one's row
+        for (int i = 0; i < numSamples; ++i)
+        {
+            y.copyToRawArray (lanes);
+
+            for (int lane = 0; lane < vecSize; ++lane)
+                rows[lane][i] = lanes[lane];
+
+            auto rotatedX = x * c - y * s;
+            y = x * s + y * c;
+            x = rotatedX;
+        }
+
+        // the rotation isn't exactly unit length in float, one newton step for 1 / |(x, y)| puts the amplitude back
+        auto correction = Vec::expand (1.5f) - (x * x + y * y) * 0.5f;
+        (x * correction).copyToRawArray (sineStates + first);
+        (y * correction).copyToRawArray (sineStates + numRows + first);
+    }
+}
+
+void LfoBank::processTriangle (int numSamples)
+{
+    // a quarter cycle ahead, so it rises through zero at phase 0 like the sine
+    constexpr juce::uint32 quarterCycle = 0x40000000u;
+    constexpr float scale = 2.0f / 2147483648.0f;
+
+    for (int osc = 0; osc < numOscillators; ++osc)
+    {
+        auto* output = outputs.getWritePointer (osc);
+        auto start = phases[osc] + quarterCycle;
+        auto step = increment;
+
+        // the shifted phase as a signed saw from -1 to 1, folded into a triangle
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto saw = (float) (juce::int32) (start + (juce::uint32) i * step);
+            output[i] = std::abs (saw) * scale - 1.0f;
+        }
+    }
+}
+
+void LfoBank::processRandom (int numSamples)
+{
+    constexpr float scale = 1.0f / 4294967296.0f;
+
+    for (int osc = 0; osc < numOscillators; ++osc)
+    {
+        auto* output = outputs.getWritePointer (osc);
+        auto phase = phases[osc];
+
+        // a run of samples up to the next wrap is one glide, then the target moves on
+        for (int i = 0; i < numSamples;)
+        {
+            auto samplesToWrap = ((((juce::uint64) 1) << 32) - phase + increment - 1) / increment;
+            auto runLength = (int) juce::jmin ((juce::uint64) (numSamples - i), samplesToWrap);
+            auto from = randomStarts[osc];
+            auto range = randomTargets[osc] - from;
+
+            for (int k = 0; k < runLength; ++k)
+            {
+                auto t = (float) (phase + (juce::uint32) k * increment) * scale;
+                output[i + k] = from + range * t * t * (3.0f - 2.0f * t);
+            }
+
+            phase += increment * (juce::uint32) runLength;
+            i += runLength;
+
+            if ((juce::uint64) runLength == samplesToWrap)
+            {
+                randomStarts[osc] = randomTargets[osc];
+                randomTargets[osc] = random.nextFloat() * 2.0f - 1.0f;
+            }
+        }
+    }
+}
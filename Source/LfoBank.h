@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    LfoBank.h
+    A bank of low frequency oscillators running side by side, a block at a
+    time, for the modulated delay.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Every oscillator runs at the same rate from its own phase. process()
+    fills a block of each one, -1 to 1, without calling std::sin per sample:
+
+    - the sine is a recursive quadrature oscillator, a rotation of a (cos,
+      sin) pair by the same angle every sample. The oscillators are stepped
+      a SIMD register at a time, and their amplitude is pulled back to 1
+      once per block so the recursion's rounding can't build up.
+    - the triangle and the smoothed random run off a 32-bit integer phase
+      accumulator that wraps by itself once per cycle, so each oscillator's
+      block is a loop with no dependency between samples that the compiler
+      vectorises. The random one glides from one random value to the next
+      once per cycle, with a smoothstep so the slope has no corners.
+
+    The phase accumulator always runs, so switching shapes carries on from
+    the same point in the cycle.
+*/
+class LfoBank
+{
+public:
+    // the order matches the choices of the MOD_SHAPE parameter
+    enum class Shape
+    {
+        sine = 0,
+        triangle,
+        random      // a new random value every cycle, glided to
+    };
+
+    LfoBank() = default;
+
+    static juce::StringArray getShapeNames();
+
+    // allocates room for up to maxNumOscillators running maxBlockSize samples at a time
+    void prepare (double sampleRate, int maxNumOscillators, int maxBlockSize);
+
+    // audio thread, once per block
+    void setParameters (Shape newShape, float rateHz);
+
+    // restarts numOscillators from phases, in cycles (0 to 1)
+    void setPhases (const float* phases, int numOscillators);
+
+    // fills the next numSamples (at most maxBlockSize) of every oscillator
+    void process (int numSamples);
+
+    const float* getOutput (int oscillator) const { return outputs.getReadPointer (oscillator); }
+    int getNumOscillators() const { return numOscillators; }
+
+private:
+    void processSine (int numSamples);
+    void processTriangle (int numSamples);
+    void processRandom (int numSamples);
+
+    // the quadrature pair from the phase accumulator, when the sine starts or restarts
+    void seedSine();
+
+    double sampleRate {44100.0};
+    Shape shape {Shape::sine};
+    int numOscillators {0};
+    int numRows {0};    // numOscillators rounded up to a whole SIMD register
+
+    juce::uint32 increment {0};          // phase per sample, a whole cycle is 2^32
+    juce::HeapBlock<juce::uint32> phases;
+
+    // the sine's state, rotated by (rotationCos, rotationSin) every sample
+    juce::HeapBlock<char> sineMemory;
+    float* sineStates {nullptr}; // 64-byte aligned view into sineMemory: cos of every oscillator, then sin of every oscillator
+    float rotationCos {1.0f}, rotationSin {0.0f};
+    bool sineSeeded {false};
+
+    // the random shape glides from the start to the target over each cycle
+    juce::HeapBlock<float> randomStarts, randomTargets;
+    juce::Random random;
+
+    juce::AudioBuffer<float> outputs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LfoBank)
+};
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    Looper.cpp
+
+  ==============================================================================
+*/
+
+#include "Looper.h"
+
+//==============================================================================
+void Looper::prepare (double sampleRate, int maxBlockSize)
+{
+    crossfadeLength = juce::jmax (1, (int) (crossfadeSeconds * sampleRate));
+    scratch.setSize (2, maxBlockSize);
+}
+
+void Looper::freeze (const DelayRing& ring, juce::int64 position, int lengthInSamples, int endOffsetInSamples)
+{
+    // the region and its pre-roll have to fit in what the ring holds, keeping clear of the guard
+    auto available = ring.getNumSamples() - ring.getGuardSize();
+
+    regionLength = juce::jlimit (juce::jmin (2, available), juce::jmax (2, available - crossfadeLength), lengthInSamples);
+    fadeLength = juce::jmin (crossfadeLength, regionLength / 2);
+
+    auto endOffset = juce::jlimit (0, juce::jmax (0, available - fadeLength - regionLength), endOffsetInSamples);
+
+    frozenAt = position;
+    regionStart = position - endOffset - regionLength;
+    phase = 0;
+    frozen = regionLength > 0;
+}
+
+bool Looper::fits (const DelayRing& ring) const
+{
+    // nothing after the freeze point matters, that's what the ring has to reach back from
+    return frozenAt - (regionStart - fadeLength) <= (juce::int64) (ring.getNumSamples() - ring.getGuardSize());
+}
+
+Looper::State Looper::getState() const
+{
+    return { frozen, frozenAt, frozenAt - regionStart, regionLength, fadeLength, phase };
+}
+
+void Looper::restore (const State& state, juce::int64 newFrozenAt)
+{
+    frozen = state.frozen && state.regionLength > 0;
+    frozenAt = newFrozenAt;
+    regionStart = newFrozenAt - state.regionOffset;
+    regionLength = state.regionLength;
+    fadeLength = juce::jlimit (0, regionLength / 2, state.fadeLength);
+    phase = regionLength > 0 ? juce::jlimit (0, regionLength - 1, state.phase) : 0;
+}
+
+void Looper::publishState()
+{
+    publishedSequence.fetch_add (1);
+
+    publishedFrozen.store (frozen, std::memory_order_relaxed);
+    publishedFrozenAt.store (frozenAt, std::memory_order_relaxed);
+    publishedRegionOffset.store (frozenAt - regionStart, std::memory_order_relaxed);
+    publishedRegionLength.store (regionLength, std::memory_order_relaxed);
+    publishedFadeLength.store (fadeLength, std::memory_order_relaxed);
+    publishedPhase.store (phase, std::memory_order_relaxed);
+
+    publishedSequence.fetch_add (1);
+}
+
+Looper::State Looper::getPublishedState() const
+{
+    for (;;)
+    {
+        auto before = publishedSequence.load();
+
+        if ((before & 1) == 0)
+        {
+            State state { publishedFrozen.load (std::memory_order_relaxed), publishedFrozenAt.load (std::memory_order_relaxed),
+                          publishedRegionOffset.load (std::memory_order_relaxed), publishedRegionLength.load (std::memory_order_relaxed),
+                          publishedFadeLength.load (std::memory_order_relaxed), publishedPhase.load (std::memory_order_relaxed) };
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            if (publishedSequence.load (std::memory_order_relaxed) == before)
+                return state;
+        }
+
+        juce::Thread::yield();
+    }
+}
+
+void Looper::process (DelayRing& ring, float* const* channels, int numChannels, int numSamples,
+                      const float* gains, float gain, bool overdub, float decay)
+{
+    jassert (frozen && numSamples <= scratch.getNumSamples() && numSamples <= ring.getGuardSize());
+
+    auto mask = ring.getMask();
+    auto* loop = scratch.getWritePointer (0);
+    auto* layered = scratch.getWritePointer (1);
+
+    // in pieces that stop at the crossfade and at the wrap, so each one is a contiguous span of the ring
+    for (int start = 0; start < numSamples;)
+    {
+        auto fadeStart = regionLength - fadeLength;
+        auto inFade = phase >= fadeStart;
+        auto numThisTime = juce::jmin (numSamples - start, (inFade ? regionLength : fadeStart) - phase);
+
+        auto regionIndex = (int) ((regionStart + phase) & mask);
+        auto preRollIndex = (int) ((regionStart + phase - regionLength) & mask);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* samples = channels[channel] + start;
+            auto* region = ring.getReadPointer (channel) + regionIndex;
+            auto* preRoll = ring.getReadPointer (channel) + preRollIndex;
+
+            if (inFade)
+            {
+                // linear, the two sides are the same continuous recording
+                for (int i = 0; i < numThisTime; ++i)
+                {
+                    auto fade = (float) (phase + i - fadeStart + 1) / (float) (fadeLength + 1);
+                    loop[i] = region[i] + fade * (preRoll[i] - region[i]);
+                }
+            }
+            else
+            {
+                juce::FloatVectorOperations::copy (loop, region, numThisTime);
+            }
+
+            // layered before the loop is added, so it's the input that goes in and not the loop again
+            if (overdub)
+            {
+                juce::FloatVectorOperations::copy (layered, samples, numThisTime);
+                juce::FloatVectorOperations::addWithMultiply (layered, region, decay, numThisTime);
+                ring.write (channel, regionIndex, layered, numThisTime);
+
+                if (inFade)
+                {
+                    juce::FloatVectorOperations::copy (layered, samples, numThisTime);
+                    juce::FloatVectorOperations::addWithMultiply (layered, preRoll, decay, numThisTime);
+                    ring.write (channel, preRollIndex, layered, numThisTime);
+                }
+            }
+
+            if (gains != nullptr)
+                juce::FloatVectorOperations::addWithMultiply (samples, loop, gains + start, numThisTime);
+            else
+                juce::FloatVectorOperations::addWithMultiply (samples, loop, gain, numThisTime);
+        }
+
+        phase += numThisTime;
+        start += numThisTime;
+
+        if (phase == regionLength)
+            phase = 0;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    Looper.h
+    Freeze: holds a region of the delay ring and loops it, with crossfaded
+    loop points and optional overdub.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayRing.h"
+
+//==============================================================================
+/**
+    While frozen nothing writes to the ring and nothing is fed back: the
+    looper plays a region of the history that was there when it froze. The
+    region ends endOffset samples before the freeze point and is addressed in
+    absolute positions, like the rest of the ring, so it stays put while the
+    processor's sample clock carries on.
+
+    Over the last crossfadeSeconds of each pass the region fades into the
+    samples just before its own start. Those lead straight into the start,
+    so the wrap has no click and no gap. Overdubbing adds the input into the
+    region as it plays, and the pre-roll under the crossfade, after scaling
+    what was there by the decay, so older layers fade away pass by pass.
+*/
+class Looper
+{
+public:
+    Looper() = default;
+
+    static constexpr double crossfadeSeconds = 0.01;
+
+    void prepare (double sampleRate, int maxBlockSize);
+
+    // audio thread. the region is shortened and moved if it doesn't fit in the ring with its pre-roll.
+    void freeze (const DelayRing& ring, juce::int64 position, int lengthInSamples, int endOffsetInSamples);
+    void release() { frozen = false; }
+
+    bool isFrozen() const { return frozen; }
+    juce::int64 getFrozenAt() const { return frozenAt; }
+
+    // false if the ring no longer holds all of the region (it was made smaller)
+    bool fits (const DelayRing& ring) const;
+
+    /** Where the loop is, with the region relative to the freeze point so it can be put back anywhere. */
+    struct State
+    {
+        bool frozen {false};
+        juce::int64 frozenAt {0};
+        juce::int64 regionOffset {0}; // frozenAt minus the first sample of the loop
+        int regionLength {0};
+        int fadeLength {0};
+        int phase {0};
+    };
+
+    // audio thread
+    State getState() const;
+    void restore (const State& state, juce::int64 newFrozenAt);
+
+    // the audio thread publishes the state after each block, any other thread can read it
+    void publishState();
+    State getPublishedState() const;
+
+    // adds the loop to each channel, times the gain ramp (or gain when that's nullptr). with overdub, the
+    // channels' contents are layered into the region first.
+    void process (DelayRing& ring, float* const* channels, int numChannels, int numSamples,
+                  const float* gains, float gain, bool overdub, float decay);
+
+private:
+    juce::AudioBuffer<float> scratch; // the loop's output, then the overdubbed region
+    int crossfadeLength {0};
+
+    bool frozen {false};
+    juce::int64 frozenAt {0};
+    juce::int64 regionStart {0}; // absolute position of the first sample of the loop
+    int regionLength {0};
+    int fadeLength {0};          // the crossfade, no longer than half the region
+    int phase {0};               // of the next sample to play, from regionStart
+
+    // publishState()'s copy, a sequence lock: the count is odd while the fields are being written
+    std::atomic<juce::uint32> publishedSequence {0};
+    std::atomic<bool> publishedFrozen {false};
+    std::atomic<juce::int64> publishedFrozenAt {0}, publishedRegionOffset {0};
+    std::atomic<int> publishedRegionLength {0}, publishedFadeLength {0}, publishedPhase {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Looper)
+};
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    ModulatedDelay.cpp
+
+  ==============================================================================
+*/
+
+#include "ModulatedDelay.h"
+
+namespace
+{
+    // how far either side of the delay time a voice swings at full depth
+    double getMaxSwingSeconds (ModulatedDelay::Mode mode)
+    {
+        switch (mode)
+        {
+            case ModulatedDelay::Mode::chorus:  return 0.005;
+            case ModulatedDelay::Mode::flanger: return 0.002;
+            case ModulatedDelay::Mode::wow:     return 0.003;
+            case ModulatedDelay::Mode::off:
+            default:                            break;
+        }
+
+        return 0.0;
+    }
+}
+
+//==============================================================================
+juce::StringArray ModulatedDelay::getModeNames()
+{
+    return { "Off", "Chorus", "Flanger", "Wow" };
+}
+
+void ModulatedDelay::prepare (double newSampleRate, int newNumChannels, int newMaxBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = newMaxBlockSize;
+    preparedChannels = newNumChannels;
+    numChannels = juce::jmin (numChannels, preparedChannels);
+
+    lfos.prepare (sampleRate, preparedChannels * maxNumVoices, maxBlockSize);
+    reader.prepare (preparedChannels * maxNumVoices);
+
+    voiceDelays.allocate ((size_t) (preparedChannels * maxBlockSize), true);
+    voiceGains.allocate ((size_t) (preparedChannels * maxBlockSize), true);
+
+    restartOscillators();
+}
+
+void ModulatedDelay::setParameters (Mode newMode, LfoBank::Shape shape, float rateHz, float depth, int voices,
+                                    InterpolationType type, int newNumChannels)
+{
+    auto newNumVoices = newMode == Mode::chorus ? juce::jlimit (1, maxNumVoices, voices) : 1;
+    newNumChannels = juce::jmin (newNumChannels, preparedChannels);
+
+    // the voices only start over when there's a different set of them
+    if (newMode != mode || newNumVoices != numVoices || newNumChannels != numChannels)
+    {
+        mode = newMode;
+        numVoices = newNumVoices;
+        numChannels = newNumChannels;
+        restartOscillators();
+    }
+
+    depthInSamples = juce::jlimit (0.0f, 1.0f, depth) * getMaxSwingSeconds (mode) * sampleRate;
+    lfos.setParameters (shape, rateHz);
+    reader.setType (type);
+}
+
+double ModulatedDelay::getShortestDelay (double delayInSamples) const
+{
+    if (! isActive())
+        return delayInSamples;
+
+    return delayInSamples - juce::jmin (depthInSamples, delayInSamples * maxSwingFraction);
+}
+
+void ModulatedDelay::advance (int numSamples)
+{
+    if (isActive())
+        lfos.process (numSamples);
+}
+
+void ModulatedDelay::addFrom (float* output, int channel, int numSamples, const float* delayData, int mask, int writePosition,
+                              const double* delaysInSamples, double delayInSamples, const float* gains, float gain,
+                              double maxDelayInSamples)
+{
+    jassert (numSamples <= maxBlockSize && channel < numChannels);
+
+    auto* delays = voiceDelays + channel * maxBlockSize;
+    auto* voiceGain = voiceGains + channel * maxBlockSize;
+
+    // equal power, the voices are spread out enough to add up more like noise than like copies
+    auto voiceScale = 1.0f / std::sqrt ((float) numVoices);
+
+    if (gains != nullptr)
+        juce::FloatVectorOperations::multiply (voiceGain, gains, voiceScale, numSamples);
+    else
+        juce::FloatVectorOperations::fill (voiceGain, gain * voiceScale, numSamples);
+
+    for (int voice = 0; voice < numVoices; ++voice)
+    {
+        auto* lfo = lfos.getOutput (getOscillator (channel, voice));
+
+        // the swing shrinks with a short delay rather than reading into samples that haven't been written.
+        // no dependency between samples, so both loops vectorise.
+        if (delaysInSamples != nullptr)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto swing = juce::jmin (depthInSamples, delaysInSamples[i] * maxSwingFraction);
+                delays[i] = juce::jmin (maxDelayInSamples, delaysInSamples[i] + swing * lfo[i]);
+            }
+        }
+        else
+        {
+            auto swing = juce::jmin (depthInSamples, delayInSamples * maxSwingFraction);
+
+            for (int i = 0; i < numSamples; ++i)
+                delays[i] = juce::jmin (maxDelayInSamples, delayInSamples + swing * lfo[i]);
+        }
+
+        reader.addFrom (output, numSamples, delayData, mask, writePosition, delays, voiceGain,
+                        channel * maxNumVoices + voice);
+    }
+}
+
+//==============================================================================
+int ModulatedDelay::getOscillator (int channel, int voice) const
+{
+    return mode == Mode::wow ? 0 : channel * numVoices + voice;
+}
+
+void ModulatedDelay::restartOscillators()
+{
+    float phases[FractionalDelayReader::maxNumChannels * maxNumVoices] {};
+    auto numOscillators = 1;
+
+    if (mode != Mode::wow)
+    {
+        numOscillators = juce::jmax (1, numChannels) * numVoices;
+
+        // the voices evenly round the cycle, each channel a quarter cycle on from the last
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int voice = 0; voice < numVoices; ++voice)
+                phases[getOscillator (channel, voice)] = (float) voice / (float) numVoices + 0.25f * (float) channel;
+    }
+
+    lfos.setPhases (phases, numOscillators);
+    reader.reset();
+}
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    ModulatedDelay.h
+    Chorus, flanger and tape wow: the echo read from a position that swings
+    around the delay time, driven by the LFO bank.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FractionalDelayReader.h"
+#include "LfoBank.h"
+
+//==============================================================================
+/**
+    Each channel has one or more voices, each a read head on the delay ring
+    whose delay is the delay time plus depth times its own LFO. The delays
+    are worked out per sample into a block-long array and handed to the
+    ramped FractionalDelayReader::addFrom(), so every voice gets a proper
+    fractional read wherever it is.
+
+    - Chorus: up to maxNumVoices voices per channel, spread evenly around
+      the LFO's cycle and mixed at equal power.
+    - Flanger: one voice with a short swing, meant for short delay times.
+    - Wow: one slow, shared oscillator for every channel, the way a tape's
+      speed wobbles under all of its tracks at once.
+
+    Neighbouring channels are a quarter cycle apart in chorus and flanger,
+    which spreads a stereo pair.
+*/
+class ModulatedDelay
+{
+public:
+    // the order matches the choices of the MODULATION parameter
+    enum class Mode
+    {
+        off = 0,
+        chorus,
+        flanger,
+        wow
+    };
+
+    static constexpr int maxNumVoices = 8;
+
+    ModulatedDelay() = default;
+
+    static juce::StringArray getModeNames();
+
+    void prepare (double sampleRate, int numChannels, int maxBlockSize);
+
+    // audio thread, once per block. depth is 0 to 1 of the mode's swing, voices only count in chorus mode.
+    void setParameters (Mode newMode, LfoBank::Shape shape, float rateHz, float depth, int voices,
+                        InterpolationType type, int numChannels);
+
+    bool isActive() const { return mode != Mode::off; }
+    int getNumVoices() const { return numVoices; }
+
+    // the nearest any voice reads back, for a delay of delayInSamples. the swing is kept under the delay itself.
+    double getShortestDelay (double delayInSamples) const;
+
+    // audio thread, before the channels are read: runs the LFOs for the next numSamples
+    void advance (int numSamples);
+
+    // adds every voice of one channel to output, read from the ring around delaysInSamples (or delayInSamples when
+    // that's nullptr) and scaled by gains (or gain). no voice reads further back than maxDelayInSamples.
+    // each channel is read once per advance(), and different channels can be read on different threads.
+    void addFrom (float* output, int channel, int numSamples, const float* delayData, int mask, int writePosition,
+                  const double* delaysInSamples, double delayInSamples, const float* gains, float gain,
+                  double maxDelayInSamples);
+
+private:
+    static constexpr double maxSwingFraction = 0.9; // of the delay time, so a voice never reads ahead of the write
+
+    // which oscillator drives a voice
+    int getOscillator (int channel, int voice) const;
+
+    void restartOscillators();
+
+    double sampleRate {44100.0};
+    int maxBlockSize {0};
+    int numChannels {0};
+    int preparedChannels {0};
+
+    Mode mode {Mode::off};
+    int numVoices {1};
+    double depthInSamples {0.0};
+
+    LfoBank lfos;
+    FractionalDelayReader reader; // one allpass state for every voice of every channel
+
+    // a block of one voice's delays and the voices' gains, per channel so the channels can run on their own threads
+    juce::HeapBlock<double> voiceDelays;
+    juce::HeapBlock<float> voiceGains;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ModulatedDelay)
+};
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    MultiTapDelay.cpp
+
+  ==============================================================================
+*/
+
+#include "MultiTapDelay.h"
+
+//==============================================================================
+void MultiTapDelay::setTaps (const Tap* newTaps, int newNumTaps, int mask, int writePosition)
+{
+    numTaps = juce::jlimit (0, maxNumTaps, newNumTaps);
+
+    for (int t = 0; t < numTaps; ++t)
+    {
+        // linear interpolation reads one sample ahead, so never get closer than a sample to the write head
+        auto delay = juce::jlimit (1.0, (double) mask - 1.0, newTaps[t].delayInSamples);
+        auto readPosition = (double) writePosition - delay;
+        auto whole = (int) std::floor (readPosition);
+        auto fraction = (float) (readPosition - whole);
+        tapStarts[t] = whole & mask;
+
+        auto angle = (juce::jlimit (-1.0f, 1.0f, newTaps[t].pan) + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+        const float channelGains[] = { std::cos (angle) * juce::MathConstants<float>::sqrt2,
+                                       std::sin (angle) * juce::MathConstants<float>::sqrt2,
+                                       1.0f };
+
+        for (int channel = 0; channel <= maxNumChannels; ++channel)
+        {
+            auto gain = newTaps[t].gain * channelGains[channel];
+            tapWeights[channel][t][0] = gain * (1.0f - fraction);
+            tapWeights[channel][t][1] = gain * fraction;
+        }
+    }
+}
+
+void MultiTapDelay::process (float* const* outputs, const float* const* delayData, int numChannels,
+                             int numSamples, const float* wetGains, float wetGain)
+{
+    if (numTaps == 0)
+        return;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        // mono output, and channels past stereo, take the tap gain without panning
+        auto weightRow = (numChannels == 1 || channel >= maxNumChannels) ? maxNumChannels : channel;
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+            processChunk (outputs[channel], delayData[channel], weightRow,
+                          start, juce::jmin (chunkSize, numSamples - start), wetGains, wetGain);
+    }
+}
+
+template <int numInGroup>
+static void accumulateTaps (float* accumulator, const float* source, const int* tapStarts,
+                            const float (*weights)[2], int numSamples)
+{
+    // local copies, so the compiler knows the stores to the accumulator can't touch them
+    const float* s[numInGroup];
+    float w0[numInGroup], w1[numInGroup];
+
+    for (int k = 0; k < numInGroup; ++k)
+    {
+        s[k] = source + tapStarts[k];
+        w0[k] = weights[k][0];
+        w1[k] = weights[k][1];
+    }
+
+    for (int j = 0; j < numSamples; ++j)
+    {
+        float sum = 0.0f;
+
+        for (int k = 0; k < numInGroup; ++k)
+            sum += w0[k] * s[k][j] + w1[k] * s[k][j + 1];
+
+        accumulator[j] += sum;
+    }
+}
+
+void MultiTapDelay::processChunk (float* output, const float* source, int weightRow,
+                                  int start, int numSamplesInChunk, const float* wetGains, float wetGain) const
+{
+    // stays in L1 while every tap is added to it. taps go in groups so each trip over the accumulator
+    // reads several of them at once.
+    float accumulator[chunkSize] {};
+    int t = 0;
+
+    for (; t + tapGroupSize <= numTaps; t += tapGroupSize)
+        accumulateTaps<tapGroupSize> (accumulator, source + start, tapStarts + t, tapWeights[weightRow] + t, numSamplesInChunk);
+
+    for (; t < numTaps; ++t)
+        accumulateTaps<1> (accumulator, source + start, tapStarts + t, tapWeights[weightRow] + t, numSamplesInChunk);
+
+    if (wetGains != nullptr)
+        juce::FloatVectorOperations::addWithMultiply (output + start, accumulator, wetGains + start, numSamplesInChunk);
+    else
+        juce::FloatVectorOperations::addWithMultiply (output + start, accumulator, wetGain, numSamplesInChunk);
+}
+
+void MultiTapDelay::processPerTap (float* const* outputs, const float* const* delayData, int numChannels,
+                                   int numSamples, float wetGain)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto weightRow = (numChannels == 1 || channel >= maxNumChannels) ? maxNumChannels : channel;
+
+        for (int t = 0; t < numTaps; ++t)
+        {
+            // a full pass over the block per tap, like calling readDelayBuffer per tap
+            auto* output = outputs[channel];
+            auto* source = delayData[channel] + tapStarts[t];
+            auto w0 = tapWeights[weightRow][t][0] * wetGain;
+            auto w1 = tapWeights[weightRow][t][1] * wetGain;
+
+            for (int i = 0; i < numSamples; ++i)
+                output[i] += w0 * source[i] + w1 * source[i + 1];
+        }
+    }
+}
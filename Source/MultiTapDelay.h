@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    MultiTapDelay.h
+    Up to 64 linearly interpolated taps read out of the delay ring.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Rather than walking the block once per tap, process() makes a single pass
+    over the output: it works through the block in chunks, accumulates every
+    tap into a chunk-sized accumulator (eight taps per trip over it) and adds
+    that to the output once, with the wet gain.
+    The delay data is a DelayRing channel, so each tap's start is masked once
+    in setTaps() and its block is then one contiguous span with no wrap tests.
+*/
+class MultiTapDelay
+{
+public:
+    static constexpr int maxNumTaps = 64;
+
+    struct Tap
+    {
+        double delayInSamples {0.0};
+        float gain {1.0f};
+        float pan {0.0f}; // -1 (left) to 1 (right), constant power
+    };
+
+    MultiTapDelay() = default;
+
+    // works out each tap's read position and per-channel weights. taps are read relative to writePosition,
+    // mask is the ring's getMask().
+    void setTaps (const Tap* newTaps, int newNumTaps, int mask, int writePosition);
+
+    // adds wetGain (or the wetGains ramp, if not nullptr) times the sum of every tap to each output channel
+    void process (float* const* outputs, const float* const* delayData, int numChannels,
+                  int numSamples, const float* wetGains, float wetGain);
+
+    // the old way, one full pass over the block per tap. kept for the benchmark.
+    void processPerTap (float* const* outputs, const float* const* delayData, int numChannels,
+                        int numSamples, float wetGain);
+
+    int getNumTaps() const { return numTaps; }
+
+private:
+    static constexpr int chunkSize = 256;
+    static constexpr int tapGroupSize = 8;
+    static constexpr int maxNumChannels = 2; // panning is stereo, other channels just take the tap gain
+
+    void processChunk (float* output, const float* source, int weightRow,
+                       int start, int numSamplesInChunk, const float* wetGains, float wetGain) const;
+
+    int numTaps {0};
+    int tapStarts[maxNumTaps] {}; // masked index of the older of the two interpolated samples, for output sample 0
+    float tapWeights[maxNumChannels + 1][maxNumTaps][2] {}; // [channel][tap][older, newer], last row for channels without panning
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiTapDelay)
+};
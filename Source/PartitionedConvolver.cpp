@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+void PartitionedConvolver::prepare (const juce::AudioBuffer<float>& impulse, int newNumChannels, int newPartitionSize)
+{
+    jassert (juce::isPowerOfTwo (newPartitionSize) && impulse.getNumChannels() > 0);
+
+    numChannels = newNumChannels;
+    numImpulseChannels = impulse.getNumChannels();
+    partitionSize = newPartitionSize;
+    impulseLength = impulse.getNumSamples();
+
+    numBins = partitionSize + 1;
+    binStride = (numBins + 15) & ~15;
+    numTailPartitions = juce::jmax (0, (impulseLength - 1) / partitionSize);
+
+    // each transform covers two blocks, so the tail's circular convolution doesn't wrap into the block we keep
+    ffts.clear();
+
+    for (int channel = 0; channel < juce::jmax (1, numChannels); ++channel)
+        ffts.push_back (std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (2.0 * partitionSize))));
+
+    auto fftSize = ffts.front()->getSize();
+    fftBuffers.allocate ((size_t) juce::jmax (1, numChannels) * (size_t) fftSize * 2, true);
+    accumulators.allocate ((size_t) juce::jmax (1, numChannels) * (size_t) binStride * 2, true);
+
+    head.setSize (numImpulseChannels, partitionSize);
+    head.clear();
+
+    for (int channel = 0; channel < numImpulseChannels; ++channel)
+        head.copyFrom (channel, 0, impulse, channel, 0, juce::jmin (partitionSize, impulseLength));
+
+    // every tail partition transformed once, here, instead of on the audio thread
+    auto numSpectra = (size_t) juce::jmax (1, numTailPartitions);
+    spectra.allocate ((size_t) numImpulseChannels * numSpectra * 2 * (size_t) binStride, true);
+
+    for (int channel = 0; channel < numImpulseChannels; ++channel)
+    {
+        for (int partition = 0; partition < numTailPartitions; ++partition)
+        {
+            auto start = (partition + 1) * partitionSize;
+
+            auto* fftBuffer = fftBuffers.getData();
+
+            juce::FloatVectorOperations::clear (fftBuffer, fftSize * 2);
+            juce::FloatVectorOperations::copy (fftBuffer, impulse.getReadPointer (channel, start), juce::jmin (partitionSize, impulseLength - start));
+            ffts.front()->performRealOnlyForwardTransform (fftBuffer, true);
+
+            auto* spectrum = getSpectrum (spectra, channel, partition);
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                spectrum[bin] = fftBuffer[2 * bin];
+                spectrum[binStride + bin] = fftBuffer[2 * bin + 1];
+            }
+        }
+    }
+
+    inputs.allocate ((size_t) numChannels * numSpectra * 2 * (size_t) binStride, true);
+    history.setSize (numChannels, 2 * partitionSize);
+    tail.setSize (numChannels, partitionSize);
+    output.setSize (numChannels, partitionSize);
+
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    if (inputs != nullptr)
+        juce::FloatVectorOperations::clear (inputs, numChannels * juce::jmax (1, numTailPartitions) * 2 * binStride);
+
+    history.clear();
+    tail.clear();
+    inputSlot = 0;
+    fill = 0;
+}
+
+void PartitionedConvolver::process (float* const* channels, int numChannelsToProcess, int numSamples, float mix)
+{
+    processChannels (channels, 0, numChannelsToProcess, numSamples, mix);
+    endBlock (numSamples);
+}
+
+void PartitionedConvolver::processChannels (float* const* channels, int firstChannel, int numChannelsToProcess, int numSamples, float mix)
+{
+    jassert (firstChannel + numChannelsToProcess <= numChannels);
+
+    for (int channel = firstChannel; channel < firstChannel + numChannelsToProcess; ++channel)
+    {
+        auto* convolved = output.getWritePointer (channel);
+        auto* input = history.getWritePointer (channel);
+        auto* taps = head.getReadPointer (juce::jmin (channel, numImpulseChannels - 1));
+
+        // where the block starts in the input blocks, endBlock() moves that on once every channel is done
+        auto blockFill = fill;
+        auto slot = inputSlot;
+
+        // in pieces that end where an input block fills up, that's when the tail for the next one is worked out
+        for (int start = 0; start < numSamples;)
+        {
+            auto numThisTime = juce::jmin (numSamples - start, partitionSize - blockFill);
+            auto* samples = channels[channel] + start;
+
+            juce::FloatVectorOperations::copy (input + partitionSize + blockFill, samples, numThisTime);
+
+            // the head, directly: one pass over the piece per tap. the oldest taps reach back into the previous block.
+            juce::FloatVectorOperations::copy (convolved, tail.getReadPointer (channel, blockFill), numThisTime);
+
+            for (int tap = 0; tap < partitionSize; ++tap)
+                juce::FloatVectorOperations::addWithMultiply (convolved, input + partitionSize + blockFill - tap, taps[tap], numThisTime);
+
+            juce::FloatVectorOperations::multiply (samples, 1.0f - mix, numThisTime);
+            juce::FloatVectorOperations::addWithMultiply (samples, convolved, mix, numThisTime);
+
+            blockFill += numThisTime;
+            start += numThisTime;
+
+            if (blockFill == partitionSize)
+            {
+                processPartition (channel, slot);
+                juce::FloatVectorOperations::copy (input, input + partitionSize, partitionSize);
+
+                blockFill = 0;
+
+                if (numTailPartitions > 0)
+                    slot = (slot + 1) % numTailPartitions;
+            }
+        }
+    }
+}
+
+void PartitionedConvolver::endBlock (int numSamples)
+{
+    auto numFilled = fill + numSamples;
+    fill = numFilled % partitionSize;
+
+    if (numTailPartitions > 0)
+        inputSlot = (inputSlot + numFilled / partitionSize) % numTailPartitions;
+}
+
+void PartitionedConvolver::processPartition (int channel, int newestSlot)
+{
+    if (numTailPartitions == 0)
+        return;
+
+    auto& fft = *ffts[(size_t) channel];
+    auto* fftBuffer = fftBuffers.getData() + (size_t) channel * (size_t) fft.getSize() * 2;
+    auto* input = history.getReadPointer (channel);
+
+    juce::FloatVectorOperations::copy (fftBuffer, input, 2 * partitionSize);
+    juce::FloatVectorOperations::clear (fftBuffer + 2 * partitionSize, 2 * partitionSize);
+    fft.performRealOnlyForwardTransform (fftBuffer, true);
+
+    // the newest spectrum goes into the delay line, split so the multiply-accumulate below runs over plain arrays
+    auto* newest = getSpectrum (inputs, channel, newestSlot);
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        newest[bin] = fftBuffer[2 * bin];
+        newest[binStride + bin] = fftBuffer[2 * bin + 1];
+    }
+
+    // tail partition n lines up with the input from n blocks ago
+    auto* sumReal = accumulators.getData() + (size_t) channel * (size_t) binStride * 2;
+    auto* sumImag = sumReal + binStride;
+    juce::FloatVectorOperations::clear (sumReal, 2 * binStride);
+
+    auto impulseChannel = juce::jmin (channel, numImpulseChannels - 1);
+
+    for (int partition = 0; partition < numTailPartitions; ++partition)
+    {
+        auto slot = newestSlot - partition;
+
+        if (slot < 0)
+            slot += numTailPartitions;
+
+        auto* x = getSpectrum (inputs, channel, slot);
+        auto* h = getSpectrum (spectra, impulseChannel, partition);
+        auto* xImag = x + binStride;
+        auto* hImag = h + binStride;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            sumReal[bin] += x[bin] * h[bin] - xImag[bin] * hImag[bin];
+            sumImag[bin] += x[bin] * hImag[bin] + xImag[bin] * h[bin];
+        }
+    }
+
+    // the inverse fills in the negative frequencies itself
+    juce::FloatVectorOperations::clear (fftBuffer, fft.getSize() * 2);
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        fftBuffer[2 * bin] = sumReal[bin];
+        fftBuffer[2 * bin + 1] = sumImag[bin];
+    }
+
+    fft.performRealOnlyInverseTransform (fftBuffer);
+
+    // overlap-save: the first half wrapped round, the second half is the next block's tail
+    juce::FloatVectorOperations::copy (tail.getWritePointer (channel), fftBuffer + partitionSize, partitionSize);
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Zero-latency convolution with a long impulse response: the head block
+    directly, the rest as uniformly partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The impulse response is cut into partitions of partitionSize samples. The
+    first is convolved directly, sample by sample, so nothing is delayed. The
+    others go through the frequency domain: every partitionSize input samples
+    the newest two blocks of input are transformed once into a delay line of
+    spectra, multiplied with every partition's spectrum, and one inverse
+    transform gives the tail's contribution to the next block. That's ready
+    before it's needed because the tail starts a whole partition into the
+    impulse response.
+
+    Everything the impulse response needs, its spectra as well as the state,
+    is allocated and transformed in prepare(), so one of these is built off
+    the audio thread for each impulse response and swapped in whole (see
+    ImpulseLoader). process() doesn't allocate or lock.
+
+    Every channel has its own transform and scratch space, so the channels
+    of a block can be convolved on different threads at once.
+*/
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver() = default;
+
+    // any thread but the audio thread. a mono impulse response is used for every channel, otherwise channel
+    // n uses channel n of the impulse (or its last one). partitionSize is a power of two.
+    void prepare (const juce::AudioBuffer<float>& impulse, int numChannels, int partitionSize);
+    void reset();
+
+    // convolves in place, mixing the result with what was there: 0 is dry, 1 is only the convolution
+    void process (float* const* channels, int numChannels, int numSamples, float mix);
+
+    // the same for channels firstChannel to firstChannel + numChannels - 1 only. to split a block between threads,
+    // each one processes its own channels and endBlock() is called with the block's length once they've all finished.
+    void processChannels (float* const* channels, int firstChannel, int numChannels, int numSamples, float mix);
+    void endBlock (int numSamples);
+
+    int getImpulseLength() const { return impulseLength; }
+    int getPartitionSize() const { return partitionSize; }
+
+private:
+    void processPartition (int channel, int newestSlot); // transforms a full input block and works out the next block's tail
+
+    // spectra and inputs are both laid out [channel][partition], each spectrum two rows of binStride
+    float* getSpectrum (float* spectrumArray, int channel, int partition) const
+    {
+        return spectrumArray + ((size_t) channel * (size_t) numTailPartitions + (size_t) partition) * 2 * (size_t) binStride;
+    }
+
+    std::vector<std::unique_ptr<juce::dsp::FFT>> ffts; // one per channel, the same size
+
+    int numChannels {0};
+    int numImpulseChannels {0};
+    int partitionSize {0};
+    int numBins {0};            // partitionSize + 1, the non-negative frequencies of a 2 * partitionSize transform
+    int binStride {0};          // numBins rounded up so every spectrum starts aligned
+    int numTailPartitions {0};  // the partitions after the directly convolved head
+    int impulseLength {0};
+
+    juce::AudioBuffer<float> head;      // the first partition of each impulse channel
+    juce::HeapBlock<float> spectra;     // [impulse channel][tail partition] real parts then imaginary parts
+    juce::HeapBlock<float> inputs;      // [channel][slot] the input spectra, newest at inputSlot
+    int inputSlot {0};
+
+    juce::AudioBuffer<float> history;   // per channel, the previous and the current input block
+    juce::AudioBuffer<float> tail;      // per channel, the tail's output for the current block
+    juce::AudioBuffer<float> output;    // per channel, one block of convolved output
+    juce::HeapBlock<float> fftBuffers;  // per channel, 2 * fft size, the transforms work in place
+    juce::HeapBlock<float> accumulators; // per channel, the summed spectrum, real parts then imaginary parts
+    int fill {0};                       // samples of the current input block seen so far
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
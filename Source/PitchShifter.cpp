@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    PitchShifter.cpp
+
+  ==============================================================================
+*/
+
+#include "PitchShifter.h"
+
+//==============================================================================
+void PitchShifter::prepare (double newSampleRate, int newNumChannels, int newMaxBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = newMaxBlockSize;
+    preparedChannels = newNumChannels;
+    numChannels = juce::jmin (numChannels, preparedChannels);
+
+    reader.prepare (preparedChannels * numHeads);
+
+    headOffsets.setSize (numHeads, maxBlockSize);
+    headFades.setSize (numHeads, maxBlockSize);
+    headDelays.allocate ((size_t) (preparedChannels * maxBlockSize), true);
+    headGains.allocate ((size_t) (preparedChannels * maxBlockSize), true);
+
+    reset();
+}
+
+void PitchShifter::reset()
+{
+    phase = 0.0;
+    reader.reset();
+}
+
+void PitchShifter::setParameters (float semitones, float windowMs, InterpolationType type, int newNumChannels)
+{
+    newNumChannels = juce::jmin (newNumChannels, preparedChannels);
+
+    if (newNumChannels != numChannels)
+    {
+        numChannels = newNumChannels;
+        reset();
+    }
+
+    windowInSamples = juce::jmax (8.0, (double) windowMs * 0.001 * sampleRate);
+
+    // pitched up the heads catch up with the write, so they sweep down the window, and pitched down they sweep up
+    auto ratio = std::pow (2.0, (double) semitones / 12.0);
+    phaseIncrement = (1.0 - ratio) / windowInSamples;
+
+    reader.setType (type);
+}
+
+void PitchShifter::advance (int numSamples)
+{
+    jassert (numSamples <= maxBlockSize);
+
+    for (int head = 0; head < numHeads; ++head)
+    {
+        auto* offsets = headOffsets.getWritePointer (head);
+        auto* fades = headFades.getWritePointer (head);
+        auto start = phase + 0.5 * head;
+
+        // no dependency between samples, so this vectorises. a head can sweep through the window several times in
+        // one block, in double so the read position stays exact wherever it's got to.
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sweep = start + phaseIncrement * i;
+            auto position = (float) (sweep - std::floor (sweep));
+
+            // a triangle that's 0 where the head jumps and 1 half way, through a smoothstep. the other head's
+            // triangle is 1 minus this one, so the two gains add up to one.
+            auto triangle = 1.0f - std::abs (2.0f * position - 1.0f);
+
+            offsets[i] = (float) windowInSamples * position;
+            fades[i] = triangle * triangle * (3.0f - 2.0f * triangle);
+        }
+    }
+
+    phase += phaseIncrement * numSamples;
+    phase -= std::floor (phase);
+}
+
+void PitchShifter::addFrom (float* output, int channel, int numSamples, const float* delayData, int mask, int writePosition,
+                            const double* delaysInSamples, double delayInSamples, const float* gains, float gain,
+                            double maxDelayInSamples)
+{
+    jassert (numSamples <= maxBlockSize && channel < numChannels);
+
+    auto* delays = headDelays + channel * maxBlockSize;
+    auto* headGain = headGains + channel * maxBlockSize;
+
+    for (int head = 0; head < numHeads; ++head)
+    {
+        auto* offsets = headOffsets.getReadPointer (head);
+        auto* fades = headFades.getReadPointer (head);
+
+        if (delaysInSamples != nullptr)
+            for (int i = 0; i < numSamples; ++i)
+                delays[i] = juce::jmin (maxDelayInSamples, delaysInSamples[i] + offsets[i]);
+        else
+            for (int i = 0; i < numSamples; ++i)
+                delays[i] = juce::jmin (maxDelayInSamples, delayInSamples + offsets[i]);
+
+        if (gains != nullptr)
+            juce::FloatVectorOperations::multiply (headGain, gains, fades, numSamples);
+        else
+            juce::FloatVectorOperations::multiply (headGain, fades, gain, numSamples);
+
+        reader.addFrom (output, numSamples, delayData, mask, writePosition, delays, headGain, channel * numHeads + head);
+    }
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    PitchShifter.h
+    Shifts the echoes up or down as they're read back, so every trip round
+    the feedback shifts them again: shimmer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FractionalDelayReader.h"
+
+//==============================================================================
+/**
+    A rotating-head pitch shifter that reads straight out of the delay ring,
+    so it needs no memory or FFT of its own. Two read heads sweep through a
+    window of delays behind the delay time, at the speed that plays the ring
+    back at the pitch ratio: a head reading at ratio r moves its delay by
+    1 - r every sample. When a head reaches the end of the window it jumps
+    back to the start, and the heads are half a window apart with an S-curve
+    crossfade between them that is silent wherever a head jumps and always
+    adds up to one.
+
+    On average the heads read half a window further back than the delay
+    time, which is getLatencyInSamples(): the processor reads that much
+    sooner to keep the repeats in time. A short window has less latency and
+    a faster warble, a long one is smoother but smears transients.
+
+    The heads' window positions and gains are worked out once per block in
+    advance(), with no dependency between samples, and shared by every
+    channel; each head is then a ramped FractionalDelayReader read.
+*/
+class PitchShifter
+{
+public:
+    static constexpr int numHeads = 2;
+
+    PitchShifter() = default;
+
+    void prepare (double sampleRate, int numChannels, int maxBlockSize);
+
+    // puts the heads back at the start of their sweep
+    void reset();
+
+    // audio thread, once per block
+    void setParameters (float semitones, float windowMs, InterpolationType type, int numChannels);
+
+    // how much further back than the delay time the heads read, on average
+    float getLatencyInSamples() const { return (float) (windowInSamples * 0.5); }
+
+    // audio thread, before the channels are read: moves the heads on by numSamples
+    void advance (int numSamples);
+
+    // adds both heads of one channel to output, read from the ring behind delaysInSamples (or delayInSamples when
+    // that's nullptr) and scaled by gains (or gain). no head reads further back than maxDelayInSamples.
+    // each channel is read once per advance(), and different channels can be read on different threads.
+    void addFrom (float* output, int channel, int numSamples, const float* delayData, int mask, int writePosition,
+                  const double* delaysInSamples, double delayInSamples, const float* gains, float gain,
+                  double maxDelayInSamples);
+
+private:
+    double sampleRate {44100.0};
+    int maxBlockSize {0};
+    int numChannels {0};
+    int preparedChannels {0};
+
+    double windowInSamples {0.0};
+    double phaseIncrement {0.0};  // of the heads through the window, per sample
+    double phase {0.0};           // where the first head is in the window, 0 to 1. the second is half a window on.
+
+    FractionalDelayReader reader; // one allpass state for each head of each channel
+
+    // the block's window offset and gain of each head, shared by the channels
+    juce::AudioBuffer<float> headOffsets, headFades;
+
+    // a block of one head's delays and gains, per channel so the channels can run on their own threads
+    juce::HeapBlock<double> headDelays;
+    juce::HeapBlock<float> headGains;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PitchShifter)
+};
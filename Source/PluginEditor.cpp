@@ -45,14 +45,29 @@ NewProjectAudioProcessorEditor::NewProjectAudioProcessorEditor (NewProjectAudioP
     
     // setup the buffer clear button
     clearBufferButton.setButtonText ("clear buffer");
-    clearBufferButton.onClick = [this]() { audioProcessor.clearBufferFlag = true; };
+    clearBufferButton.onClick = [this]() { audioProcessor.postCommand ({ Command::Type::clear, audioProcessor.getSamplePositionNow() }); };
     addAndMakeVisible (clearBufferButton);
     
+    // freeze loops whatever is in the buffer until it's clicked again. the toggle follows the looper, which may
+    // already be frozen when the editor opens or be frozen by a restored snapshot.
+    freezeButton.setButtonText ("freeze");
+    freezeButton.setClickingTogglesState (true);
+    lastSeenFrozen = audioProcessor.isLoopFrozen();
+    freezeButton.setToggleState (lastSeenFrozen, juce::dontSendNotification);
+    freezeButton.onClick = [this]()
+    {
+        audioProcessor.postCommand ({ Command::Type::freeze, audioProcessor.getSamplePositionNow(), freezeButton.getToggleState() ? 1.0f : 0.0f });
+    };
+    addAndMakeVisible (freezeButton);
+    
     // instantiate delay length slider
     delayLengthSlider.setSliderStyle (juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
     delayLengthSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, true, 100, 50);
     addAndMakeVisible (delayLengthSlider);
-    delayLengthSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "DELAY_LENGTH", delayLengthSlider);
+    
+    // DELAY_LENGTH or DELAY_LENGTH_LONG, whichever MAX_DELAY picks. the timer swaps them when it changes.
+    delayLengthParameterID = NewProjectAudioProcessor::getDelayLengthParameterID ((int) audioProcessor.apvts.getRawParameterValue ("MAX_DELAY")->load());
+    delayLengthSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, delayLengthParameterID, delayLengthSlider);
     
     // setup the delay length label
     delayLengthLabel.setText ("delay length", juce::dontSendNotification);
@@ -60,15 +75,286 @@ NewProjectAudioProcessorEditor::NewProjectAudioProcessorEditor (NewProjectAudioP
     delayLengthLabel.attachToComponent (&delayLengthSlider, false);
     addAndMakeVisible (delayLengthLabel);
     
+    // setup the interpolation menu, the items have to exist before the attachment is made
+    interpolationBox.addItemList (FractionalDelayReader::getTypeNames(), 1);
+    addAndMakeVisible (interpolationBox);
+    interpolationBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "INTERPOLATION", interpolationBox);
+    
+    interpolationLabel.setText ("interpolation", juce::dontSendNotification);
+    interpolationLabel.attachToComponent (&interpolationBox, true);
+    addAndMakeVisible (interpolationLabel);
+    
+    // engine selection
+    setupComboBox (modeBox, modeLabel, "mode", NewProjectAudioProcessor::getModeNames(), "MODE", modeBoxAttachment);
+    modeLabel.attachToComponent (&modeBox, true);
+    
+    // feedback delay network row
+    setupComboBox (fdnLinesBox, fdnLinesLabel, "fdn lines", FeedbackDelayNetwork::getLineCountNames(), "FDN_LINES", fdnLinesBoxAttachment);
+    setupComboBox (fdnMatrixBox, fdnMatrixLabel, "matrix", FeedbackDelayNetwork::getMatrixNames(), "FDN_MATRIX", fdnMatrixBoxAttachment);
+    setupRotarySlider (fdnSizeSlider, fdnSizeLabel, "size", "FDN_SIZE", fdnSizeSliderAttachment);
+    setupRotarySlider (fdnDecaySlider, fdnDecayLabel, "decay", "FDN_DECAY", fdnDecaySliderAttachment);
+    setupRotarySlider (fdnDampingSlider, fdnDampingLabel, "damping", "FDN_DAMPING", fdnDampingSliderAttachment);
+    
+    // multi-tap row
+    setupRotarySlider (tapCountSlider, tapCountLabel, "taps", "TAP_COUNT", tapCountSliderAttachment);
+    setupRotarySlider (tapDecaySlider, tapDecayLabel, "tap decay", "TAP_DECAY", tapDecaySliderAttachment);
+    setupRotarySlider (tapSpreadSlider, tapSpreadLabel, "spread", "TAP_SPREAD", tapSpreadSliderAttachment);
+    
+    editTapsButton.setButtonText ("edit taps");
+    addAndMakeVisible (editTapsButton);
+    editTapsButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "TAP_EDIT", editTapsButton);
+    
+    // hand placed taps, a row each for the times, gains and pans. the page box picks which taps the columns show.
+    for (int page = 0; page < numTapPages; ++page)
+        tapPageBox.addItem ("taps " + juce::String (page * numTapColumns + 1) + "-" + juce::String ((page + 1) * numTapColumns), page + 1);
+    
+    tapPageBox.onChange = [this]() { showTapPage (tapPageBox.getSelectedItemIndex()); };
+    addAndMakeVisible (tapPageBox);
+    
+    tapPageLabel.setText ("page", juce::dontSendNotification);
+    tapPageLabel.setJustificationType (juce::Justification::centred);
+    tapPageLabel.attachToComponent (&tapPageBox, false);
+    addAndMakeVisible (tapPageLabel);
+    
+    for (int column = 0; column < numTapColumns; ++column)
+    {
+        for (auto* slider : { &tapTimeSliders[column], &tapGainSliders[column], &tapPanSliders[column] })
+        {
+            slider->setSliderStyle (juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+            slider->setTextBoxStyle (juce::Slider::TextBoxBelow, true, 70, 20);
+            addAndMakeVisible (slider);
+        }
+        
+        for (auto* label : { &tapTimeLabels[column], &tapGainLabels[column], &tapPanLabels[column] })
+        {
+            label->setJustificationType (juce::Justification::centred);
+            addAndMakeVisible (label);
+        }
+        
+        tapTimeLabels[column].attachToComponent (&tapTimeSliders[column], false);
+        tapGainLabels[column].attachToComponent (&tapGainSliders[column], false);
+        tapPanLabels[column].attachToComponent (&tapPanSliders[column], false);
+    }
+    
+    tapPageBox.setSelectedItemIndex (0, juce::dontSendNotification);
+    showTapPage (0);
+    
+    // delay time row
+    setupComboBox (maxDelayBox, maxDelayLabel, "max delay", NewProjectAudioProcessor::getMaxDelayNames(), "MAX_DELAY", maxDelayBoxAttachment);
+    
+    syncButton.setButtonText ("tempo sync");
+    addAndMakeVisible (syncButton);
+    syncButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "SYNC", syncButton);
+    
+    setupComboBox (syncNoteBox, syncNoteLabel, "note", TempoSync::getNoteNames(), "SYNC_NOTE", syncNoteBoxAttachment);
+    setupComboBox (syncModifierBox, syncModifierLabel, "feel", TempoSync::getModifierNames(), "SYNC_MODIFIER", syncModifierBoxAttachment);
+    
+    // stamped when it's clicked, so the intervals don't pick up the message thread's jitter
+    tapButton.setButtonText ("tap");
+    tapButton.onClick = [this]() { audioProcessor.postCommand ({ Command::Type::tapTempo, audioProcessor.getSamplePositionNow() }); };
+    addAndMakeVisible (tapButton);
+    
+    // feedback row
+    saturationButton.setButtonText ("saturation");
+    addAndMakeVisible (saturationButton);
+    saturationButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "SATURATION", saturationButton);
+    
+    setupRotarySlider (saturationDriveSlider, saturationDriveLabel, "drive", "SATURATION_DRIVE", saturationDriveSliderAttachment);
+    setupComboBox (saturationOversamplingBox, saturationOversamplingLabel, "oversampling", Saturator::getOversamplingNames(), "SATURATION_OVERSAMPLING", saturationOversamplingBoxAttachment);
+    setupComboBox (routingBox, routingLabel, "routing", ChannelRouter::getModeNames(), "ROUTING", routingBoxAttachment);
+    setupRotarySlider (routingAmountSlider, routingAmountLabel, "amount", "ROUTING_AMOUNT", routingAmountSliderAttachment);
+    
+    // convolution row
+    convolutionButton.setButtonText ("convolution");
+    addAndMakeVisible (convolutionButton);
+    convolutionButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "CONVOLUTION", convolutionButton);
+    
+    loadImpulseButton.setButtonText ("load IR");
+    loadImpulseButton.onClick = [this]() { chooseImpulseResponse(); };
+    addAndMakeVisible (loadImpulseButton);
+    
+    setupRotarySlider (convolutionMixSlider, convolutionMixLabel, "mix", "CONVOLUTION_MIX", convolutionMixSliderAttachment);
+    
+    impulseFileLabel.setText (audioProcessor.getImpulseResponseFile().getFileName(), juce::dontSendNotification);
+    impulseFileLabel.setJustificationType (juce::Justification::centredLeft);
+    addAndMakeVisible (impulseFileLabel);
+    
+    // looper row, what freeze holds and how overdubs build up
+    setupRotarySlider (loopLengthSlider, loopLengthLabel, "loop length", "LOOP_LENGTH", loopLengthSliderAttachment);
+    setupRotarySlider (loopOffsetSlider, loopOffsetLabel, "loop offset", "LOOP_OFFSET", loopOffsetSliderAttachment);
+    
+    overdubButton.setButtonText ("overdub");
+    addAndMakeVisible (overdubButton);
+    overdubButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "OVERDUB", overdubButton);
+    
+    setupRotarySlider (overdubDecaySlider, overdubDecayLabel, "decay", "OVERDUB_DECAY", overdubDecaySliderAttachment);
+    
+    // whether the buffer, and so the loop, is saved with the session
+    bufferSnapshotButton.setButtonText ("save buffer");
+    addAndMakeVisible (bufferSnapshotButton);
+    bufferSnapshotButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "BUFFER_SNAPSHOT", bufferSnapshotButton);
+    
+    // modulation row, the voices only matter for the chorus
+    setupComboBox (modulationBox, modulationLabel, "modulation", ModulatedDelay::getModeNames(), "MODULATION", modulationBoxAttachment);
+    setupComboBox (modulationShapeBox, modulationShapeLabel, "shape", LfoBank::getShapeNames(), "MOD_SHAPE", modulationShapeBoxAttachment);
+    setupRotarySlider (modulationRateSlider, modulationRateLabel, "rate", "MOD_RATE", modulationRateSliderAttachment);
+    setupRotarySlider (modulationDepthSlider, modulationDepthLabel, "depth", "MOD_DEPTH", modulationDepthSliderAttachment);
+    setupRotarySlider (modulationVoicesSlider, modulationVoicesLabel, "voices", "MOD_VOICES", modulationVoicesSliderAttachment);
+    
+    // feedback filter row
+    filterButton.setButtonText ("filter");
+    addAndMakeVisible (filterButton);
+    filterButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "FILTER", filterButton);
+    
+    setupRotarySlider (filterLowCutSlider, filterLowCutLabel, "low cut", "FILTER_LOW_CUT", filterLowCutSliderAttachment);
+    setupRotarySlider (filterHighCutSlider, filterHighCutLabel, "high cut", "FILTER_HIGH_CUT", filterHighCutSliderAttachment);
+    setupRotarySlider (filterTiltSlider, filterTiltLabel, "tilt", "FILTER_TILT", filterTiltSliderAttachment);
+    
+    // ducking rows, the detector settings then the follower's times
+    duckButton.setButtonText ("duck");
+    addAndMakeVisible (duckButton);
+    duckButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "DUCK", duckButton);
+    
+    setupComboBox (duckSourceBox, duckSourceLabel, "source", Ducker::getSourceNames(), "DUCK_SOURCE", duckSourceBoxAttachment);
+    setupComboBox (duckDetectorBox, duckDetectorLabel, "detector", Ducker::getDetectorNames(), "DUCK_DETECTOR", duckDetectorBoxAttachment);
+    setupRotarySlider (duckThresholdSlider, duckThresholdLabel, "threshold", "DUCK_THRESHOLD", duckThresholdSliderAttachment);
+    setupRotarySlider (duckDepthSlider, duckDepthLabel, "depth", "DUCK_DEPTH", duckDepthSliderAttachment);
+    setupRotarySlider (duckAttackSlider, duckAttackLabel, "attack", "DUCK_ATTACK", duckAttackSliderAttachment);
+    setupRotarySlider (duckReleaseSlider, duckReleaseLabel, "release", "DUCK_RELEASE", duckReleaseSliderAttachment);
+    
+    // grain row, only used in granular mode
+    setupRotarySlider (grainSizeSlider, grainSizeLabel, "grain size", "GRAIN_SIZE", grainSizeSliderAttachment);
+    setupRotarySlider (grainDensitySlider, grainDensityLabel, "density", "GRAIN_DENSITY", grainDensitySliderAttachment);
+    setupRotarySlider (grainPitchSlider, grainPitchLabel, "pitch", "GRAIN_PITCH", grainPitchSliderAttachment);
+    setupRotarySlider (grainSpraySlider, grainSprayLabel, "spray", "GRAIN_SPRAY", grainSpraySliderAttachment);
+    
+    // pitch row, shimmer on the repeats
+    pitchButton.setButtonText ("pitch");
+    addAndMakeVisible (pitchButton);
+    pitchButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "PITCH", pitchButton);
+    
+    setupRotarySlider (pitchShiftSlider, pitchShiftLabel, "semitones", "PITCH_SHIFT", pitchShiftSliderAttachment);
+    setupRotarySlider (pitchWindowSlider, pitchWindowLabel, "window", "PITCH_WINDOW", pitchWindowSliderAttachment);
+    
+    // profiler row
+    profilerLabel.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    profilerLabel.setJustificationType (juce::Justification::centredLeft);
+    addAndMakeVisible (profilerLabel);
+    startTimerHz (4);
+    
+    parallelButton.setButtonText ("parallel");
+    addAndMakeVisible (parallelButton);
+    parallelButtonAttachment = std::make_unique<ButtonAttachment> (audioProcessor.apvts, "PARALLEL", parallelButton);
+    
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (mainWidth, mainHeight + 16 * rowHeight);
+}
+
+void NewProjectAudioProcessorEditor::setupRotarySlider (juce::Slider& slider, juce::Label& label, const juce::String& text, const juce::String& parameterID, std::unique_ptr<SliderAttachment>& attachment)
+{
+    slider.setSliderStyle (juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    slider.setTextBoxStyle (juce::Slider::TextBoxBelow, true, 70, 20);
+    addAndMakeVisible (slider);
+    attachment = std::make_unique<SliderAttachment> (audioProcessor.apvts, parameterID, slider);
+    
+    label.setText (text, juce::dontSendNotification);
+    label.setJustificationType (juce::Justification::centred);
+    label.attachToComponent (&slider, false);
+    addAndMakeVisible (label);
+}
+
+void NewProjectAudioProcessorEditor::showTapPage (int page)
+{
+    for (int column = 0; column < numTapColumns; ++column)
+    {
+        auto number = juce::String (page * numTapColumns + column + 1);
+        
+        // the old attachment has to let go of the slider before the new one sets it to its parameter's value
+        tapTimeSliderAttachments[column].reset();
+        tapGainSliderAttachments[column].reset();
+        tapPanSliderAttachments[column].reset();
+        
+        tapTimeSliderAttachments[column] = std::make_unique<SliderAttachment> (audioProcessor.apvts, "TAP_" + number + "_TIME", tapTimeSliders[column]);
+        tapGainSliderAttachments[column] = std::make_unique<SliderAttachment> (audioProcessor.apvts, "TAP_" + number + "_GAIN", tapGainSliders[column]);
+        tapPanSliderAttachments[column] = std::make_unique<SliderAttachment> (audioProcessor.apvts, "TAP_" + number + "_PAN", tapPanSliders[column]);
+        
+        tapTimeLabels[column].setText ("time " + number, juce::dontSendNotification);
+        tapGainLabels[column].setText ("gain " + number, juce::dontSendNotification);
+        tapPanLabels[column].setText ("pan " + number, juce::dontSendNotification);
+    }
+}
+
+void NewProjectAudioProcessorEditor::setupComboBox (juce::ComboBox& box, juce::Label& label, const juce::String& text, const juce::StringArray& items, const juce::String& parameterID, std::unique_ptr<ComboBoxAttachment>& attachment)
+{
+    // the items have to exist before the attachment is made
+    box.addItemList (items, 1);
+    addAndMakeVisible (box);
+    attachment = std::make_unique<ComboBoxAttachment> (audioProcessor.apvts, parameterID, box);
+    
+    label.setText (text, juce::dontSendNotification);
+    label.setJustificationType (juce::Justification::centred);
+    label.attachToComponent (&box, false);
+    addAndMakeVisible (label);
 }
 
 NewProjectAudioProcessorEditor::~NewProjectAudioProcessorEditor()
 {
 }
 
+void NewProjectAudioProcessorEditor::chooseImpulseResponse()
+{
+    impulseChooser = std::make_unique<juce::FileChooser> ("Load an impulse response", audioProcessor.getImpulseResponseFile(), "*.wav;*.aif;*.aiff;*.flac");
+    
+    impulseChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles, [this] (const juce::FileChooser& chooser)
+    {
+        auto file = chooser.getResult();
+        
+        if (file == juce::File())
+            return;
+        
+        audioProcessor.loadImpulseResponse (file);
+        impulseFileLabel.setText (file.getFileName(), juce::dontSendNotification);
+    });
+}
+
+void NewProjectAudioProcessorEditor::timerCallback()
+{
+    auto snapshot = audioProcessor.getProfiler().getSnapshot();
+    auto stageNames = RealtimeProfiler::getStageNames();
+    
+    juce::String text;
+    text << "dsp load  p50 " << juce::String (snapshot.loadP50, 1) << "%  p99 " << juce::String (snapshot.loadP99, 1)
+         << "%  max " << juce::String (snapshot.loadMax, 1) << "%\n"
+         << "deadline misses " << snapshot.deadlineMisses << " of " << snapshot.numBlocks << " blocks\n"
+         << "p99 us ";
+    
+    // the total is already shown as the load. three stages to a line, so it fits the width.
+    for (int stage = 0; stage < (int) RealtimeProfiler::Stage::total; ++stage)
+        text << (stage == 3 ? "\n       " : " ") << stageNames[stage] << " " << juce::String (snapshot.stages[stage].p99, 1);
+    
+    profilerLabel.setText (text, juce::dontSendNotification);
+    
+    // only when the looper changes, so a click isn't undone before the audio thread has got to it
+    auto frozen = audioProcessor.isLoopFrozen();
+    
+    if (frozen != lastSeenFrozen)
+    {
+        lastSeenFrozen = frozen;
+        freezeButton.setToggleState (frozen, juce::dontSendNotification);
+    }
+    
+    // the delay knob follows the delay length parameter MAX_DELAY has switched to
+    auto parameterID = NewProjectAudioProcessor::getDelayLengthParameterID ((int) audioProcessor.apvts.getRawParameterValue ("MAX_DELAY")->load());
+    
+    if (parameterID != delayLengthParameterID)
+    {
+        delayLengthParameterID = parameterID;
+        delayLengthSliderAttachment.reset();
+        delayLengthSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, delayLengthParameterID, delayLengthSlider);
+    }
+}
+
 //==============================================================================
 void NewProjectAudioProcessorEditor::paint (juce::Graphics& g)
 {
@@ -84,8 +370,128 @@ void NewProjectAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
-    gainSlider.setBounds (getWidth() * 3/4 - 100, getHeight()/2 - 100, 200, 100);
-    wetGainSlider.setBounds (getWidth() * 3/4 - 100, getHeight  ()/2 + 25, 200, 100);
-    clearBufferButton.setBounds (getWidth() * 1/4 - 50, getHeight()/2 + 25, 100, 100); // TODO: make clear buffer button height smaller and don't warp text
-    delayLengthSlider.setBounds (getWidth() * 1/4 - 100, getHeight()/2 - 75, 200, 100);
+    // the main controls keep the original 400x300 layout, the engine rows stack up below it
+    gainSlider.setBounds (mainWidth * 3/4 - 100, mainHeight/2 - 100, 200, 100);
+    wetGainSlider.setBounds (mainWidth * 3/4 - 100, mainHeight/2 + 25, 200, 100);
+    clearBufferButton.setBounds (mainWidth * 1/4 - 50, mainHeight/2 + 25, 100, 40);
+    freezeButton.setBounds (mainWidth * 1/4 - 50, mainHeight/2 + 75, 100, 40);
+    delayLengthSlider.setBounds (mainWidth * 1/4 - 100, mainHeight/2 - 75, 200, 100);
+    modeBox.setBounds (50, 10, 90, 24);
+    interpolationBox.setBounds (mainWidth/2 + 40, 10, 110, 24);
+    
+    // feedback delay network row, labels sit above their controls
+    auto row = juce::Rectangle<int> (0, mainHeight, mainWidth, rowHeight).reduced (0, 20);
+    auto columnWidth = mainWidth / 5;
+    
+    fdnLinesBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    fdnMatrixBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    fdnSizeSlider.setBounds (row.removeFromLeft (columnWidth));
+    fdnDecaySlider.setBounds (row.removeFromLeft (columnWidth));
+    fdnDampingSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // multi-tap row
+    row = juce::Rectangle<int> (0, mainHeight + rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    tapCountSlider.setBounds (row.removeFromLeft (columnWidth));
+    tapDecaySlider.setBounds (row.removeFromLeft (columnWidth));
+    tapSpreadSlider.setBounds (row.removeFromLeft (columnWidth));
+    editTapsButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    tapPageBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    
+    // hand placed tap rows
+    for (int t = 0; t < numTapColumns; ++t)
+    {
+        auto column = juce::Rectangle<int> (t * columnWidth, mainHeight + 2 * rowHeight, columnWidth, rowHeight).reduced (0, 20);
+        
+        tapTimeSliders[t].setBounds (column);
+        tapGainSliders[t].setBounds (column.translated (0, rowHeight));
+        tapPanSliders[t].setBounds (column.translated (0, 2 * rowHeight));
+    }
+    
+    // delay time row
+    row = juce::Rectangle<int> (0, mainHeight + 5 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    maxDelayBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    syncButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    syncNoteBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    syncModifierBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    tapButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    
+    // feedback row
+    row = juce::Rectangle<int> (0, mainHeight + 6 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    saturationButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    saturationDriveSlider.setBounds (row.removeFromLeft (columnWidth));
+    saturationOversamplingBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    routingBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    routingAmountSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // convolution row
+    row = juce::Rectangle<int> (0, mainHeight + 7 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    convolutionButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    loadImpulseButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    convolutionMixSlider.setBounds (row.removeFromLeft (columnWidth));
+    impulseFileLabel.setBounds (row.withSizeKeepingCentre (row.getWidth() - 10, 24));
+    
+    // looper row
+    row = juce::Rectangle<int> (0, mainHeight + 8 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    loopLengthSlider.setBounds (row.removeFromLeft (columnWidth));
+    loopOffsetSlider.setBounds (row.removeFromLeft (columnWidth));
+    overdubButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    overdubDecaySlider.setBounds (row.removeFromLeft (columnWidth));
+    bufferSnapshotButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    
+    // modulation row
+    row = juce::Rectangle<int> (0, mainHeight + 9 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    modulationBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    modulationShapeBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    modulationRateSlider.setBounds (row.removeFromLeft (columnWidth));
+    modulationDepthSlider.setBounds (row.removeFromLeft (columnWidth));
+    modulationVoicesSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // feedback filter row
+    row = juce::Rectangle<int> (0, mainHeight + 10 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    filterButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    filterLowCutSlider.setBounds (row.removeFromLeft (columnWidth));
+    filterHighCutSlider.setBounds (row.removeFromLeft (columnWidth));
+    filterTiltSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // ducking rows
+    row = juce::Rectangle<int> (0, mainHeight + 11 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    duckButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    duckSourceBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    duckDetectorBox.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    duckThresholdSlider.setBounds (row.removeFromLeft (columnWidth));
+    duckDepthSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    row = juce::Rectangle<int> (0, mainHeight + 12 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    duckAttackSlider.setBounds (row.removeFromLeft (columnWidth));
+    duckReleaseSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // grain row
+    row = juce::Rectangle<int> (0, mainHeight + 13 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    grainSizeSlider.setBounds (row.removeFromLeft (columnWidth));
+    grainDensitySlider.setBounds (row.removeFromLeft (columnWidth));
+    grainPitchSlider.setBounds (row.removeFromLeft (columnWidth));
+    grainSpraySlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // pitch row
+    row = juce::Rectangle<int> (0, mainHeight + 14 * rowHeight, mainWidth, rowHeight).reduced (0, 20);
+    
+    pitchButton.setBounds (row.removeFromLeft (columnWidth).withSizeKeepingCentre (columnWidth - 10, 24));
+    pitchShiftSlider.setBounds (row.removeFromLeft (columnWidth));
+    pitchWindowSlider.setBounds (row.removeFromLeft (columnWidth));
+    
+    // profiler row, the readout over the parallel switch
+    row = juce::Rectangle<int> (0, mainHeight + 15 * rowHeight, mainWidth, rowHeight).reduced (10);
+    
+    parallelButton.setBounds (row.removeFromBottom (24).removeFromLeft (columnWidth * 2));
+    profilerLabel.setBounds (row);
 }
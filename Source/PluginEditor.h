@@ -14,7 +14,8 @@
 //==============================================================================
 /**
 */
-class NewProjectAudioProcessorEditor  : public juce::AudioProcessorEditor
+class NewProjectAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                        private juce::Timer
 {
 public:
     NewProjectAudioProcessorEditor (NewProjectAudioProcessor&);
@@ -25,6 +26,24 @@ public:
     void resized() override;
 
 private:
+    // refreshes the profiler readout, keeps the freeze button in step with the looper and the delay knob on the
+    // delay length parameter in use
+    void timerCallback() override;
+    
+    // asks for an impulse response file and hands it to the processor
+    void chooseImpulseResponse();
+    
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+    
+    // the smaller controls of the engine rows below the main controls share this setup
+    void setupRotarySlider (juce::Slider& slider, juce::Label& label, const juce::String& text, const juce::String& parameterID, std::unique_ptr<SliderAttachment>& attachment);
+    void setupComboBox (juce::ComboBox& box, juce::Label& label, const juce::String& text, const juce::StringArray& items, const juce::String& parameterID, std::unique_ptr<ComboBoxAttachment>& attachment);
+    
+    // points the hand placed tap columns at the taps on the given page, counting from 0
+    void showTapPage (int page);
+    
     juce::Slider gainSlider;
     juce::Label gainLabel;
     
@@ -32,9 +51,94 @@ private:
     juce::Label wetGainLabel;
     
     juce::TextButton clearBufferButton;
+    juce::TextButton freezeButton;
+    bool lastSeenFrozen {false}; // the looper's state the last time the button was synced to it
     
     juce::Slider delayLengthSlider;
     juce::Label delayLengthLabel;
+    juce::String delayLengthParameterID; // the one the slider is attached to
+    
+    juce::ComboBox interpolationBox;
+    juce::Label interpolationLabel;
+    
+    juce::ComboBox modeBox;
+    juce::Label modeLabel;
+    
+    // feedback delay network row
+    juce::ComboBox fdnLinesBox, fdnMatrixBox;
+    juce::Label fdnLinesLabel, fdnMatrixLabel;
+    juce::Slider fdnSizeSlider, fdnDecaySlider, fdnDampingSlider;
+    juce::Label fdnSizeLabel, fdnDecayLabel, fdnDampingLabel;
+    
+    // multi-tap row
+    juce::Slider tapCountSlider, tapDecaySlider, tapSpreadSlider;
+    juce::Label tapCountLabel, tapDecayLabel, tapSpreadLabel;
+    juce::ToggleButton editTapsButton;
+    
+    // hand placed tap rows, a page of numTapColumns taps at a time out of the whole table
+    static constexpr int numTapColumns = 4;
+    static constexpr int numTapPages = NewProjectAudioProcessor::numEditableTaps / numTapColumns;
+    
+    juce::ComboBox tapPageBox;
+    juce::Label tapPageLabel;
+    juce::Slider tapTimeSliders[numTapColumns], tapGainSliders[numTapColumns], tapPanSliders[numTapColumns];
+    juce::Label tapTimeLabels[numTapColumns], tapGainLabels[numTapColumns], tapPanLabels[numTapColumns];
+    
+    // delay time row
+    juce::ComboBox maxDelayBox, syncNoteBox, syncModifierBox;
+    juce::Label maxDelayLabel, syncNoteLabel, syncModifierLabel;
+    juce::ToggleButton syncButton;
+    juce::TextButton tapButton;
+    
+    // feedback row, saturation and routing
+    juce::ToggleButton saturationButton;
+    juce::Slider saturationDriveSlider, routingAmountSlider;
+    juce::Label saturationDriveLabel, routingAmountLabel;
+    juce::ComboBox saturationOversamplingBox, routingBox;
+    juce::Label saturationOversamplingLabel, routingLabel;
+    
+    // convolution row
+    juce::ToggleButton convolutionButton;
+    juce::TextButton loadImpulseButton;
+    juce::Slider convolutionMixSlider;
+    juce::Label convolutionMixLabel, impulseFileLabel;
+    std::unique_ptr<juce::FileChooser> impulseChooser; // kept alive while the async dialog is open
+    
+    // looper row
+    juce::Slider loopLengthSlider, loopOffsetSlider, overdubDecaySlider;
+    juce::Label loopLengthLabel, loopOffsetLabel, overdubDecayLabel;
+    juce::ToggleButton overdubButton, bufferSnapshotButton;
+    
+    // modulation row
+    juce::ComboBox modulationBox, modulationShapeBox;
+    juce::Label modulationLabel, modulationShapeLabel;
+    juce::Slider modulationRateSlider, modulationDepthSlider, modulationVoicesSlider;
+    juce::Label modulationRateLabel, modulationDepthLabel, modulationVoicesLabel;
+    
+    // feedback filter row
+    juce::ToggleButton filterButton;
+    juce::Slider filterLowCutSlider, filterHighCutSlider, filterTiltSlider;
+    juce::Label filterLowCutLabel, filterHighCutLabel, filterTiltLabel;
+    
+    // ducking rows
+    juce::ToggleButton duckButton;
+    juce::ComboBox duckSourceBox, duckDetectorBox;
+    juce::Label duckSourceLabel, duckDetectorLabel;
+    juce::Slider duckThresholdSlider, duckDepthSlider, duckAttackSlider, duckReleaseSlider;
+    juce::Label duckThresholdLabel, duckDepthLabel, duckAttackLabel, duckReleaseLabel;
+    
+    // grain row
+    juce::Slider grainSizeSlider, grainDensitySlider, grainPitchSlider, grainSpraySlider;
+    juce::Label grainSizeLabel, grainDensityLabel, grainPitchLabel, grainSprayLabel;
+    
+    // pitch row
+    juce::ToggleButton pitchButton;
+    juce::Slider pitchShiftSlider, pitchWindowSlider;
+    juce::Label pitchShiftLabel, pitchWindowLabel;
+    
+    // profiler row, dsp load and per-stage latency, and whether the worker threads help out
+    juce::Label profilerLabel;
+    juce::ToggleButton parallelButton;
     
     // Need to create a slider attachment between our gain slider and the gain parameter.
     // Our slider attachment must be destroyed before the slider object is destroyed:
@@ -42,7 +146,41 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gainSliderAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> wetGainSliderAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> delayLengthSliderAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> interpolationBoxAttachment;
+    std::unique_ptr<ComboBoxAttachment> modeBoxAttachment;
+    std::unique_ptr<ComboBoxAttachment> fdnLinesBoxAttachment, fdnMatrixBoxAttachment;
+    std::unique_ptr<SliderAttachment> fdnSizeSliderAttachment, fdnDecaySliderAttachment, fdnDampingSliderAttachment;
+    std::unique_ptr<SliderAttachment> tapCountSliderAttachment, tapDecaySliderAttachment, tapSpreadSliderAttachment;
+    std::unique_ptr<ButtonAttachment> editTapsButtonAttachment;
+    std::unique_ptr<SliderAttachment> tapTimeSliderAttachments[numTapColumns];
+    std::unique_ptr<SliderAttachment> tapGainSliderAttachments[numTapColumns];
+    std::unique_ptr<SliderAttachment> tapPanSliderAttachments[numTapColumns];
+    std::unique_ptr<ComboBoxAttachment> maxDelayBoxAttachment, syncNoteBoxAttachment, syncModifierBoxAttachment;
+    std::unique_ptr<ButtonAttachment> syncButtonAttachment;
+    std::unique_ptr<ButtonAttachment> saturationButtonAttachment;
+    std::unique_ptr<SliderAttachment> saturationDriveSliderAttachment, routingAmountSliderAttachment;
+    std::unique_ptr<ComboBoxAttachment> saturationOversamplingBoxAttachment, routingBoxAttachment;
+    std::unique_ptr<ButtonAttachment> convolutionButtonAttachment;
+    std::unique_ptr<SliderAttachment> convolutionMixSliderAttachment;
+    std::unique_ptr<SliderAttachment> loopLengthSliderAttachment, loopOffsetSliderAttachment, overdubDecaySliderAttachment;
+    std::unique_ptr<ButtonAttachment> overdubButtonAttachment, bufferSnapshotButtonAttachment;
+    std::unique_ptr<ComboBoxAttachment> modulationBoxAttachment, modulationShapeBoxAttachment;
+    std::unique_ptr<SliderAttachment> modulationRateSliderAttachment, modulationDepthSliderAttachment, modulationVoicesSliderAttachment;
+    std::unique_ptr<ButtonAttachment> filterButtonAttachment;
+    std::unique_ptr<SliderAttachment> filterLowCutSliderAttachment, filterHighCutSliderAttachment, filterTiltSliderAttachment;
+    std::unique_ptr<ButtonAttachment> duckButtonAttachment;
+    std::unique_ptr<ComboBoxAttachment> duckSourceBoxAttachment, duckDetectorBoxAttachment;
+    std::unique_ptr<SliderAttachment> duckThresholdSliderAttachment, duckDepthSliderAttachment, duckAttackSliderAttachment, duckReleaseSliderAttachment;
+    std::unique_ptr<SliderAttachment> grainSizeSliderAttachment, grainDensitySliderAttachment, grainPitchSliderAttachment, grainSpraySliderAttachment;
+    std::unique_ptr<ButtonAttachment> pitchButtonAttachment;
+    std::unique_ptr<SliderAttachment> pitchShiftSliderAttachment, pitchWindowSliderAttachment;
+    std::unique_ptr<ButtonAttachment> parallelButtonAttachment;
 
+    // the original editor area, and the height of each engine row under it
+    static constexpr int mainWidth = 400;
+    static constexpr int mainHeight = 300;
+    static constexpr int rowHeight = 100;
+    
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     NewProjectAudioProcessor& audioProcessor;
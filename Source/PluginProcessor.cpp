@@ -16,6 +16,7 @@ NewProjectAudioProcessor::NewProjectAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false) // only listened to by the ducking
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -23,9 +24,77 @@ NewProjectAudioProcessor::NewProjectAudioProcessor()
                        // nullptr -> we're not supplying an undo manager.
                        // "Parameters" -> name of the value tree.
                        // createParamters() -> returns our parameterLayout object.
-                       ), apvts (*this, nullptr, "Parameters", createParameters()) // TODO: this is called too soon (before member delayBufferMaxTime is initialized, so the delay length parameter has zero as its max and min values). This should scale with samplerate, why can't this use the sampleRate from prepareToPlay()?
+                       ), apvts (*this, nullptr, "Parameters", createParameters())
 #endif
 {
+    gainParameter = apvts.getRawParameterValue ("GAIN");
+    wetGainParameter = apvts.getRawParameterValue ("WET_GAIN");
+    delayLengthParameter = apvts.getRawParameterValue ("DELAY_LENGTH");
+    longDelayLengthParameter = apvts.getRawParameterValue ("DELAY_LENGTH_LONG");
+    maxDelayParameter = apvts.getRawParameterValue ("MAX_DELAY");
+    syncParameter = apvts.getRawParameterValue ("SYNC");
+    syncNoteParameter = apvts.getRawParameterValue ("SYNC_NOTE");
+    syncModifierParameter = apvts.getRawParameterValue ("SYNC_MODIFIER");
+    saturationParameter = apvts.getRawParameterValue ("SATURATION");
+    saturationDriveParameter = apvts.getRawParameterValue ("SATURATION_DRIVE");
+    saturationOversamplingParameter = apvts.getRawParameterValue ("SATURATION_OVERSAMPLING");
+    routingParameter = apvts.getRawParameterValue ("ROUTING");
+    routingAmountParameter = apvts.getRawParameterValue ("ROUTING_AMOUNT");
+    convolutionParameter = apvts.getRawParameterValue ("CONVOLUTION");
+    convolutionMixParameter = apvts.getRawParameterValue ("CONVOLUTION_MIX");
+    loopLengthParameter = apvts.getRawParameterValue ("LOOP_LENGTH");
+    loopOffsetParameter = apvts.getRawParameterValue ("LOOP_OFFSET");
+    overdubParameter = apvts.getRawParameterValue ("OVERDUB");
+    overdubDecayParameter = apvts.getRawParameterValue ("OVERDUB_DECAY");
+    bufferSnapshotParameter = apvts.getRawParameterValue ("BUFFER_SNAPSHOT");
+    interpolationParameter = apvts.getRawParameterValue ("INTERPOLATION");
+    modeParameter = apvts.getRawParameterValue ("MODE");
+    fdnLinesParameter = apvts.getRawParameterValue ("FDN_LINES");
+    fdnMatrixParameter = apvts.getRawParameterValue ("FDN_MATRIX");
+    fdnSizeParameter = apvts.getRawParameterValue ("FDN_SIZE");
+    fdnDecayParameter = apvts.getRawParameterValue ("FDN_DECAY");
+    fdnDampingParameter = apvts.getRawParameterValue ("FDN_DAMPING");
+    tapCountParameter = apvts.getRawParameterValue ("TAP_COUNT");
+    tapDecayParameter = apvts.getRawParameterValue ("TAP_DECAY");
+    tapSpreadParameter = apvts.getRawParameterValue ("TAP_SPREAD");
+    tapEditParameter = apvts.getRawParameterValue ("TAP_EDIT");
+    
+    for (int t = 0; t < numEditableTaps; ++t)
+    {
+        auto prefix = "TAP_" + juce::String (t + 1);
+        tapTimeParameters[t] = apvts.getRawParameterValue (prefix + "_TIME");
+        tapGainParameters[t] = apvts.getRawParameterValue (prefix + "_GAIN");
+        tapPanParameters[t] = apvts.getRawParameterValue (prefix + "_PAN");
+    }
+    
+    parallelParameter = apvts.getRawParameterValue ("PARALLEL");
+    modulationParameter = apvts.getRawParameterValue ("MODULATION");
+    modulationShapeParameter = apvts.getRawParameterValue ("MOD_SHAPE");
+    modulationRateParameter = apvts.getRawParameterValue ("MOD_RATE");
+    modulationDepthParameter = apvts.getRawParameterValue ("MOD_DEPTH");
+    modulationVoicesParameter = apvts.getRawParameterValue ("MOD_VOICES");
+    filterParameter = apvts.getRawParameterValue ("FILTER");
+    filterLowCutParameter = apvts.getRawParameterValue ("FILTER_LOW_CUT");
+    filterHighCutParameter = apvts.getRawParameterValue ("FILTER_HIGH_CUT");
+    filterTiltParameter = apvts.getRawParameterValue ("FILTER_TILT");
+    duckParameter = apvts.getRawParameterValue ("DUCK");
+    duckSourceParameter = apvts.getRawParameterValue ("DUCK_SOURCE");
+    duckDetectorParameter = apvts.getRawParameterValue ("DUCK_DETECTOR");
+    duckThresholdParameter = apvts.getRawParameterValue ("DUCK_THRESHOLD");
+    duckDepthParameter = apvts.getRawParameterValue ("DUCK_DEPTH");
+    duckAttackParameter = apvts.getRawParameterValue ("DUCK_ATTACK");
+    duckReleaseParameter = apvts.getRawParameterValue ("DUCK_RELEASE");
+    grainSizeParameter = apvts.getRawParameterValue ("GRAIN_SIZE");
+    grainDensityParameter = apvts.getRawParameterValue ("GRAIN_DENSITY");
+    grainPitchParameter = apvts.getRawParameterValue ("GRAIN_PITCH");
+    grainSprayParameter = apvts.getRawParameterValue ("GRAIN_SPRAY");
+    pitchParameter = apvts.getRawParameterValue ("PITCH");
+    pitchShiftParameter = apvts.getRawParameterValue ("PITCH_SHIFT");
+    pitchWindowParameter = apvts.getRawParameterValue ("PITCH_WINDOW");
+    
+    // a resized buffer is swapped in by the audio thread, between sub-blocks, as soon as it hears about it
+    delayBufferResizer.onReady = [this] { return commands.push ({ Command::Type::resize }); };
+    impulseLoader.onReady = [this] { return commands.push ({ Command::Type::impulseSwap }); };
 }
 
 NewProjectAudioProcessor::~NewProjectAudioProcessor()
@@ -67,7 +136,55 @@ bool NewProjectAudioProcessor::isMidiEffect() const
 
 double NewProjectAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // a frozen loop plays until it's released
+    if (looper.getPublishedState().frozen)
+        return std::numeric_limits<double>::infinity();
+    
+    // before the first block, the delay is whatever the parameter says
+    auto delaySeconds = tailDelaySeconds.load (std::memory_order_relaxed);
+    
+    if (delaySeconds <= 0.0)
+        delaySeconds = getDelayLengthSeconds();
+    
+    switch ((ProcessingMode) (int) modeParameter->load())
+    {
+        // FDN_DECAY is the time the network takes to drop 60 dB, after the longest line's first pass
+        case ProcessingMode::fdn:
+            return fdnDecayParameter->load() + fdnSizeParameter->load();
+        
+        // no feedback, the last tap is at the delay length
+        case ProcessingMode::multiTap:
+            return delaySeconds;
+        
+        // a reversed grain plays back the delay time before it, backwards, over the delay time after
+        case ProcessingMode::reverse:
+            return 2.0 * delaySeconds;
+        
+        // grains start anywhere up to spray past the delay, and may take a while longer to play out when pitched down
+        case ProcessingMode::granular:
+            return delaySeconds * (1.0 + grainSprayParameter->load()) + 2.0 * grainSizeParameter->load() * 0.001;
+        
+        case ProcessingMode::delay:
+        default:
+            break;
+    }
+    
+    // every trip round the feedback is the wet gain down. the saturator, the pitch shifter and the modulation leave
+    // the level alone, but the filter's tilt lifts one end by half its gain.
+    auto loopGain = (double) wetGainParameter->load();
+    
+    if (filterParameter->load() >= 0.5f)
+        loopGain *= juce::Decibels::decibelsToGain (std::abs (filterTiltParameter->load()) * 0.5);
+    
+    if (loopGain <= 0.0)
+        return 0.0;
+    
+    if (loopGain >= 1.0)
+        return std::numeric_limits<double>::infinity();
+    
+    // until the echoes are 60 dB down, each one smeared by the impulse response on the way
+    auto numRepeats = std::ceil (std::log (0.001) / std::log (loopGain));
+    return numRepeats * (delaySeconds + tailImpulseSeconds.load (std::memory_order_relaxed));
 }
 
 int NewProjectAudioProcessor::getNumPrograms()
@@ -100,17 +217,114 @@ void NewProjectAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     
+    // at the same rate the history still means the same thing, so it's kept (a frozen loop with it)
+    auto keepHistory = sampleRate == savedSampleRate && delayBuffer.getNumChannels() > 0;
+    
     savedSampleRate = sampleRate;
-    delayBufferLength = (int)(sampleRate * delayBufferMaxTime);
-    delayBuffer.setSize(getTotalNumOutputChannels(), delayBufferLength);
+    maxBlockSize = samplesPerBlock;
+    
+    // the audio thread isn't running, so this is the one place the buffer is allocated in place
+    delayBufferResizer.stop();
+    restoreInFlight = false; // stopping dropped anything offered
+    
+    // rounded up to a power of two. the mirrored tail covers a whole sub-block plus the interpolators' reach,
+    // so no read or write ever has to be split at the end.
+    DelayRing newBuffer;
+    newBuffer.setSize (getTotalNumOutputChannels(), getDelayBufferLengthFor (getMaxDelaySeconds ((int) maxDelayParameter->load())),
+                       maxBlockSize + FractionalDelayReader::maxReadSpan);
+    
+    if (keepHistory)
+    {
+        // nothing's been written since a loop froze, the history that matters ends there
+        auto historyEnd = looper.isFrozen() ? looper.getFrozenAt() : samplesWritten.load();
+        newBuffer.copyHistoryFrom (delayBuffer, historyEnd - newBuffer.getNumSamples(), historyEnd);
+        
+        if (looper.isFrozen() && ! looper.fits (newBuffer))
+            looper.release();
+    }
+    else
+    {
+        samplesWritten = 0;
+        looper.release();
+        
+        // anything still pending was timed against the old clock
+        numPendingCommands = 0;
+        lastTapPosition = -1;
+        numTapIntervals = 0;
+        tappedDelayInSamples = 0.0;
+    }
+    
+    {
+        const juce::ScopedLock sl (stateLock);
+        
+        // a snapshot from before there was a buffer to put it in, it ends where writing starts
+        if (! pendingSnapshot.isEmpty())
+        {
+            BufferSnapshot::Header header;
+            
+            if (BufferSnapshot::read (pendingSnapshot.getData(), pendingSnapshot.getSize(), newBuffer, samplesWritten, sampleRate, header))
+                looper.restore (header.loop, samplesWritten);
+            
+            pendingSnapshot.reset();
+        }
+        
+        isPrepared = true;
+    }
     
-    std::cout << "savedSampleRate=" << savedSampleRate << std::endl << "delayBufferLength=" << delayBufferLength << std::endl << "delayBuffer.getNumSamples()=" << delayBuffer.getNumSamples() << std::endl;
+    delayBuffer.swapWith (newBuffer);
+    writePosition = (int) (samplesWritten.load() & delayBuffer.getMask());
+    resizeDeferred = false;
+    
+    delayReader.prepare (getTotalNumOutputChannels());
+    tempoSync.prepare (sampleRate);
+    looper.prepare (sampleRate, maxBlockSize);
+    
+    delayBufferResizer.start();
+    
+    // offline, blocks come faster than the aggregator polls, so whoever renders collects instead
+    profiler.prepare (sampleRate);
+    
+    if (! isNonRealtime())
+        profiler.start();
+    
+    // the worker threads only exist while an instance has PARALLEL on. taken here, so the first block already has them.
+    workerPool.setWanted (parallelParameter->load() >= 0.5f);
+    workerPool.update();
+    
+    parameterRamps.setSize (2, maxBlockSize);
+    wetBuffer.setSize (getTotalNumOutputChannels(), maxBlockSize);
+    feedBuffer.setSize (getTotalNumOutputChannels(), maxBlockSize);
+    saturator.prepare (getTotalNumOutputChannels(), maxBlockSize);
+    impulseLoader.prepare (sampleRate, getTotalNumOutputChannels());
+    modulatedDelay.prepare (sampleRate, getTotalNumOutputChannels(), maxBlockSize);
+    pitchShifter.prepare (sampleRate, getTotalNumOutputChannels(), maxBlockSize);
+    feedbackFilter.prepare (sampleRate);
+    ducker.prepare (sampleRate, maxBlockSize);
+    delayRamp.allocate ((size_t) maxBlockSize, true);
+    
+    fdn.prepare (sampleRate);
+    granular.prepare (sampleRate, getTotalNumOutputChannels(), maxBlockSize);
+    
+    // start the ramps at the current values so playback doesn't fade in from zero
+    mainGainSmoothed.reset (sampleRate, gainRampSeconds);
+    wetGainSmoothed.reset (sampleRate, gainRampSeconds);
+    delayInSamplesSmoothed.reset (sampleRate, delayRampSeconds);
+    mainGainSmoothed.setCurrentAndTargetValue (gainParameter->load());
+    wetGainSmoothed.setCurrentAndTargetValue (wetGainParameter->load());
+    delayInSamplesSmoothed.setCurrentAndTargetValue (getDelayLengthSeconds() * sampleRate);
+    
+    DBG ("savedSampleRate=" << savedSampleRate << ", delayBuffer.getNumSamples()=" << delayBuffer.getNumSamples());
 }
 
 void NewProjectAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    isPrepared = false;
+    delayBufferResizer.stop();
+    restoreInFlight = false;
+    impulseLoader.stop();
+    profiler.stop();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -120,18 +334,26 @@ bool NewProjectAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // anything from mono up to 16 channels: 7.1.4, third order ambisonics, or just discrete channels.
+    // every channel gets its own delay line, the routing modes work on any count.
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+    
+    if (numChannels < 1 || numChannels > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // the sidechain is only a level to follow, mono or stereo is plenty
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechain = layouts.getChannelSet (true, 1);
+        
+        if (! sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono() && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -142,8 +364,15 @@ bool NewProjectAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 void NewProjectAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    RealtimeTrap::ScopedAudioThread audioThread;
+    profiler.beginBlock (buffer.getNumSamples());
+    
+    blockStartSample.store (samplesWritten.load (std::memory_order_relaxed), std::memory_order_relaxed);
+    blockStartTicks.store (juce::Time::getHighResolutionTicks(), std::memory_order_relaxed);
+    
+    // the delay only runs on the main bus, a sidechain's channels come after it in the buffer
+    auto totalNumInputChannels  = getMainBusNumInputChannels();
+    auto totalNumOutputChannels = getMainBusNumOutputChannels();
 
     // clear both channels
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
@@ -152,93 +381,737 @@ void NewProjectAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     // get interface parameter values
     float mainGain;
     float wetGain;
-    bool clearBuffer;
     float delayTime;
-    std::tie(mainGain, wetGain, clearBuffer, delayTime) = getParameters();
+    std::tie(mainGain, wetGain, delayTime) = getParameters();
+    
+    // the delay buffer is asked for whatever MAX_DELAY needs, and until it's there the delay stops at what the current one holds
+    auto maxDelaySeconds = getMaxDelaySeconds ((int) maxDelayParameter->load());
+    delayBufferResizer.requestLength (getDelayBufferLengthFor (maxDelaySeconds));
+    
+    auto delayInSamples = (double) delayTime * savedSampleRate;
+    
+    // synced, the delay is a note at the host's tempo. it's only recalculated when the tempo or note changes,
+    // and the smoothing below glides through tempo changes instead of jumping.
+    if (syncParameter->load() >= 0.5f)
+    {
+        tempoSync.setNote ((int) syncNoteParameter->load(), (int) syncModifierParameter->load());
+        
+        if (auto* playHead = getPlayHead())
+            if (auto position = playHead->getPosition())
+                tempoSync.setPosition (*position);
+        
+        delayInSamples = tempoSync.getDelayInSamples();
+    }
+    else if (tappedDelayInSamples > 0.0 && delayTime == delayLengthAtTap)
+    {
+        delayInSamples = tappedDelayInSamples;
+    }
+    else
+    {
+        tappedDelayInSamples = 0.0; // the delay length was moved since the last tap
+    }
+    
+    saturationEnabled = saturationParameter->load() >= 0.5f;
+    saturator.setParameters (saturationDriveParameter->load(), (int) saturationOversamplingParameter->load());
+    channelRouter.setParameters ((ChannelRouter::Mode) (int) routingParameter->load(), routingAmountParameter->load(), totalNumInputChannels);
+    convolutionEnabled = convolutionParameter->load() >= 0.5f && impulseLoader.getActive() != nullptr;
+    parallelEnabled = parallelParameter->load() >= 0.5f;
+    workerPool.setWanted (parallelEnabled);
+    
+    // a filter switched back on starts from silence rather than from wherever it was left
+    auto filterWasEnabled = filterEnabled;
+    filterEnabled = filterParameter->load() >= 0.5f;
+    feedbackFilter.setParameters (filterLowCutParameter->load(), filterHighCutParameter->load(), filterTiltParameter->load(), totalNumInputChannels);
+    
+    if (filterEnabled && ! filterWasEnabled)
+        feedbackFilter.reset();
+    
+    // the same for the ducking's envelope. a sidechain that's disabled leaves the input to follow.
+    auto duckingWasEnabled = duckingEnabled;
+    duckingEnabled = duckParameter->load() >= 0.5f;
+    ducker.setParameters ((Ducker::Detector) (int) duckDetectorParameter->load(), duckThresholdParameter->load(),
+                          duckDepthParameter->load(), duckAttackParameter->load(), duckReleaseParameter->load());
+    
+    if (duckingEnabled && ! duckingWasEnabled)
+        ducker.reset();
+    
+    auto* sidechainBus = getBus (true, 1);
+    numSidechainChannels = 0;
     
-    // clear delay
-    if (clearBuffer == true) {
-        buffer.clear();
-        delayBuffer.clear();
-        clearBufferFlag = false;
+    if ((Ducker::Source) (int) duckSourceParameter->load() == Ducker::Source::sidechain && sidechainBus != nullptr && sidechainBus->isEnabled())
+    {
+        sidechainChannel = sidechainBus->getChannelIndexInProcessBlockBuffer (0);
+        numSidechainChannels = juce::jmin (sidechainBus->getNumberOfChannels(), buffer.getNumChannels() - sidechainChannel);
+    }
+    
+    // the oversampling filters hold every echo back a little, so read that much sooner to keep the repeats in time
+    if (saturationEnabled)
+        delayInSamples = juce::jmax (0.0, delayInSamples - (double) saturator.getLatencyInSamples());
+    
+    // the pitch shifter's heads read half a window further back on average, so that's taken off too
+    auto pitchShiftWasEnabled = pitchShiftEnabled;
+    pitchShiftEnabled = pitchParameter->load() >= 0.5f
+                        && (ProcessingMode) (int) modeParameter->load() == ProcessingMode::delay
+                        && (ModulatedDelay::Mode) (int) modulationParameter->load() == ModulatedDelay::Mode::off;
+    pitchShifter.setParameters (pitchShiftParameter->load(), pitchWindowParameter->load(),
+                                (InterpolationType) (int) interpolationParameter->load(), totalNumInputChannels);
+    
+    if (pitchShiftEnabled && ! pitchShiftWasEnabled)
+        pitchShifter.reset();
+    
+    if (pitchShiftEnabled)
+        delayInSamples = juce::jmax (0.0, delayInSamples - (double) pitchShifter.getLatencyInSamples());
+    
+    delayInSamples = juce::jmin (delayInSamples, maxDelaySeconds * savedSampleRate,
+                                 (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize()));
+    
+    tailDelaySeconds.store (delayInSamples / savedSampleRate, std::memory_order_relaxed);
+    tailImpulseSeconds.store (convolutionEnabled ? impulseLoader.getActive()->getImpulseLength() / savedSampleRate : 0.0,
+                              std::memory_order_relaxed);
+    
+    // new targets for the ramps, which start moving from the first sample of this block
+    mainGainSmoothed.setTargetValue (mainGain);
+    wetGainSmoothed.setTargetValue (wetGain);
+    delayInSamplesSmoothed.setTargetValue (delayInSamples); // keeps the fraction of a sample
+    
+    delayReader.setType ((InterpolationType) (int) interpolationParameter->load());
+    
+    // the voices read with the same interpolator as the plain delay
+    modulatedDelay.setParameters ((ModulatedDelay::Mode) (int) modulationParameter->load(), (LfoBank::Shape) (int) modulationShapeParameter->load(),
+                                  modulationRateParameter->load(), modulationDepthParameter->load(), (int) modulationVoicesParameter->load(),
+                                  delayReader.getType(), totalNumInputChannels);
+    
+    // grains left over from the last time round would read whatever is there now
+    auto previousMode = mode;
+    mode = (ProcessingMode) (int) modeParameter->load();
+    
+    if (mode != previousMode)
+        granular.reset();
+    
+    if (mode == ProcessingMode::fdn)
+        fdn.setParameters (FeedbackDelayNetwork::getLineCountForIndex ((int) fdnLinesParameter->load()),
+                           (FeedbackDelayNetwork::MixingMatrix) (int) fdnMatrixParameter->load(),
+                           fdnSizeParameter->load(), fdnDecayParameter->load(), fdnDampingParameter->load());
+    
+    // the ramp buffers hold maxBlockSize samples, and some hosts send bigger blocks than they promised
+    auto numSamples = buffer.getNumSamples();
+    
+    collectCommands();
+    
+    profiler.lap (RealtimeProfiler::Stage::parameters);
+    
+    // not prepared yet when maxBlockSize is 0
+    for (int start = 0; maxBlockSize > 0 && start < numSamples;)
+    {
+        // commands land on their sample: whatever is due has happened, and the sub-block stops short of the next one
+        auto position = samplesWritten.load (std::memory_order_relaxed);
+        applyDueCommands (buffer, start, position);
+        
+        auto length = juce::jmin (maxBlockSize, numSamples - start);
+        
+        if (numPendingCommands > 0)
+            length = (int) juce::jmin ((juce::int64) length, pendingCommands[0].samplePosition - position);
+        
+        // the wet path reads a whole sub-block before it feeds any of it back, so a delay shorter than that goes in
+        // sub-blocks that stop short of their own writes, like processDelayLines() does, and the echoes of this
+        // block's echoes still come round. the delay ramps in a straight line, so it's never shorter than either end.
+        if (usesWetPath())
+        {
+            auto shortestDelay = modulatedDelay.getShortestDelay (juce::jmin (delayInSamplesSmoothed.getCurrentValue(),
+                                                                              delayInSamplesSmoothed.getTargetValue()));
+            length = juce::jmin (length, FractionalDelayReader::getLongestRun (delayReader.getType(), shortestDelay));
+        }
+        
+        juce::AudioBuffer<float> subBlock (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, length);
+        processSubBlock (subBlock);
+        start += length;
     }
     
-    // convert delayTime from seconds into samples to get read head position
-    int readPositionOffset = (int)(delayTime * savedSampleRate);
+    looper.publishState(); // for getStateInformation()
+    
+    profiler.endBlock();
+}
 
+void NewProjectAudioProcessor::processSubBlock (juce::AudioBuffer<float>& buffer)
+{
+    auto totalNumInputChannels = getMainBusNumInputChannels();
+    auto numSamples = buffer.getNumSamples();
+    
+    // only build per-sample ramps while something is moving, otherwise the kernels take the block-constant (vectorised) path
+    auto mainGainIsRamping = mainGainSmoothed.isSmoothing();
+    auto delayIsRamping = wetGainSmoothed.isSmoothing() || delayInSamplesSmoothed.isSmoothing();
+    
+    if (mainGainIsRamping)
+    {
+        auto* mainGainRamp = parameterRamps.getWritePointer (0);
+        
+        for (int i = 0; i < numSamples; ++i)
+            mainGainRamp[i] = mainGainSmoothed.getNextValue();
+    }
+    
+    // how far back the nearest read reaches decides whether a block can read the ring before writing it
+    auto shortestDelay = delayInSamplesSmoothed.getTargetValue();
+    
+    if (delayIsRamping)
+    {
+        auto* wetGainRamp = parameterRamps.getWritePointer (1);
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            wetGainRamp[i] = wetGainSmoothed.getNextValue();
+            delayRamp[i] = delayInSamplesSmoothed.getNextValue();
+            shortestDelay = juce::jmin (shortestDelay, delayRamp[i]);
+        }
+    }
+    
+    // the modulated voices swing nearer than the delay time
+    shortestDelay = modulatedDelay.getShortestDelay (shortestDelay);
+    
+    auto mainGainApplied = false;
+    
+    profiler.lap (RealtimeProfiler::Stage::parameters);
+    
     // calculate delay
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    if (looper.isFrozen())
+    {
+        // the writer and the feedback are skipped entirely, the loop is all there is to do
+        looper.process (delayBuffer, buffer.getArrayOfWritePointers(), totalNumInputChannels, numSamples,
+                        delayIsRamping ? parameterRamps.getReadPointer (1) : nullptr, wetGainSmoothed.getTargetValue(),
+                        overdubParameter->load() >= 0.5f, overdubDecayParameter->load());
+        
+        profiler.lap (RealtimeProfiler::Stage::read);
+    }
+    else if (mode == ProcessingMode::fdn)
+    {
+        // keep the plain delay's history current, so switching modes back doesn't replay stale audio
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            fillDelayBuffer (buffer, channel);
+        
+        profiler.lap (RealtimeProfiler::Stage::fill);
+        
+        fdn.process (buffer.getArrayOfWritePointers(), totalNumInputChannels, numSamples,
+                     delayIsRamping ? parameterRamps.getReadPointer (1) : nullptr, wetGainSmoothed.getTargetValue());
+        
+        profiler.lap (RealtimeProfiler::Stage::read);
+    }
+    else if (mode == ProcessingMode::multiTap)
+    {
+        // the taps read the history before this block's input is written, like the plain delay does
+        updateTaps();
+        profiler.lap (RealtimeProfiler::Stage::parameters);
+        
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            fillDelayBuffer (buffer, channel);
+        
+        profiler.lap (RealtimeProfiler::Stage::fill);
+        
+        multiTap.process (buffer.getArrayOfWritePointers(), delayBuffer.getArrayOfReadPointers(), totalNumInputChannels,
+                          numSamples, delayIsRamping ? parameterRamps.getReadPointer (1) : nullptr, wetGainSmoothed.getTargetValue());
+        
+        profiler.lap (RealtimeProfiler::Stage::read);
+    }
+    else if (mode == ProcessingMode::reverse || mode == ProcessingMode::granular)
+    {
+        // the newest grains start at this block's input, so it goes in first
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            fillDelayBuffer (buffer, channel);
+        
+        profiler.lap (RealtimeProfiler::Stage::fill);
+        
+        // the grains started from here on follow the delay time as it ramps
+        granular.setParameters (mode == ProcessingMode::reverse, delayInSamplesSmoothed.getCurrentValue(),
+                                (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize()),
+                                grainSizeParameter->load(), grainDensityParameter->load(),
+                                grainPitchParameter->load(), grainSprayParameter->load());
+        
+        granular.process (buffer.getArrayOfWritePointers(), delayBuffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples,
+                          delayBuffer.getMask(), writePosition, delayIsRamping ? parameterRamps.getReadPointer (1) : nullptr,
+                          wetGainSmoothed.getTargetValue());
+        
+        profiler.lap (RealtimeProfiler::Stage::read);
+    }
+    else if (usesWetPath())
+    {
+        // the echoes are read on their own (modulated, pitch shifted or not), convolved, routed between the channels, filtered and saturated a
+        // whole frame at a time, then written back with the input, so the feedback goes round through all of them too
+        juce::AudioBuffer<float> wet (wetBuffer.getArrayOfWritePointers(), totalNumInputChannels, numSamples);
+        wet.clear();
+        
+        // the ducking follows the dry input, or the sidechain, before any echo is added to it
+        const float* duckGains = nullptr;
+        
+        if (duckingEnabled)
+        {
+            if (numSidechainChannels > 0)
+                ducker.process (buffer.getArrayOfReadPointers() + sidechainChannel, numSidechainChannels, numSamples);
+            else
+                ducker.process (buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+            
+            duckGains = ducker.getGains();
+        }
+        
+        // ping-pong feeds the delay lines from a mix of the input, everything else from the input itself
+        juce::AudioBuffer<float> routedInput (feedBuffer.getArrayOfWritePointers(), totalNumInputChannels, numSamples);
+        
+        if (channelRouter.routesInput())
+            channelRouter.routeInput (routedInput.getArrayOfWritePointers(), buffer.getArrayOfReadPointers(), numSamples);
+        
+        auto& feed = channelRouter.routesInput() ? routedInput : buffer;
+        
+        // processBlock() cut the sub-block short of the echoes reaching into it, so the input goes in with them
+        jassert (FractionalDelayReader::getLongestRun (delayReader.getType(), shortestDelay) >= numSamples);
+        
+        // the heavy stages are per channel, so with PARALLEL on they're shared out between the worker threads.
+        // a short block or light work isn't worth handing out, the hand-over costs a few microseconds.
+        auto heavyPerChannel = convolutionEnabled || (saturationEnabled && saturator.isOversampling()) || modulatedDelay.getNumVoices() > 1
+                               || pitchShiftEnabled;
+        
+        modulatedDelay.advance (numSamples);
+        
+        if (pitchShiftEnabled)
+            pitchShifter.advance (numSamples);
+        
+        // until the message thread has taken the pool after PARALLEL was turned on, there isn't one to use
+        WorkerPoolHandle::ScopedUse pool (workerPool);
+        
+        if (parallelEnabled && pool.get() != nullptr && heavyPerChannel && numSamples >= minParallelBlockSize && totalNumInputChannels > 1)
+        {
+            processWetChannelsInParallel (*pool.get(), buffer, wet, feed, duckGains, delayIsRamping);
+        }
+        else
+        {
+            if (modulatedDelay.isActive())
+                for (int channel = 0; channel < totalNumInputChannels; ++channel)
+                    readModulatedDelay (wet.getWritePointer (channel), channel, numSamples, delayIsRamping);
+            else if (pitchShiftEnabled)
+                for (int channel = 0; channel < totalNumInputChannels; ++channel)
+                    readPitchShifted (wet.getWritePointer (channel), channel, numSamples, delayIsRamping);
+            else
+                readDelayBuffer (wet, delayBuffer, totalNumInputChannels, delayIsRamping);
+            
+            profiler.lap (RealtimeProfiler::Stage::read);
+            
+            if (convolutionEnabled)
+                impulseLoader.getActive()->process (wet.getArrayOfWritePointers(), totalNumInputChannels, numSamples, convolutionMixParameter->load());
+            
+            if (! channelRouter.isBypassed())
+                channelRouter.process (wet.getArrayOfWritePointers(), numSamples);
+            
+            if (filterEnabled)
+                feedbackFilter.process (wet.getArrayOfWritePointers(), numSamples);
+            
+            if (saturationEnabled)
+            {
+                juce::dsp::AudioBlock<float> wetBlock (wet);
+                saturator.process (wetBlock);
+            }
+            
+            profiler.lap (RealtimeProfiler::Stage::feedback);
+            
+            // the echoes go round at full level before the output's are ducked, and the ducking is multiplied in
+            // as they're added, not run over the block on its own
+            for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            {
+                feedBackDelayBuffer (delayBuffer.getWritePointer (channel), feed.getReadPointer (channel), wet.getReadPointer (channel), numSamples);
+                
+                if (duckGains != nullptr)
+                    juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (channel), wet.getReadPointer (channel),
+                                                                  duckGains, numSamples);
+                else
+                    buffer.addFrom (channel, 0, wet, channel, 0, numSamples);
+            }
+            
+            profiler.lap (RealtimeProfiler::Stage::fill);
+        }
+    }
+    else
     {
-        fillDelayBuffer (buffer, channel);
-        readDelayBuffer (buffer, delayBuffer, channel, wetGain, readPositionOffset);
-        fillDelayBuffer (buffer, channel);
+        // one pass: read the echo, write input plus echo back as the feedback, apply the main gain
+        processDelayLines (buffer, totalNumInputChannels, delayIsRamping, mainGainIsRamping, shortestDelay);
+        profiler.lap (RealtimeProfiler::Stage::read);
         
-        buffer.applyGain(mainGain);
+        mainGainApplied = true;
     }
     
+    if (! mainGainApplied)
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            applyMainGain (buffer, channel, mainGainIsRamping);
+    
     updateBufferPositions (buffer, delayBuffer);
+    profiler.lap (RealtimeProfiler::Stage::gain);
 }
 
-void NewProjectAudioProcessor::fillDelayBuffer (juce::AudioBuffer<float>& buffer, int channel)
+bool NewProjectAudioProcessor::usesWetPath() const
 {
-    auto bufferSize = buffer.getNumSamples();
-    auto delayBufferSize = delayBuffer.getNumSamples();
+    return ! looper.isFrozen() && mode == ProcessingMode::delay
+           && (saturationEnabled || convolutionEnabled || ! channelRouter.isBypassed() || modulatedDelay.isActive() || filterEnabled
+               || duckingEnabled || pitchShiftEnabled);
+}
+
+void NewProjectAudioProcessor::processWetChannelsInParallel (WorkerPool& pool, juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& wet,
+                                                             const juce::AudioBuffer<float>& feed, const float* duckGains, bool delayIsRamping)
+{
+    auto numChannels = wet.getNumChannels();
+    auto numSamples = wet.getNumSamples();
+    
+    // the tasks only see raw pointers, touching the buffers themselves from several threads would race on their flags
+    auto* const* wetChannels = wet.getArrayOfWritePointers();
+    auto* const* outputChannels = buffer.getArrayOfWritePointers();
+    auto* const* feedChannels = feed.getArrayOfReadPointers();
+    auto* const* delayData = delayBuffer.getArrayOfReadPointers();
+    auto* const* ringChannels = delayBuffer.getArrayOfWritePointers();
+    auto mask = delayBuffer.getMask();
     
-    // Check to see if main buffer copies to delay buffer without needing to wrap...
-    if (delayBufferSize > bufferSize + writePosition) {
+    auto* convolver = convolutionEnabled ? impulseLoader.getActive() : nullptr;
+    auto convolutionMix = convolutionMixParameter->load();
+    
+    // a worker still busy half a block after the audio thread has run out of tasks will make the block late
+    auto deadlineSeconds = 0.5 * numSamples / getSampleRate();
+    
+    // each channel's echo is read and convolved by whichever thread gets to it first
+    pool.run (numChannels, deadlineSeconds, [&] (int channel)
+    {
+        if (modulatedDelay.isActive())
+            readModulatedDelay (wetChannels[channel], channel, numSamples, delayIsRamping);
+        else if (pitchShiftEnabled)
+            readPitchShifted (wetChannels[channel], channel, numSamples, delayIsRamping);
+        else if (delayIsRamping)
+            delayReader.addFrom (wetChannels[channel], numSamples, delayData[channel], mask, writePosition,
+                                 delayRamp.getData(), parameterRamps.getReadPointer (1), channel);
+        else
+            delayReader.addFrom (wetChannels[channel], numSamples, delayData[channel], mask, writePosition,
+                                 delayInSamplesSmoothed.getTargetValue(), wetGainSmoothed.getTargetValue(), channel);
+        
+        if (convolver != nullptr)
+            convolver->processChannels (wetChannels, channel, 1, numSamples, convolutionMix);
+    });
+    
+    if (convolver != nullptr)
+        convolver->endBlock (numSamples);
+    
+    profiler.lap (RealtimeProfiler::Stage::read);
+    
+    // the router mixes channels and the filter runs them side by side, so they wait for all of them and run on their own
+    if (! channelRouter.isBypassed())
+        channelRouter.process (wetChannels, numSamples);
+    
+    if (filterEnabled)
+        feedbackFilter.process (wetChannels, numSamples);
+    
+    juce::dsp::AudioBlock<float> wetBlock (wetChannels, (size_t) numChannels, (size_t) numSamples);
+    
+    pool.run (numChannels, deadlineSeconds, [&] (int channel)
+    {
+        if (saturationEnabled)
+        {
+            auto channelBlock = wetBlock.getSingleChannelBlock ((size_t) channel);
+            saturator.process (channelBlock, channel);
+        }
         
-        // copy main buffer samples to delay buffer
-        delayBuffer.copyFrom (channel, writePosition, buffer.getWritePointer (channel), bufferSize);
+        // each channel of the ring is its own memory, so the tasks can write it side by side through the pointers fetched above
+        feedBackDelayBuffer (ringChannels[channel], feedChannels[channel], wetChannels[channel], numSamples);
+        
+        if (duckGains != nullptr)
+            juce::FloatVectorOperations::addWithMultiply (outputChannels[channel], wetChannels[channel], duckGains, numSamples);
+        else
+            juce::FloatVectorOperations::add (outputChannels[channel], wetChannels[channel], numSamples);
+    });
+    
+    saturator.endBlock();
+    profiler.lap (RealtimeProfiler::Stage::feedback);
+}
+
+void NewProjectAudioProcessor::updateTaps()
+{
+    // evenly spaced up to the delay length, each one quieter than the last and alternating sides
+    MultiTapDelay::Tap taps[MultiTapDelay::maxNumTaps];
+    auto numTaps = juce::jlimit (1, MultiTapDelay::maxNumTaps, (int) tapCountParameter->load());
+    auto delayInSamples = delayInSamplesSmoothed.getCurrentValue();
+    auto decay = tapDecayParameter->load();
+    auto spread = tapSpreadParameter->load();
+    auto gain = 1.0f;
+    
+    for (int t = 0; t < numTaps; ++t)
+    {
+        taps[t].delayInSamples = delayInSamples * (t + 1) / numTaps;
+        taps[t].gain = gain;
+        taps[t].pan = (t % 2 == 0 ? -spread : spread);
+        gain *= decay;
     }
     
-    // Needs to wrap
-    else
+    // with TAP_EDIT on, every tap is placed by hand instead
+    if (tapEditParameter->load() >= 0.5f)
     {
-        // Determine how much space is left at the end of the delay buffer
-        auto numSamplesToEnd = delayBufferSize - writePosition;
-        // Copy that amount of samples to the end
-        delayBuffer.copyFrom (channel, writePosition, buffer.getWritePointer (channel), numSamplesToEnd);
+        for (int t = 0; t < juce::jmin (numTaps, numEditableTaps); ++t)
+        {
+            taps[t].delayInSamples = delayInSamples * tapTimeParameters[t]->load();
+            taps[t].gain = tapGainParameters[t]->load();
+            taps[t].pan = tapPanParameters[t]->load();
+        }
+    }
+    
+    multiTap.setTaps (taps, numTaps, delayBuffer.getMask(), writePosition);
+}
+
+void NewProjectAudioProcessor::processDelayLines (juce::AudioBuffer<float>& buffer, int numChannels, bool delayIsRamping,
+                                                  bool mainGainIsRamping, double shortestDelay)
+{
+    auto numSamples = buffer.getNumSamples();
+    auto* delayData = delayBuffer.getArrayOfWritePointers();
+    auto mask = delayBuffer.getMask();
+    float* samples[maxNumChannels];
+    
+    // a delay shorter than the block reads samples this block writes, so it goes in runs that stop short of them.
+    // usually that's the whole block.
+    auto runLength = FractionalDelayReader::getLongestRun (delayReader.getType(), shortestDelay);
+    
+    for (int start = 0; start < numSamples; start += runLength)
+    {
+        auto numThisTime = juce::jmin (runLength, numSamples - start);
+        auto* outputGains = mainGainIsRamping ? parameterRamps.getReadPointer (0, start) : nullptr;
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            samples[channel] = buffer.getWritePointer (channel, start);
+        
+        if (delayIsRamping)
+            delayReader.processFeedback (samples, numChannels, numThisTime, delayData, mask, writePosition + start,
+                                         delayRamp.getData() + start, parameterRamps.getReadPointer (1, start),
+                                         outputGains, mainGainSmoothed.getTargetValue());
+        else
+            delayReader.processFeedback (samples, numChannels, numThisTime, delayData, mask, writePosition + start,
+                                         delayInSamplesSmoothed.getTargetValue(), wetGainSmoothed.getTargetValue(),
+                                         outputGains, mainGainSmoothed.getTargetValue());
         
-        // calculate how many samples are remaining to copy
-        auto numSamplesAtStart = bufferSize - numSamplesToEnd;
-        // copy remaining amount to beginning of delay buffer, from the start
-        delayBuffer.copyFrom (channel, 0, buffer.getWritePointer (channel, numSamplesToEnd), numSamplesAtStart);
+        for (int channel = 0; channel < numChannels; ++channel)
+            delayBuffer.commit (channel, writePosition + start, numThisTime);
     }
 }
 
-void NewProjectAudioProcessor::readDelayBuffer (juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& delayBuffer, int channel, float wetGain, int readPositionOffset)
+void NewProjectAudioProcessor::applyMainGain (juce::AudioBuffer<float>& buffer, int channel, bool isRamping)
+{
+    auto numSamples = buffer.getNumSamples();
+    
+    // per channel, the ramp must only be applied once to each sample
+    if (isRamping)
+        juce::FloatVectorOperations::multiply (buffer.getWritePointer (channel), parameterRamps.getReadPointer (0), numSamples);
+    else
+        buffer.applyGain (channel, 0, numSamples, mainGainSmoothed.getTargetValue());
+}
+
+void NewProjectAudioProcessor::fillDelayBuffer (juce::AudioBuffer<float>& buffer, int channel)
+{
+    // the ring takes care of the wrap, and of keeping its mirrored tail in step
+    delayBuffer.write (channel, writePosition, buffer.getReadPointer (channel), buffer.getNumSamples());
+}
+
+void NewProjectAudioProcessor::feedBackDelayBuffer (float* ringChannel, const float* input, const float* wet, int numSamples)
+{
+    // summed straight into the ring, so there's no buffer holding input plus echo to fill and copy out of
+    juce::FloatVectorOperations::add (ringChannel + (writePosition & delayBuffer.getMask()), input, wet, numSamples);
+    delayBuffer.commit (ringChannel, writePosition, numSamples);
+}
+
+void NewProjectAudioProcessor::readDelayBuffer (juce::AudioBuffer<float>& buffer, DelayRing& delayBuffer, int numChannels, bool isRamping)
 {
     auto bufferSize = buffer.getNumSamples();
-    auto delayBufferSize = delayBuffer.getNumSamples();
     
-    auto readPosition = writePosition - readPositionOffset;
+    // the reader masks its start index, after that the whole block is one contiguous span
+    if (isRamping)
+        delayReader.addFrom (buffer.getArrayOfWritePointers(), numChannels, bufferSize,
+                             delayBuffer.getArrayOfReadPointers(), delayBuffer.getMask(), writePosition,
+                             delayRamp.getData(), parameterRamps.getReadPointer (1));
+    else
+        delayReader.addFrom (buffer.getArrayOfWritePointers(), numChannels, bufferSize,
+                             delayBuffer.getArrayOfReadPointers(), delayBuffer.getMask(), writePosition,
+                             delayInSamplesSmoothed.getTargetValue(), wetGainSmoothed.getTargetValue());
+}
+
+void NewProjectAudioProcessor::readModulatedDelay (float* destination, int channel, int numSamples, bool isRamping)
+{
+    // no voice reaches past what the ring holds, whatever the swing
+    auto maxDelay = (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize());
     
-    // what if readPosition is negative? Should we increment until becoming positive?
-    if (readPosition < 0)
-        readPosition += delayBufferSize;
+    modulatedDelay.addFrom (destination, channel, numSamples, delayBuffer.getReadPointer (channel), delayBuffer.getMask(), writePosition,
+                            isRamping ? delayRamp.getData() : nullptr, delayInSamplesSmoothed.getTargetValue(),
+                            isRamping ? parameterRamps.getReadPointer (1) : nullptr, wetGainSmoothed.getTargetValue(), maxDelay);
+}
+
+void NewProjectAudioProcessor::readPitchShifted (float* destination, int channel, int numSamples, bool isRamping)
+{
+    // the heads sweep a window behind the delay time, but never past what the ring holds
+    auto maxDelay = (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize());
+    
+    pitchShifter.addFrom (destination, channel, numSamples, delayBuffer.getReadPointer (channel), delayBuffer.getMask(), writePosition,
+                          isRamping ? delayRamp.getData() : nullptr, delayInSamplesSmoothed.getTargetValue(),
+                          isRamping ? parameterRamps.getReadPointer (1) : nullptr, wetGainSmoothed.getTargetValue(), maxDelay);
+}
+
+void NewProjectAudioProcessor::updateBufferPositions (juce::AudioBuffer<float>& buffer, DelayRing& delayBuffer)
+{
+    // published after the block is in the buffer, the resizer copies history up to here
+    auto written = samplesWritten.load (std::memory_order_relaxed) + buffer.getNumSamples();
+    samplesWritten.store (written, std::memory_order_release);
+    
+    writePosition = (int) (written & delayBuffer.getMask());
+}
+
+juce::int64 NewProjectAudioProcessor::getSamplePositionNow() const
+{
+    auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - blockStartTicks.load (std::memory_order_relaxed));
+    return blockStartSample.load (std::memory_order_relaxed) + (juce::int64) (elapsedSeconds * savedSampleRate);
+}
 
-    if (readPosition + bufferSize < delayBufferSize)
+void NewProjectAudioProcessor::collectCommands()
+{
+    Command command;
+    
+    // whatever doesn't fit stays in the queue for the next block
+    while (numPendingCommands < maxPendingCommands && commands.pop (command))
     {
-        // add bufferSize number of samples starting at readPosition from the delayBuffer to the main buffer
-        buffer.addFrom (channel, 0, delayBuffer.getReadPointer (channel, readPosition), bufferSize, wetGain);
+        // insertion sort, after anything at the same position so commands keep the order they were posted in
+        auto index = numPendingCommands++;
+        
+        for (; index > 0 && pendingCommands[index - 1].samplePosition > command.samplePosition; --index)
+            pendingCommands[index] = pendingCommands[index - 1];
+        
+        pendingCommands[index] = command;
     }
-    else
+}
+
+void NewProjectAudioProcessor::applyDueCommands (juce::AudioBuffer<float>& buffer, int start, juce::int64 position)
+{
+    int numDue = 0;
+    
+    while (numDue < numPendingCommands && pendingCommands[numDue].samplePosition <= position)
+        applyCommand (pendingCommands[numDue++], buffer, start, position);
+    
+    if (numDue > 0)
     {
-        int numSamplesToEnd = delayBufferSize - readPosition;
-        buffer.addFrom (channel, 0, delayBuffer.getReadPointer (channel, readPosition), numSamplesToEnd, wetGain);
+        std::copy (pendingCommands + numDue, pendingCommands + numPendingCommands, pendingCommands);
+        numPendingCommands -= numDue;
+    }
+}
 
-        int numSamplesAtStart = bufferSize - numSamplesToEnd;
-        buffer.addFrom (channel, numSamplesToEnd, delayBuffer.getReadPointer (channel, 0), numSamplesAtStart, wetGain);
+void NewProjectAudioProcessor::applyCommand (const Command& command, juce::AudioBuffer<float>& buffer, int start, juce::int64 position)
+{
+    switch (command.type)
+    {
+        case Command::Type::clear:
+            // like the original clear button, the rest of this block is silenced too
+            delayBuffer.clear();
+            fdn.reset();
+            saturator.reset();
+            buffer.clear (start, buffer.getNumSamples() - start);
+            break;
+            
+        case Command::Type::freeze:
+            if (command.value >= 0.5f && ! looper.isFrozen())
+            {
+                looper.freeze (delayBuffer, position, (int) (loopLengthParameter->load() * savedSampleRate),
+                               (int) (loopOffsetParameter->load() * savedSampleRate));
+            }
+            else if (command.value < 0.5f && looper.isFrozen())
+            {
+                // nothing was written while frozen, so the delay would replay whatever was there before
+                looper.release();
+                delayBuffer.clearHistory (looper.getFrozenAt(), position);
+                
+                if (resizeDeferred)
+                    swapResizedBuffer();
+            }
+            break;
+            
+        case Command::Type::tapTempo:
+            // the tap's own timestamp, not when it got here, so the intervals are exact
+            handleTap (command.samplePosition > 0 ? command.samplePosition : position);
+            break;
+            
+        case Command::Type::resize:
+            // the loop is addressed in the ring as it is, so it waits for the release. a restored snapshot
+            // brings its own loop.
+            if (looper.isFrozen() && ! delayBufferResizer.isOfferReady())
+                resizeDeferred = true;
+            else
+                swapResizedBuffer();
+            break;
+            
+        case Command::Type::impulseSwap:
+            // convolutionEnabled was worked out against the old one, which may have been the lack of one
+            if (impulseLoader.swapIfReady())
+                convolutionEnabled = convolutionParameter->load() >= 0.5f;
+            break;
+            
+        case Command::Type::presetSwap:
+            // the new values are already the ramps' targets, jump straight there instead of sweeping the delay
+            mainGainSmoothed.setCurrentAndTargetValue (mainGainSmoothed.getTargetValue());
+            wetGainSmoothed.setCurrentAndTargetValue (wetGainSmoothed.getTargetValue());
+            delayInSamplesSmoothed.setCurrentAndTargetValue (delayInSamplesSmoothed.getTargetValue());
+            break;
+            
+        default:
+            break;
     }
 }
 
-void NewProjectAudioProcessor::updateBufferPositions (juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& delayBuffer)
+void NewProjectAudioProcessor::swapResizedBuffer()
 {
-    auto bufferSize = buffer.getNumSamples();
-    auto delayBufferSize = delayBuffer.getNumSamples();
+    resizeDeferred = false;
+    
+    if (! delayBufferResizer.swapIfReady())
+        return;
+    
+    writePosition = (int) (samplesWritten.load() & delayBuffer.getMask());
+    
+    // a restored snapshot, with the loop that was playing out of it
+    if (delayBufferResizer.lastSwapWasOffered())
+    {
+        // the catch-up brought across what an old loop had left unwritten since it froze
+        if (looper.isFrozen())
+            delayBuffer.clearHistory (juce::jmax (restoredUpTo, looper.getFrozenAt()), samplesWritten);
+        
+        looper.restore (restoredLoop, restoredUpTo);
+        restoreInFlight = false;
+    }
+    
+    // a shorter buffer can't reach as far back, so don't glide down from a delay it no longer holds
+    auto longestDelay = (double) (delayBuffer.getNumSamples() - delayBuffer.getGuardSize());
+    
+    if (delayInSamplesSmoothed.getCurrentValue() > longestDelay)
+        delayInSamplesSmoothed.setCurrentAndTargetValue (longestDelay);
+}
 
-    writePosition += bufferSize;
-    writePosition %= delayBufferSize;
+void NewProjectAudioProcessor::handleTap (juce::int64 tapPosition)
+{
+    auto interval = (double) (tapPosition - lastTapPosition);
+    lastTapPosition = tapPosition;
+    
+    if (interval <= 0.0 || interval > maxTapIntervalSeconds * savedSampleRate)
+    {
+        numTapIntervals = 0; // the first tap of a new run
+        return;
+    }
+    
+    // the newest few intervals, oldest dropped first
+    if (numTapIntervals == maxTapIntervals)
+        std::copy (tapIntervals + 1, tapIntervals + maxTapIntervals, tapIntervals);
+    else
+        ++numTapIntervals;
+    
+    tapIntervals[numTapIntervals - 1] = interval;
+    
+    double sum = 0.0;
+    
+    for (int i = 0; i < numTapIntervals; ++i)
+        sum += tapIntervals[i];
+    
+    tappedDelayInSamples = sum / numTapIntervals;
+    delayLengthAtTap = getDelayLengthSeconds(); // the next block picks it up, unless tempo sync is on
+}
+
+int NewProjectAudioProcessor::getDelayBufferLengthFor (double maxDelaySeconds) const
+{
+    // the longest delay plus the guard, so the whole range of the parameter can be read
+    return (int) std::ceil (maxDelaySeconds * savedSampleRate) + maxBlockSize + FractionalDelayReader::maxReadSpan;
 }
 
 //==============================================================================
@@ -258,12 +1131,140 @@ void NewProjectAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
+    juce::MemoryOutputStream output (destData, false);
+    output.writeInt (stateMagic);
+    output.writeInt (stateFormatVersion);
+    
+    auto parameters = apvts.copyState();
+    parameters.setProperty ("version", parameterStateVersion, nullptr);
+    
+    // binary rather than XML, it's a fraction of the size and doesn't go through a string
+    writeStateSection (output, [&] (juce::OutputStream& section) { parameters.writeToStream (section); });
+    
+    writeStateSection (output, [&] (juce::OutputStream& section)
+    {
+        if (bufferSnapshotParameter->load() >= 0.5f)
+            writeBufferSnapshot (section);
+    });
 }
 
 void NewProjectAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+    juce::MemoryInputStream input (data, (size_t) juce::jmax (0, sizeInBytes), false);
+    
+    // not ours, or from a newer version that might mean something else by the same bytes
+    if (input.readInt() != stateMagic || input.readInt() > stateFormatVersion)
+        return;
+    
+    auto* bytes = static_cast<const char*> (data);
+    
+    // each section is read straight out of the host's data, without copying it first
+    auto readSection = [&input, bytes] () -> std::pair<const char*, size_t>
+    {
+        auto size = input.readInt64();
+        
+        if (size < 0 || size > input.getNumBytesRemaining())
+            return { nullptr, 0 };
+        
+        auto* start = bytes + input.getPosition();
+        input.skipNextBytes (size);
+        return { start, (size_t) size };
+    };
+    
+    auto [parameterData, parameterSize] = readSection();
+    auto parameters = juce::ValueTree::readFromData (parameterData, parameterSize);
+    
+    // version 1 is the first. a later one that changes the parameters upgrades older trees here.
+    if (parameters.hasType (apvts.state.getType()))
+        apvts.replaceState (parameters);
+    
+    auto [snapshotData, snapshotSize] = readSection();
+    
+    if (snapshotSize > 0)
+    {
+        const juce::ScopedLock sl (stateLock);
+        
+        // not prepared, it's kept as it is and streamed into the buffer when there is one
+        if (isPrepared)
+            restoreBufferSnapshot (snapshotData, snapshotSize);
+        else
+            pendingSnapshot.replaceAll (snapshotData, snapshotSize);
+    }
+    
+    postCommand ({ Command::Type::presetSwap });
+}
+
+void NewProjectAudioProcessor::writeStateSection (juce::OutputStream& output, const std::function<void (juce::OutputStream&)>& writeSection)
+{
+    // the length goes in front, filled in once the section's been written
+    auto sizePosition = output.getPosition();
+    output.writeInt64 (0);
+    
+    writeSection (output);
+    
+    auto endPosition = output.getPosition();
+    output.setPosition (sizePosition);
+    output.writeInt64 (endPosition - sizePosition - (juce::int64) sizeof (juce::int64));
+    output.setPosition (endPosition);
+}
+
+void NewProjectAudioProcessor::writeBufferSnapshot (juce::OutputStream& output)
+{
+    const juce::ScopedLock sl (stateLock);
+    
+    // restored but not prepared since, it's still the same bytes
+    if (! pendingSnapshot.isEmpty())
+    {
+        output.write (pendingSnapshot.getData(), pendingSnapshot.getSize());
+        return;
+    }
+    
+    // the audio thread may be writing meanwhile: the reader keeps the buffer from being swapped or freed, the snapshot
+    // takes care of what's overwritten as it goes. a frozen loop ends the history where it froze.
+    DelayRingResizer::ScopedReader reader (delayBufferResizer);
+    auto& view = reader.getView();
+    
+    if (view.numChannels == 0)
+        return;
+    
+    auto loop = looper.getPublishedState();
+    auto end = loop.frozen ? loop.frozenAt : samplesWritten.load();
+    auto* writeHead = isPrepared && ! loop.frozen ? &samplesWritten : nullptr;
+    
+    BufferSnapshot::write (output, view, end, view.getNumSamples(), savedSampleRate, loop, writeHead);
+}
+
+void NewProjectAudioProcessor::restoreBufferSnapshot (const void* data, size_t size)
+{
+    // one at a time, the loop that goes with it is handed over through restoredLoop
+    bool expected = false;
+    
+    if (! restoreInFlight.compare_exchange_strong (expected, true))
+        return;
+    
+    // the same shape as the current buffer, the resizer takes over from there if MAX_DELAY changed
+    auto ring = std::make_unique<DelayRing>();
+    
+    {
+        DelayRingResizer::ScopedReader reader (delayBufferResizer);
+        ring->setSize (reader.getView().numChannels, reader.getView().getNumSamples(), reader.getView().guardSize);
+    }
+    
+    auto upTo = samplesWritten.load();
+    BufferSnapshot::Header header;
+    
+    if (BufferSnapshot::read (data, size, *ring, upTo, savedSampleRate, header))
+    {
+        restoredLoop = header.loop;
+        restoredUpTo = upTo;
+        
+        if (delayBufferResizer.offer (std::move (ring), upTo))
+            return;
+    }
+    
+    restoreInFlight = false;
 }
 
 //==============================================================================
@@ -274,6 +1275,39 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 }
 
 //==============================================================================
+juce::StringArray NewProjectAudioProcessor::getModeNames()
+{
+    return { "Delay", "FDN", "Multi-tap", "Reverse", "Granular" };
+}
+
+juce::StringArray NewProjectAudioProcessor::getMaxDelayNames()
+{
+    return { "1 s", "2 s", "4 s", "8 s", "15 s", "30 s", "1 min", "2 min", "5 min" };
+}
+
+double NewProjectAudioProcessor::getMaxDelaySeconds (int index)
+{
+    static constexpr double seconds[] { 1.0, 2.0, 4.0, 8.0, 15.0, 30.0, 60.0, 120.0, 300.0 };
+    return seconds[juce::jlimit (0, (int) std::size (seconds) - 1, index)];
+}
+
+bool NewProjectAudioProcessor::usesLongDelayLength (int maxDelayIndex)
+{
+    // the 4 s buffer was the only one there was, DELAY_LENGTH's range is what it held
+    return getMaxDelaySeconds (maxDelayIndex) > std::ceil (maxShortDelaySeconds);
+}
+
+juce::String NewProjectAudioProcessor::getDelayLengthParameterID (int maxDelayIndex)
+{
+    return usesLongDelayLength (maxDelayIndex) ? "DELAY_LENGTH_LONG" : "DELAY_LENGTH";
+}
+
+float NewProjectAudioProcessor::getDelayLengthSeconds() const
+{
+    // no strings here, the audio thread calls it every block
+    return usesLongDelayLength ((int) maxDelayParameter->load()) ? longDelayLengthParameter->load() : delayLengthParameter->load();
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::createParameters()
 {
     // vector that contains parameter layout information
@@ -291,33 +1325,216 @@ juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::cr
     auto wetGainParameterID = juce::ParameterID { "WET_GAIN", 1 };
     params.push_back (std::make_unique<juce::AudioParameterFloat> (wetGainParameterID, "Wet_Gain", 0.0f, 1.0f, 0.5f));
     
-    // delay length
+    // delay length, the original parameter, used while MAX_DELAY is 4 s or less
     auto delayLengthParameterID = juce::ParameterID { "DELAY_LENGTH", 1 };
-    params.push_back (std::make_unique<juce::AudioParameterFloat> (delayLengthParameterID, "Delay_Length", 0.0f,  3.99f, 2.0f)); // TODO: initialize delay length parameter with delayBufferMaxTime parameter, instead of hardcoding it.
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (delayLengthParameterID, "Delay_Length", 0.0f, maxShortDelaySeconds, 2.0f));
+    
+    // the delay length for a longer MAX_DELAY. covers the longest one, skewed so the first few seconds get most of the
+    // travel, and the delay stops at MAX_DELAY.
+    auto longDelayLengthParameterID = juce::ParameterID { "DELAY_LENGTH_LONG", 2 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (longDelayLengthParameterID, "Delay_Length_Long", juce::NormalisableRange<float> (0.0f, (float) getMaxDelaySeconds (getMaxDelayNames().size() - 1), 0.0f, 0.3f), 2.0f));
+    
+    // how much delay memory to keep. changing it rebuilds the buffer in the background.
+    auto maxDelayParameterID = juce::ParameterID { "MAX_DELAY", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (maxDelayParameterID, "Max_Delay", getMaxDelayNames(), 2));
+    
+    // tempo sync, replaces the delay length with a note value at the host's tempo
+    auto syncParameterID = juce::ParameterID { "SYNC", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (syncParameterID, "Sync", false));
+    
+    auto syncNoteParameterID = juce::ParameterID { "SYNC_NOTE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (syncNoteParameterID, "Sync_Note", TempoSync::getNoteNames(), 4));
+    
+    auto syncModifierParameterID = juce::ParameterID { "SYNC_MODIFIER", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (syncModifierParameterID, "Sync_Modifier", TempoSync::getModifierNames(), 0));
+    
+    // drive on the echoes, oversampled so the clipping doesn't alias
+    auto saturationParameterID = juce::ParameterID { "SATURATION", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (saturationParameterID, "Saturation", false));
+    
+    auto saturationDriveParameterID = juce::ParameterID { "SATURATION_DRIVE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (saturationDriveParameterID, "Saturation_Drive", 0.0f, 24.0f, 6.0f));
+    
+    auto saturationOversamplingParameterID = juce::ParameterID { "SATURATION_OVERSAMPLING", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (saturationOversamplingParameterID, "Saturation_Oversampling", Saturator::getOversamplingNames(), 2));
+    
+    // how the echoes move between channels in delay mode
+    auto routingParameterID = juce::ParameterID { "ROUTING", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (routingParameterID, "Routing", ChannelRouter::getModeNames(), 0));
+    
+    auto routingAmountParameterID = juce::ParameterID { "ROUTING_AMOUNT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (routingAmountParameterID, "Routing_Amount", 0.0f, 1.0f, 1.0f));
+    
+    // an impulse response on the echoes in delay mode, loaded from a file. mix is how much of the echo goes through it.
+    auto convolutionParameterID = juce::ParameterID { "CONVOLUTION", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (convolutionParameterID, "Convolution", false));
+    
+    auto convolutionMixParameterID = juce::ParameterID { "CONVOLUTION_MIX", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (convolutionMixParameterID, "Convolution_Mix", 0.0f, 1.0f, 1.0f));
+    
+    // freeze loops LOOP_LENGTH seconds of the buffer, ending LOOP_OFFSET seconds before the moment it was frozen.
+    // overdub layers the input in, each pass scaling what was there by OVERDUB_DECAY.
+    auto loopLengthParameterID = juce::ParameterID { "LOOP_LENGTH", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (loopLengthParameterID, "Loop_Length", juce::NormalisableRange<float> (0.05f, 10.0f, 0.0f, 0.4f), 1.0f));
     
-//    std::cout << "delayBufferMaxTime=" << delayBufferMaxTime << std::endl;
+    auto loopOffsetParameterID = juce::ParameterID { "LOOP_OFFSET", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (loopOffsetParameterID, "Loop_Offset", juce::NormalisableRange<float> (0.0f, 10.0f, 0.0f, 0.4f), 0.0f));
+    
+    auto overdubParameterID = juce::ParameterID { "OVERDUB", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (overdubParameterID, "Overdub", false));
+    
+    auto overdubDecayParameterID = juce::ParameterID { "OVERDUB_DECAY", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (overdubDecayParameterID, "Overdub_Decay", 0.0f, 1.0f, 0.8f));
+    
+    // saves the delay buffer and the loop with the plugin state, so the tails and a frozen loop come back as they were
+    auto bufferSnapshotParameterID = juce::ParameterID { "BUFFER_SNAPSHOT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (bufferSnapshotParameterID, "Buffer_Snapshot", false));
+    
+    // how the read head interpolates between samples, "None" is the original whole-sample read
+    auto interpolationParameterID = juce::ParameterID { "INTERPOLATION", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (interpolationParameterID, "Interpolation", FractionalDelayReader::getTypeNames(), (int) InterpolationType::hermite));
+    
+    // what produces the wet signal
+    auto modeParameterID = juce::ParameterID { "MODE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (modeParameterID, "Mode", getModeNames(), (int) ProcessingMode::delay));
+    
+    // feedback delay network, only used in FDN mode
+    auto fdnLinesParameterID = juce::ParameterID { "FDN_LINES", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (fdnLinesParameterID, "FDN_Lines", FeedbackDelayNetwork::getLineCountNames(), 1));
+    
+    auto fdnMatrixParameterID = juce::ParameterID { "FDN_MATRIX", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (fdnMatrixParameterID, "FDN_Matrix", FeedbackDelayNetwork::getMatrixNames(), 0));
+    
+    auto fdnSizeParameterID = juce::ParameterID { "FDN_SIZE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (fdnSizeParameterID, "FDN_Size", juce::NormalisableRange<float> (0.01f, (float) FeedbackDelayNetwork::maxLineSeconds, 0.0f, 0.5f), 0.08f));
+    
+    auto fdnDecayParameterID = juce::ParameterID { "FDN_DECAY", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (fdnDecayParameterID, "FDN_Decay", juce::NormalisableRange<float> (0.1f, 20.0f, 0.0f, 0.4f), 2.0f));
+    
+    auto fdnDampingParameterID = juce::ParameterID { "FDN_DAMPING", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (fdnDampingParameterID, "FDN_Damping", 0.0f, 1.0f, 0.3f));
+    
+    // multi-tap delay, only used in Multi-tap mode. the last tap sits at the delay length.
+    auto tapCountParameterID = juce::ParameterID { "TAP_COUNT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterInt> (tapCountParameterID, "Tap_Count", 1, MultiTapDelay::maxNumTaps, 8));
+    
+    auto tapDecayParameterID = juce::ParameterID { "TAP_DECAY", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (tapDecayParameterID, "Tap_Decay", 0.0f, 1.0f, 0.8f));
+    
+    auto tapSpreadParameterID = juce::ParameterID { "TAP_SPREAD", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (tapSpreadParameterID, "Tap_Spread", 0.0f, 1.0f, 0.7f));
+    
+    // with TAP_EDIT on, the taps come from their own parameters instead of the pattern above, one set for each of
+    // them up to the most there can be. a tap's time is a fraction of the delay length, so they still follow tempo
+    // sync and tap tempo. the defaults are the pattern's own taps at the default count, the ones past it at the
+    // delay length.
+    auto tapEditParameterID = juce::ParameterID { "TAP_EDIT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (tapEditParameterID, "Tap_Edit", false));
+    
+    for (int t = 0; t < numEditableTaps; ++t)
+    {
+        auto id = "TAP_" + juce::String (t + 1);
+        auto name = "Tap_" + juce::String (t + 1);
+        
+        params.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { id + "_TIME", 1 }, name + "_Time", 0.0f, 1.0f, juce::jmin (1.0f, (float) (t + 1) / 8.0f)));
+        params.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { id + "_GAIN", 1 }, name + "_Gain", 0.0f, 1.0f, std::pow (0.8f, (float) t)));
+        params.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { id + "_PAN", 1 }, name + "_Pan", -1.0f, 1.0f, t % 2 == 0 ? -0.7f : 0.7f));
+    }
+    
+    // grains, only used in Granular mode: GRAIN_DENSITY grains of GRAIN_SIZE ms start every second, read around the delay length
+    // give or take GRAIN_SPRAY of it and shifted by GRAIN_PITCH semitones. Reverse mode's grains are the delay length.
+    auto grainSizeParameterID = juce::ParameterID { "GRAIN_SIZE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (grainSizeParameterID, "Grain_Size", juce::NormalisableRange<float> (10.0f, 500.0f, 0.0f, 0.5f), 80.0f));
+    
+    auto grainDensityParameterID = juce::ParameterID { "GRAIN_DENSITY", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (grainDensityParameterID, "Grain_Density", juce::NormalisableRange<float> (1.0f, 1000.0f, 0.0f, 0.3f), 25.0f));
+    
+    auto grainPitchParameterID = juce::ParameterID { "GRAIN_PITCH", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (grainPitchParameterID, "Grain_Pitch", -24.0f, 24.0f, 0.0f));
+    
+    auto grainSprayParameterID = juce::ParameterID { "GRAIN_SPRAY", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (grainSprayParameterID, "Grain_Spray", 0.0f, 1.0f, 0.3f));
+    
+    // shares the heavy per-channel work (convolution, oversampled saturation) out between worker threads
+    auto parallelParameterID = juce::ParameterID { "PARALLEL", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (parallelParameterID, "Parallel", false));
+    
+    // chorus, flanger or tape wow on the echoes in delay mode. the voices swing either side of the delay length,
+    // MOD_DEPTH is how much of the mode's swing they use and MOD_VOICES only counts for the chorus.
+    auto modulationParameterID = juce::ParameterID { "MODULATION", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (modulationParameterID, "Modulation", ModulatedDelay::getModeNames(), (int) ModulatedDelay::Mode::off));
+    
+    auto modulationShapeParameterID = juce::ParameterID { "MOD_SHAPE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (modulationShapeParameterID, "Mod_Shape", LfoBank::getShapeNames(), (int) LfoBank::Shape::sine));
+    
+    auto modulationRateParameterID = juce::ParameterID { "MOD_RATE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (modulationRateParameterID, "Mod_Rate", juce::NormalisableRange<float> (0.05f, 10.0f, 0.0f, 0.4f), 0.8f));
+    
+    auto modulationDepthParameterID = juce::ParameterID { "MOD_DEPTH", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (modulationDepthParameterID, "Mod_Depth", 0.0f, 1.0f, 0.5f));
+    
+    auto modulationVoicesParameterID = juce::ParameterID { "MOD_VOICES", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterInt> (modulationVoicesParameterID, "Mod_Voices", 1, ModulatedDelay::maxNumVoices, 3));
+    
+    // shimmer: the echoes in delay mode are shifted by PITCH_SHIFT semitones as they're read, so each repeat goes up (or down)
+    // again. PITCH_WINDOW trades smoothness for latency, the echoes are read half of it sooner to stay in time.
+    // ignored while a MODULATION mode is on.
+    auto pitchParameterID = juce::ParameterID { "PITCH", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (pitchParameterID, "Pitch", false));
+    
+    auto pitchShiftParameterID = juce::ParameterID { "PITCH_SHIFT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (pitchShiftParameterID, "Pitch_Shift", -24.0f, 24.0f, 12.0f));
+    
+    auto pitchWindowParameterID = juce::ParameterID { "PITCH_WINDOW", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (pitchWindowParameterID, "Pitch_Window", 10.0f, 100.0f, 40.0f));
+    
+    // low cut, high cut and tilt on the echoes in delay mode before they're fed back, so each repeat is darker than the last.
+    // the tilt is in dB from the lows to the highs, pivoting around 1 kHz.
+    auto filterParameterID = juce::ParameterID { "FILTER", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (filterParameterID, "Filter", false));
+    
+    auto filterLowCutParameterID = juce::ParameterID { "FILTER_LOW_CUT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (filterLowCutParameterID, "Filter_Low_Cut", juce::NormalisableRange<float> (20.0f, 2000.0f, 0.0f, 0.3f), 80.0f));
+    
+    auto filterHighCutParameterID = juce::ParameterID { "FILTER_HIGH_CUT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (filterHighCutParameterID, "Filter_High_Cut", juce::NormalisableRange<float> (500.0f, 20000.0f, 0.0f, 0.3f), 6000.0f));
+    
+    auto filterTiltParameterID = juce::ParameterID { "FILTER_TILT", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (filterTiltParameterID, "Filter_Tilt", -12.0f, 12.0f, 0.0f));
+    
+    // ducking turns the echoes in delay mode down while DUCK_SOURCE is loud: the input, or the sidechain bus when it's enabled.
+    // anything over DUCK_THRESHOLD is brought back down to it, never by more than DUCK_DEPTH. the feedback isn't ducked.
+    auto duckParameterID = juce::ParameterID { "DUCK", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterBool> (duckParameterID, "Duck", false));
+    
+    auto duckSourceParameterID = juce::ParameterID { "DUCK_SOURCE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (duckSourceParameterID, "Duck_Source", Ducker::getSourceNames(), (int) Ducker::Source::input));
+    
+    auto duckDetectorParameterID = juce::ParameterID { "DUCK_DETECTOR", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (duckDetectorParameterID, "Duck_Detector", Ducker::getDetectorNames(), (int) Ducker::Detector::peak));
+    
+    auto duckThresholdParameterID = juce::ParameterID { "DUCK_THRESHOLD", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (duckThresholdParameterID, "Duck_Threshold", -60.0f, 0.0f, -30.0f));
+    
+    auto duckDepthParameterID = juce::ParameterID { "DUCK_DEPTH", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (duckDepthParameterID, "Duck_Depth", -48.0f, 0.0f, -12.0f));
+    
+    auto duckAttackParameterID = juce::ParameterID { "DUCK_ATTACK", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (duckAttackParameterID, "Duck_Attack", juce::NormalisableRange<float> (0.1f, 100.0f, 0.0f, 0.4f), 5.0f));
+    
+    auto duckReleaseParameterID = juce::ParameterID { "DUCK_RELEASE", 1 };
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (duckReleaseParameterID, "Duck_Release", juce::NormalisableRange<float> (10.0f, 2000.0f, 0.0f, 0.4f), 250.0f));
     
     // the return type is a vector
     return { params.begin(), params.end() };
 }
 
-std::tuple <float, float, bool, float> NewProjectAudioProcessor::getParameters()
+std::tuple <float, float, float> NewProjectAudioProcessor::getParameters()
 {
-    // get the value from the main gain slider
-    auto mainGainPtr = apvts.getRawParameterValue ("GAIN"); // returns a std::atomic<float>* wtf is that?
-    // need to dereference and call load() to access the value
-    float mainGain = mainGainPtr->load();
-    
-    // wet gain
-    auto wetGainPtr = apvts.getRawParameterValue ("WET_GAIN");
-    float wetGain = wetGainPtr->load();
-    
-    // clear buffer (even though its technically not a parameter)
-    bool clearBuffer = this->clearBufferFlag;
-    
-    // delay length
-    auto delayLengthPtr = apvts.getRawParameterValue ("DELAY_LENGTH");
-    float delayLength = delayLengthPtr->load();
+    // the parameter pointers are cached in the constructor, so this is just a few atomic loads
+    float mainGain = gainParameter->load();
+    float wetGain = wetGainParameter->load();
+    float delayLength = getDelayLengthSeconds();
     
-    return std::make_tuple(mainGain, wetGain, clearBuffer, delayLength);
+    return std::make_tuple(mainGain, wetGain, delayLength);
 }
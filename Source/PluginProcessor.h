@@ -9,6 +9,36 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DelayRing.h"
+#include "DelayRingResizer.h"
+#include "FractionalDelayReader.h"
+#include "FeedbackDelayNetwork.h"
+#include "MultiTapDelay.h"
+#include "TempoSync.h"
+#include "Saturator.h"
+#include "ChannelRouter.h"
+#include "RealtimeProfiler.h"
+#include "RealtimeTrap.h"
+#include "CommandQueue.h"
+#include "ImpulseLoader.h"
+#include "Looper.h"
+#include "BufferSnapshot.h"
+#include "WorkerPool.h"
+#include "ModulatedDelay.h"
+#include "FeedbackFilter.h"
+#include "Ducker.h"
+#include "GranularDelay.h"
+#include "PitchShifter.h"
+
+// the order matches the choices of the MODE parameter
+enum class ProcessingMode
+{
+    delay = 0,  // the single circular buffer echo
+    fdn,        // feedback delay network
+    multiTap,   // several taps read out of the circular buffer, no feedback
+    reverse,    // the buffer played backwards a delay time at a time, no feedback
+    granular    // short grains read out of the buffer, scattered and pitched, no feedback
+};
 
 //==============================================================================
 /**
@@ -57,28 +87,258 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
     
     //==============================================================================
+    static juce::StringArray getModeNames(); // choices of the MODE parameter, in ProcessingMode order
+    static juce::StringArray getMaxDelayNames(); // choices of the MAX_DELAY parameter
+    static double getMaxDelaySeconds (int index);
+    
+    // DELAY_LENGTH keeps its original range, so sessions and automation from before MAX_DELAY still mean the same
+    // delay. a MAX_DELAY beyond that range uses DELAY_LENGTH_LONG instead, which reaches the longest one.
+    static constexpr float maxShortDelaySeconds = 3.99f;
+    static bool usesLongDelayLength (int maxDelayIndex);
+    static juce::String getDelayLengthParameterID (int maxDelayIndex);
+    
+    // any thread. the delay length parameter in use for the current MAX_DELAY, in seconds.
+    float getDelayLengthSeconds() const;
+    
+    // any layout with the same channels in and out, up to 7.1.4 or third order ambisonics, and a mono or stereo sidechain
+    static constexpr int maxNumChannels = FractionalDelayReader::maxNumChannels;
+    
+    // how long the gains and the delay time take to glide to a new value
+    static constexpr double gainRampSeconds {0.02};
+    static constexpr double delayRampSeconds {0.1};
+    
+    // every tap can be placed by hand with TAP_n_TIME, TAP_n_GAIN and TAP_n_PAN, n counting from 1
+    static constexpr int numEditableTaps = MultiTapDelay::maxNumTaps;
+    
+    // per-stage timings of processBlock, read by the editor and the headless runner
+    RealtimeProfiler& getProfiler() { return profiler; }
+    
+    // any thread. whether a loop is playing, as of the last block, so the editor's freeze button can follow it.
+    bool isLoopFrozen() const { return looper.getPublishedState().frozen; }
+    
     juce::AudioProcessorValueTreeState apvts; // contains the parameters of the plugin
     
-    // stores whether the delay buffer should be cleared or not
-    bool clearBufferFlag;
+    // any thread. the command takes effect at its sample position, or at the start of the next block if that's
+    // already gone. returns false if the queue is full.
+    bool postCommand (const Command& command) { return commands.push (command); }
+    
+    // where the audio thread's sample clock is about now, extrapolated from the start of the last block
+    juce::int64 getSamplePositionNow() const;
+    
+    // message thread. the convolution picks the new impulse response up once it's been loaded in the background.
+    void loadImpulseResponse (const juce::File& file) { impulseLoader.load (file); }
+    juce::File getImpulseResponseFile() const { return impulseLoader.getFile(); }
+    bool isLoadingImpulseResponse() const { return impulseLoader.isLoading(); }
 
 private:
     // dsp functions and members
+    void processSubBlock (juce::AudioBuffer<float>& buffer);
+    
+    // whether the echoes are read into their own buffer and processed there before they're fed back, rather than
+    // going round the plain delay, the looper or one of the other modes
+    bool usesWetPath() const;
     void fillDelayBuffer (juce::AudioBuffer<float>& buffer, int channel);
-    void readDelayBuffer (juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& delayBuffer, int channel, float wetGain, int readPositionOffset);
-    void updateBufferPositions (juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& delayBuffer);
+    void feedBackDelayBuffer (float* ringChannel, const float* input, const float* wet, int numSamples); // writes input plus echo, any thread
+    void readDelayBuffer (juce::AudioBuffer<float>& buffer, DelayRing& delayBuffer, int numChannels, bool isRamping);
+    void readModulatedDelay (float* destination, int channel, int numSamples, bool isRamping); // any thread, one channel each
+    void readPitchShifted (float* destination, int channel, int numSamples, bool isRamping); // the same, through the pitch shifter
+    void applyMainGain (juce::AudioBuffer<float>& buffer, int channel, bool isRamping);
+    
+    // the wet path's read, convolution, saturation and mix with one channel per task on the worker pool.
+    // duckGains scales the echoes into the output (not the feed), or is nullptr.
+    void processWetChannelsInParallel (WorkerPool& pool, juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& wet,
+                                       const juce::AudioBuffer<float>& feed, const float* duckGains, bool delayIsRamping);
+    
+    // the plain delay: the read, the feedback write and the main gain fused into one pass over every channel
+    void processDelayLines (juce::AudioBuffer<float>& buffer, int numChannels, bool delayIsRamping, bool mainGainIsRamping, double shortestDelay);
+    void updateBufferPositions (juce::AudioBuffer<float>& buffer, DelayRing& delayBuffer);
+    
+    // commands from the other threads, applied between sub-blocks
+    void collectCommands();
+    void applyDueCommands (juce::AudioBuffer<float>& buffer, int start, juce::int64 position);
+    void applyCommand (const Command& command, juce::AudioBuffer<float>& buffer, int start, juce::int64 position);
+    void swapResizedBuffer();
+    void handleTap (juce::int64 tapPosition);
+    
+    // the plugin state: a small header, then length-prefixed sections for the parameters and the buffer snapshot
+    static constexpr int stateMagic = (int) juce::ByteOrder::makeInt ('D', 'L', 'Y', 'S');
+    static constexpr int stateFormatVersion = 1;
+    static constexpr int parameterStateVersion = 1; // stored in the parameter tree, older trees are upgraded on load
+    static void writeStateSection (juce::OutputStream& output, const std::function<void (juce::OutputStream&)>& writeSection);
+    void writeBufferSnapshot (juce::OutputStream& output);
+    void restoreBufferSnapshot (const void* data, size_t size);
+    
+    // a snapshot set before prepareToPlay is kept compressed and streamed into the new buffer there
+    juce::CriticalSection stateLock;
+    juce::MemoryBlock pendingSnapshot;
+    std::atomic<bool> isPrepared {false};
+    
+    // a snapshot set while playing goes into a new buffer that's swapped in like a resized one, the loop with it
+    std::atomic<bool> restoreInFlight {false};
+    Looper::State restoredLoop;
+    juce::int64 restoredUpTo {0};
+    
+    CommandQueue commands;
+    static constexpr int maxPendingCommands = 64;
+    Command pendingCommands[maxPendingCommands]; // popped but not due yet, in sample order
+    int numPendingCommands {0};
     
-    juce::AudioBuffer<float> delayBuffer; // this is the circular buffer
-    int writePosition {0}; // write position in the circular buffer
+    // the sample clock at the start of the last block, for getSamplePositionNow()
+    std::atomic<juce::int64> blockStartSample {0};
+    std::atomic<juce::int64> blockStartTicks {0};
+    
+    // freeze: loops a region of the delay buffer, nothing is written or fed back meanwhile
+    Looper looper;
+    bool resizeDeferred {false}; // a resized buffer came in while frozen, it's swapped in on release
+    
+    // tap tempo: the average of the last few intervals between taps, until the delay length is moved
+    static constexpr int maxTapIntervals = 4;
+    static constexpr double maxTapIntervalSeconds = 3.0; // taps further apart start over
+    juce::int64 lastTapPosition {-1};
+    double tapIntervals[maxTapIntervals] {};
+    int numTapIntervals {0};
+    double tappedDelayInSamples {0.0};
+    float delayLengthAtTap {0.0f};
+    
+    DelayRing delayBuffer; // this is the circular buffer, a power of two long so it wraps with a mask
+    int writePosition {0}; // write position in the circular buffer, always masked
+    std::atomic<juce::int64> samplesWritten {0}; // absolute write position, masked it gives writePosition
+    
+    // the buffer follows the MAX_DELAY parameter. a new one is built off the audio thread and swapped in between blocks.
+    DelayRingResizer delayBufferResizer { delayBuffer, samplesWritten };
+    int getDelayBufferLengthFor (double maxDelaySeconds) const;
     
-    int delayBufferLength {0};
-    float delayBufferMaxTime {4.0f}; // x * sample_rate = x-second long buffer
     double savedSampleRate {0.0};
     
+    // the delay time and impulse response length of the last block, for getTailLengthSeconds() on the host's thread
+    std::atomic<double> tailDelaySeconds {0.0};
+    std::atomic<double> tailImpulseSeconds {0.0};
+    
+    RealtimeProfiler profiler;
+    
+    FractionalDelayReader delayReader; // interpolates between samples for fractional delay times
+    TempoSync tempoSync; // the delay time from a note value, when SYNC is on
+    
+    // drives the echoes in delay mode before they're fed back, so each repeat is saturated again
+    Saturator saturator;
+    juce::AudioBuffer<float> wetBuffer; // the echoes of a sub-block on their own, for the saturator and the router
+    bool saturationEnabled {false}; // read from the SATURATION parameter once per block
+    
+    // moves the echoes between channels in delay mode before they're fed back
+    ChannelRouter channelRouter;
+    juce::AudioBuffer<float> feedBuffer; // what's written into the delay lines, when that isn't just the input (ping-pong)
+    
+    // passes the echoes in delay mode through a loaded impulse response before they're fed back
+    ImpulseLoader impulseLoader;
+    bool convolutionEnabled {false}; // CONVOLUTION is on and an impulse response has loaded
+    
+    // chorus, flanger or wow on the echoes in delay mode, the read heads swinging around the delay time
+    ModulatedDelay modulatedDelay;
+    
+    // shifts the echoes in delay mode as they're read, so each repeat is shifted again. the modulation has the read
+    // to itself when it's on.
+    PitchShifter pitchShifter;
+    bool pitchShiftEnabled {false}; // PITCH is on, in delay mode with no modulation
+    
+    // darkens and thins the echoes in delay mode before they're fed back
+    FeedbackFilter feedbackFilter;
+    bool filterEnabled {false}; // read from the FILTER parameter once per block
+    
+    // turns the echoes in delay mode down while the input or the sidechain is loud. only what's heard is ducked,
+    // the feedback carries on at full level.
+    Ducker ducker;
+    bool duckingEnabled {false}; // read from the DUCK parameter once per block
+    int sidechainChannel {0}; // where the sidechain bus starts in processBlock's buffer
+    int numSidechainChannels {0}; // 0 while it's disabled, or when DUCK_SOURCE is the input
+    
+    // with PARALLEL on, the wet path's per-channel work is shared with the worker threads. one pool for every
+    // instance in the process, sized to the machine, made when the first one turns PARALLEL on.
+    WorkerPoolHandle workerPool;
+    bool parallelEnabled {false};
+    static constexpr int minParallelBlockSize = 64; // below this the hand-over costs more than it saves
+    
+    // per-sample ramps towards the latest parameter values, so automation doesn't step once per block
+    juce::SmoothedValue<float> mainGainSmoothed;
+    juce::SmoothedValue<float> wetGainSmoothed;
+    juce::SmoothedValue<double> delayInSamplesSmoothed;
+    
+    // a sub-block's worth of ramp values, filled once and shared by every channel
+    juce::AudioBuffer<float> parameterRamps; // channel 0: main gain, channel 1: wet gain
+    juce::HeapBlock<double> delayRamp;
+    int maxBlockSize {0};
+    
+    ProcessingMode mode {ProcessingMode::delay}; // read from the MODE parameter once per block
+    FeedbackDelayNetwork fdn;
+    
+    MultiTapDelay multiTap;
+    void updateTaps(); // the taps are read relative to writePosition, so this runs once per sub-block
+    
+    GranularDelay granular; // reverse and granular modes
+    
     // parameter functions and members
     // function for returning the parameter layout
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
-    std::tuple <float, float, bool, float> getParameters();
+    std::tuple <float, float, float> getParameters();
+    
+    // raw parameter values, looked up once in the constructor instead of by name on every block
+    std::atomic<float>* gainParameter {nullptr};
+    std::atomic<float>* wetGainParameter {nullptr};
+    std::atomic<float>* delayLengthParameter {nullptr};
+    std::atomic<float>* longDelayLengthParameter {nullptr};
+    std::atomic<float>* maxDelayParameter {nullptr};
+    std::atomic<float>* syncParameter {nullptr};
+    std::atomic<float>* syncNoteParameter {nullptr};
+    std::atomic<float>* syncModifierParameter {nullptr};
+    std::atomic<float>* saturationParameter {nullptr};
+    std::atomic<float>* saturationDriveParameter {nullptr};
+    std::atomic<float>* saturationOversamplingParameter {nullptr};
+    std::atomic<float>* routingParameter {nullptr};
+    std::atomic<float>* routingAmountParameter {nullptr};
+    std::atomic<float>* convolutionParameter {nullptr};
+    std::atomic<float>* convolutionMixParameter {nullptr};
+    std::atomic<float>* loopLengthParameter {nullptr};
+    std::atomic<float>* loopOffsetParameter {nullptr};
+    std::atomic<float>* overdubParameter {nullptr};
+    std::atomic<float>* overdubDecayParameter {nullptr};
+    std::atomic<float>* bufferSnapshotParameter {nullptr};
+    std::atomic<float>* interpolationParameter {nullptr};
+    std::atomic<float>* modeParameter {nullptr};
+    std::atomic<float>* fdnLinesParameter {nullptr};
+    std::atomic<float>* fdnMatrixParameter {nullptr};
+    std::atomic<float>* fdnSizeParameter {nullptr};
+    std::atomic<float>* fdnDecayParameter {nullptr};
+    std::atomic<float>* fdnDampingParameter {nullptr};
+    std::atomic<float>* tapCountParameter {nullptr};
+    std::atomic<float>* tapDecayParameter {nullptr};
+    std::atomic<float>* tapSpreadParameter {nullptr};
+    std::atomic<float>* tapEditParameter {nullptr};
+    std::atomic<float>* tapTimeParameters[numEditableTaps] {};
+    std::atomic<float>* tapGainParameters[numEditableTaps] {};
+    std::atomic<float>* tapPanParameters[numEditableTaps] {};
+    std::atomic<float>* parallelParameter {nullptr};
+    std::atomic<float>* modulationParameter {nullptr};
+    std::atomic<float>* modulationShapeParameter {nullptr};
+    std::atomic<float>* modulationRateParameter {nullptr};
+    std::atomic<float>* modulationDepthParameter {nullptr};
+    std::atomic<float>* modulationVoicesParameter {nullptr};
+    std::atomic<float>* filterParameter {nullptr};
+    std::atomic<float>* filterLowCutParameter {nullptr};
+    std::atomic<float>* filterHighCutParameter {nullptr};
+    std::atomic<float>* filterTiltParameter {nullptr};
+    std::atomic<float>* duckParameter {nullptr};
+    std::atomic<float>* duckSourceParameter {nullptr};
+    std::atomic<float>* duckDetectorParameter {nullptr};
+    std::atomic<float>* duckThresholdParameter {nullptr};
+    std::atomic<float>* duckDepthParameter {nullptr};
+    std::atomic<float>* duckAttackParameter {nullptr};
+    std::atomic<float>* duckReleaseParameter {nullptr};
+    std::atomic<float>* grainSizeParameter {nullptr};
+    std::atomic<float>* grainDensityParameter {nullptr};
+    std::atomic<float>* grainPitchParameter {nullptr};
+    std::atomic<float>* grainSprayParameter {nullptr};
+    std::atomic<float>* pitchParameter {nullptr};
+    std::atomic<float>* pitchShiftParameter {nullptr};
+    std::atomic<float>* pitchWindowParameter {nullptr};
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NewProjectAudioProcessor)
 };
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    RealtimeProfiler.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeProfiler.h"
+
+//==============================================================================
+RealtimeProfiler::RealtimeProfiler()
+    : juce::Thread ("Realtime profiler"),
+      fifoRecords ((size_t) fifoSize),
+      window ((size_t) windowSize),
+      scratch ((size_t) windowSize)
+{
+    secondsPerTick = juce::Time::highResolutionTicksToSeconds (1);
+}
+
+RealtimeProfiler::~RealtimeProfiler()
+{
+    stopThread (1000);
+}
+
+juce::StringArray RealtimeProfiler::getStageNames()
+{
+    return { "parameters", "fill", "read", "feedback", "gain", "total" };
+}
+
+void RealtimeProfiler::prepare (double newSampleRate)
+{
+    stop();
+
+    sampleRate = newSampleRate;
+    fifo.reset();
+    droppedBlocks = 0;
+    windowWritePosition = 0;
+    windowCount = 0;
+    numBlocks = 0;
+    deadlineMisses = 0;
+
+    const juce::SpinLock::ScopedLockType lock (snapshotLock);
+    snapshot = {};
+}
+
+void RealtimeProfiler::start()
+{
+    stop();
+    startThread();
+}
+
+void RealtimeProfiler::stop()
+{
+    stopThread (1000);
+
+    // the audio thread has stopped too, so pick up the last few blocks
+    collect();
+}
+
+void RealtimeProfiler::collect()
+{
+    jassert (! isThreadRunning()); // the FIFO only has room for one reader
+
+    drain();
+    aggregate();
+}
+
+void RealtimeProfiler::beginBlock (int numSamples)
+{
+    std::fill (std::begin (current.stageTicks), std::end (current.stageTicks), (juce::int64) 0);
+    current.numSamples = numSamples;
+
+    blockStartTicks = lastLapTicks = juce::Time::getHighResolutionTicks();
+}
+
+void RealtimeProfiler::lap (Stage stage)
+{
+    auto now = juce::Time::getHighResolutionTicks();
+    current.stageTicks[(int) stage] += now - lastLapTicks;
+    lastLapTicks = now;
+}
+
+void RealtimeProfiler::endBlock()
+{
+    current.stageTicks[(int) Stage::total] = juce::Time::getHighResolutionTicks() - blockStartTicks;
+
+    // never wait for the background thread, just count what didn't fit
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        fifoRecords[(size_t) scope.startIndex1] = current;
+    else
+        droppedBlocks.fetch_add (1, std::memory_order_relaxed);
+}
+
+RealtimeProfiler::Snapshot RealtimeProfiler::getSnapshot() const
+{
+    const juce::SpinLock::ScopedLockType lock (snapshotLock);
+    return snapshot;
+}
+
+void RealtimeProfiler::run()
+{
+    while (! threadShouldExit())
+    {
+        drain();
+        aggregate();
+        wait (pollIntervalMs);
+    }
+}
+
+void RealtimeProfiler::drain()
+{
+    const auto scope = fifo.read (fifo.getNumReady());
+
+    auto take = [this] (int start, int count)
+    {
+        for (int i = start; i < start + count; ++i)
+        {
+            auto& record = fifoRecords[(size_t) i];
+            auto blockSeconds = (double) record.stageTicks[(int) Stage::total] * secondsPerTick;
+
+            if (blockSeconds > (double) record.numSamples / sampleRate)
+                ++deadlineMisses;
+
+            window[(size_t) windowWritePosition] = record;
+            windowWritePosition = (windowWritePosition + 1) % windowSize;
+            windowCount = juce::jmin (windowCount + 1, windowSize);
+            ++numBlocks;
+        }
+    };
+
+    take (scope.startIndex1, scope.blockSize1);
+    take (scope.startIndex2, scope.blockSize2);
+}
+
+void RealtimeProfiler::aggregate()
+{
+    Snapshot newSnapshot;
+    newSnapshot.numBlocks = numBlocks;
+    newSnapshot.deadlineMisses = deadlineMisses;
+    newSnapshot.droppedBlocks = droppedBlocks.load (std::memory_order_relaxed);
+    newSnapshot.windowSize = windowCount;
+
+    if (windowCount > 0)
+    {
+        auto* values = scratch.data();
+        auto end = values + windowCount;
+        auto p50Index = (windowCount - 1) / 2;
+        auto p99Index = (windowCount - 1) * 99 / 100;
+
+        // nth_element for p50 leaves everything above it in the upper part, which is all p99 needs to search
+        auto percentiles = [&] (double& p50, double& p99, double& max)
+        {
+            std::nth_element (values, values + p50Index, end);
+            p50 = values[p50Index];
+            std::nth_element (values + p50Index, values + p99Index, end);
+            p99 = values[p99Index];
+            max = *std::max_element (values + p99Index, end);
+        };
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            for (int i = 0; i < windowCount; ++i)
+                values[i] = (double) window[(size_t) i].stageTicks[stage] * secondsPerTick * 1.0e6;
+
+            auto& stats = newSnapshot.stages[stage];
+            percentiles (stats.p50, stats.p99, stats.max);
+        }
+
+        // load is per block, a long block at the same time isn't as close to its deadline as a short one
+        for (int i = 0; i < windowCount; ++i)
+        {
+            auto& record = window[(size_t) i];
+            values[i] = 100.0 * (double) record.stageTicks[(int) Stage::total] * secondsPerTick * sampleRate / juce::jmax (1, record.numSamples);
+        }
+
+        percentiles (newSnapshot.loadP50, newSnapshot.loadP99, newSnapshot.loadMax);
+    }
+
+    const juce::SpinLock::ScopedLockType lock (snapshotLock);
+    snapshot = newSnapshot;
+}
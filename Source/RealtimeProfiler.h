@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    RealtimeProfiler.h
+    Times each stage of processBlock() and turns the timings into latency
+    percentiles and deadline misses on a background thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The audio thread only reads the high resolution clock and adds up ticks
+    per stage. At the end of each block the totals go into a single-producer
+    single-consumer FIFO (a preallocated array behind an AbstractFifo), and if
+    the FIFO is full the block is counted as dropped rather than waited for.
+
+    A background thread drains the FIFO into a window of the most recent
+    blocks, works out p50, p99 and max per stage plus the share of the
+    block's duration spent in it, and publishes that as a Snapshot. Only the
+    background thread and readers of the snapshot (the editor, the headless
+    runner) ever take the snapshot's lock.
+*/
+class RealtimeProfiler : private juce::Thread
+{
+public:
+    // the order the stages appear in the editor and the exports
+    enum class Stage
+    {
+        parameters = 0, // reading parameters and building the ramps
+        fill,           // writing into the delay buffer
+        read,           // reading the echoes back (or running the FDN / multi-tap engine)
+        feedback,       // routing and saturating the echoes
+        gain,           // the main gain
+        total,          // the whole block, including anything not timed above
+        numStages
+    };
+
+    static constexpr int numStages = (int) Stage::numStages;
+
+    struct StageStats
+    {
+        double p50 {0.0}, p99 {0.0}, max {0.0}; // microseconds
+    };
+
+    struct Snapshot
+    {
+        StageStats stages[numStages];
+        double loadP50 {0.0}, loadP99 {0.0}, loadMax {0.0}; // total time as a percentage of the block's duration
+        juce::int64 numBlocks {0};      // since prepare()
+        juce::int64 deadlineMisses {0}; // blocks that took longer than they last
+        juce::int64 droppedBlocks {0};  // blocks the FIFO had no room for
+        int windowSize {0};             // blocks the percentiles are taken over
+    };
+
+    RealtimeProfiler();
+    ~RealtimeProfiler() override;
+
+    static juce::StringArray getStageNames();
+
+    // message thread, while the audio thread isn't running
+    void prepare (double sampleRate);
+    void start();
+    void stop(); // also drains whatever is left in the FIFO into the snapshot
+    bool isRunning() const { return isThreadRunning(); }
+
+    // drains and aggregates on the calling thread, for offline rendering where the background thread isn't started
+    // and blocks come far faster than it would keep up with
+    void collect();
+
+    // audio thread
+    void beginBlock (int numSamples);
+    void lap (Stage stage); // charges the time since the last lap (or beginBlock) to stage
+    void endBlock();
+
+    // any thread but the audio thread
+    Snapshot getSnapshot() const;
+
+private:
+    struct BlockRecord
+    {
+        juce::int64 stageTicks[numStages];
+        int numSamples;
+    };
+
+    void run() override;
+    void drain();
+    void aggregate();
+
+    static constexpr int fifoSize = 1024;
+    static constexpr int windowSize = 4096;
+    static constexpr int pollIntervalMs = 100;
+
+    double sampleRate {44100.0};
+    double secondsPerTick {0.0};
+
+    // audio thread state
+    BlockRecord current {};
+    juce::int64 blockStartTicks {0}, lastLapTicks {0};
+
+    juce::AbstractFifo fifo { fifoSize };
+    std::vector<BlockRecord> fifoRecords;
+    std::atomic<juce::int64> droppedBlocks {0};
+
+    // background thread state
+    std::vector<BlockRecord> window;
+    int windowWritePosition {0}, windowCount {0};
+    juce::int64 numBlocks {0}, deadlineMisses {0};
+    std::vector<double> scratch;
+
+    mutable juce::SpinLock snapshotLock;
+    Snapshot snapshot;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeProfiler)
+};
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    RealtimeTrap.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeTrap.h"
+
+#if DELAY_REALTIME_TRAP && JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+//==============================================================================
+namespace
+{
+    thread_local int audioThreadDepth = 0;
+    std::atomic<juce::int64> numAllocations {0};
+    std::atomic<juce::int64> numLocks {0};
+
+   #if DELAY_REALTIME_TRAP
+    void report (std::atomic<juce::int64>& counter) noexcept
+    {
+        counter.fetch_add (1, std::memory_order_relaxed);
+
+        // the assertion's logging allocates, so leave the audio thread while it runs
+        auto depth = audioThreadDepth;
+        audioThreadDepth = 0;
+        jassertfalse; // allocating or locking on the audio thread, see the call stack
+        audioThreadDepth = depth;
+    }
+
+    void* allocate (std::size_t size) noexcept
+    {
+        if (audioThreadDepth > 0)
+            report (numAllocations);
+
+        return std::malloc (size > 0 ? size : 1);
+    }
+
+    void release (void* p) noexcept
+    {
+        if (p != nullptr && audioThreadDepth > 0)
+            report (numAllocations);
+
+        std::free (p);
+    }
+   #endif
+}
+
+RealtimeTrap::ScopedAudioThread::ScopedAudioThread() noexcept   { ++audioThreadDepth; }
+RealtimeTrap::ScopedAudioThread::~ScopedAudioThread() noexcept  { --audioThreadDepth; }
+
+bool RealtimeTrap::isEnabled() noexcept                 { return DELAY_REALTIME_TRAP != 0; }
+juce::int64 RealtimeTrap::getNumAllocations() noexcept  { return numAllocations.load (std::memory_order_relaxed); }
+juce::int64 RealtimeTrap::getNumLocks() noexcept        { return numLocks.load (std::memory_order_relaxed); }
+
+//==============================================================================
+#if DELAY_REALTIME_TRAP
+
+void* operator new (std::size_t size)
+{
+    if (auto* p = allocate (size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                                  { return operator new (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept    { return allocate (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept  { return allocate (size); }
+
+void operator delete (void* p) noexcept                                  { release (p); }
+void operator delete[] (void* p) noexcept                                { release (p); }
+void operator delete (void* p, std::size_t) noexcept                     { release (p); }
+void operator delete[] (void* p, std::size_t) noexcept                   { release (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept           { release (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept         { release (p); }
+
+ #if JUCE_LINUX
+// interposed over libpthread's, which is looked up the first time through. std::mutex and CriticalSection both end up here.
+extern "C" int pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+    using LockFunction = int (*) (pthread_mutex_t*);
+    static LockFunction realLock = nullptr;
+
+    if (realLock == nullptr)
+        realLock = reinterpret_cast<LockFunction> (dlsym (RTLD_NEXT, "pthread_mutex_lock"));
+
+    if (audioThreadDepth > 0)
+        report (numLocks);
+
+    return realLock (mutex);
+}
+ #endif
+
+#endif
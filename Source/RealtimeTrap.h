@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    RealtimeTrap.h
+    Debug-only detection of allocations and locks on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// set DELAY_REALTIME_TRAP=1 in a debug configuration's preprocessor definitions to turn it on
+#ifndef DELAY_REALTIME_TRAP
+ #define DELAY_REALTIME_TRAP 0
+#endif
+
+//==============================================================================
+/**
+    With the trap compiled in, the global operator new and delete (and, on
+    Linux, pthread_mutex_lock) are replaced by versions that check whether
+    the calling thread is inside a ScopedAudioThread. If it is, the call is
+    counted and asserts, then goes ahead as usual so the run can carry on.
+
+    Without DELAY_REALTIME_TRAP nothing is replaced and the scope is empty.
+    Aligned new, malloc called directly and spin locks aren't caught.
+*/
+namespace RealtimeTrap
+{
+    // marks the calling thread as the audio thread while it's in scope
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() noexcept;
+        ~ScopedAudioThread() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedAudioThread)
+    };
+
+    bool isEnabled() noexcept; // true when the trap is compiled in
+
+    // counted since the program started
+    juce::int64 getNumAllocations() noexcept;
+    juce::int64 getNumLocks() noexcept;
+}
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    Saturator.cpp
+
+  ==============================================================================
+*/
+
+#include "Saturator.h"
+
+//==============================================================================
+juce::StringArray Saturator::getOversamplingNames()
+{
+    return { "1x", "2x", "4x", "8x" };
+}
+
+void Saturator::prepare (int numChannels, int maxBlockSize)
+{
+    for (int i = 0; i < maxOversamplingIndex; ++i)
+    {
+        oversamplers[i].clear();
+
+        // the minimum-phase polyphase IIR half-bands are far cheaper than the FIR ones and add under a sample of latency
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            oversamplers[i].push_back (std::make_unique<juce::dsp::Oversampling<float>> ((size_t) 1, (size_t) (i + 1),
+                                                                                          juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR));
+            oversamplers[i].back()->initProcessing ((size_t) maxBlockSize);
+        }
+    }
+
+    reset();
+}
+
+void Saturator::reset()
+{
+    for (auto& channelOversamplers : oversamplers)
+        for (auto& oversampler : channelOversamplers)
+            oversampler->reset();
+
+    previousDrive = drive;
+}
+
+void Saturator::setParameters (float driveDecibels, int newOversamplingIndex)
+{
+    drive = juce::Decibels::decibelsToGain (driveDecibels);
+    newOversamplingIndex = juce::jlimit (0, maxOversamplingIndex, newOversamplingIndex);
+
+    // the filters we switch to hold whatever they had when they were last used
+    if (newOversamplingIndex != oversamplingIndex)
+    {
+        oversamplingIndex = newOversamplingIndex;
+
+        if (oversamplingIndex > 0)
+            for (auto& oversampler : oversamplers[oversamplingIndex - 1])
+                oversampler->reset();
+    }
+}
+
+void Saturator::process (juce::dsp::AudioBlock<float>& block)
+{
+    process (block, 0);
+    endBlock();
+}
+
+void Saturator::process (juce::dsp::AudioBlock<float>& block, int firstChannel)
+{
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto channelBlock = block.getSingleChannelBlock (channel);
+
+        if (oversamplingIndex == 0)
+        {
+            clip (channelBlock.getChannelPointer (0), (int) channelBlock.getNumSamples(), previousDrive, drive);
+            continue;
+        }
+
+        auto& oversampler = *oversamplers[oversamplingIndex - 1][(size_t) firstChannel + channel];
+        auto upsampled = oversampler.processSamplesUp (channelBlock);
+
+        clip (upsampled.getChannelPointer (0), (int) upsampled.getNumSamples(), previousDrive, drive);
+
+        oversampler.processSamplesDown (channelBlock);
+    }
+}
+
+void Saturator::endBlock()
+{
+    previousDrive = drive;
+}
+
+float Saturator::getLatencyInSamples() const
+{
+    if (oversamplingIndex == 0 || oversamplers[oversamplingIndex - 1].empty())
+        return 0.0f;
+
+    return (float) oversamplers[oversamplingIndex - 1].front()->getLatencyInSamples();
+}
+
+void Saturator::clip (float* data, int numSamples, float startDrive, float endDrive)
+{
+    // a rational tanh that reaches exactly 1 with zero slope at 3, so clamping there leaves no corner.
+    // no branches or library calls, so the loop vectorises.
+    auto driveStep = (endDrive - startDrive) / (float) numSamples;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto currentDrive = startDrive + driveStep * (float) i;
+        auto x = juce::jlimit (-3.0f, 3.0f, data[i] * currentDrive);
+        auto x2 = x * x;
+        data[i] = x * (27.0f + x2) / ((27.0f + 9.0f * x2) * currentDrive);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    Saturator.h
+    Tape-style soft clipping for the echoes, optionally oversampled 2x, 4x or 8x.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Only the clipper runs at the raised rate: the block is upsampled through
+    polyphase half-band IIR filters, clipped and brought straight back down,
+    so everything around it stays at the host's rate.
+
+    The curve has unity gain for quiet signals and levels off at 1 / drive,
+    so more drive starts the squashing earlier without making the feedback
+    loop any louder than the wet gain already does.
+
+    One oversampler per factor and channel is built in prepare(), switching
+    factors only resets the ones being switched to. With each channel on its
+    own filters, a block's channels can be split between threads.
+*/
+class Saturator
+{
+public:
+    static constexpr int maxOversamplingIndex = 3; // 8x
+
+    Saturator() = default;
+
+    // the order matches the choices of the SATURATION_OVERSAMPLING parameter
+    static juce::StringArray getOversamplingNames();
+
+    // allocates every oversampler, this is the only place the saturator allocates
+    void prepare (int numChannels, int maxBlockSize);
+    void reset();
+
+    // factor is 1 << oversamplingIndex
+    void setParameters (float driveDecibels, int oversamplingIndex);
+
+    // clips the block in place, gliding from the last block's drive to the new one
+    void process (juce::dsp::AudioBlock<float>& block);
+
+    // the same for some of the channels: block holds channels firstChannel onwards. to split a block between
+    // threads, each one processes its own channels and endBlock() is called once they've all finished.
+    void process (juce::dsp::AudioBlock<float>& block, int firstChannel);
+    void endBlock();
+
+    bool isOversampling() const { return oversamplingIndex > 0; }
+
+    // the filters delay the signal by this much at the base rate (nothing without oversampling)
+    float getLatencyInSamples() const;
+
+    // the nonlinearity on its own, drive ramping linearly from startDrive to endDrive
+    static void clip (float* data, int numSamples, float startDrive, float endDrive);
+
+private:
+    std::vector<std::unique_ptr<juce::dsp::Oversampling<float>>> oversamplers[maxOversamplingIndex]; // 2x, 4x, 8x, per channel
+    int oversamplingIndex {0};
+
+    float drive {1.0f};
+    float previousDrive {1.0f};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Saturator)
+};
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    TempoSync.cpp
+
+  ==============================================================================
+*/
+
+#include "TempoSync.h"
+
+//==============================================================================
+juce::StringArray TempoSync::getNoteNames()
+{
+    return { "1/64", "1/32", "1/16", "1/8", "1/4", "1/2", "1 bar", "2 bars", "4 bars" };
+}
+
+juce::StringArray TempoSync::getModifierNames()
+{
+    return { "Straight", "Dotted", "Triplet" };
+}
+
+void TempoSync::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    needsUpdate = true;
+}
+
+void TempoSync::setNote (int newNoteIndex, int newModifierIndex)
+{
+    if (newNoteIndex == noteIndex && newModifierIndex == modifierIndex)
+        return;
+
+    noteIndex = newNoteIndex;
+    modifierIndex = newModifierIndex;
+    needsUpdate = true;
+}
+
+void TempoSync::setPosition (const juce::AudioPlayHead::PositionInfo& position)
+{
+    if (auto newBpm = position.getBpm(); newBpm.hasValue() && *newBpm > 0.0 && *newBpm != bpm)
+    {
+        bpm = *newBpm;
+        needsUpdate = true;
+    }
+
+    if (auto timeSignature = position.getTimeSignature(); timeSignature.hasValue() && timeSignature->denominator > 0
+         && (timeSignature->numerator != numerator || timeSignature->denominator != denominator))
+    {
+        numerator = timeSignature->numerator;
+        denominator = timeSignature->denominator;
+        needsUpdate = true;
+    }
+}
+
+double TempoSync::getDelayInSamples()
+{
+    if (needsUpdate)
+    {
+        delayInSamples = getNoteLengthInQuarterNotes() * 60.0 / bpm * sampleRate;
+        needsUpdate = false;
+    }
+
+    return delayInSamples;
+}
+
+double TempoSync::getNoteLengthInQuarterNotes() const
+{
+    // 1/64 up to 1/2 are powers of two of a quarter note, then whole bars
+    static constexpr int numNotesShorterThanABar = 6;
+    double length;
+
+    if (noteIndex < numNotesShorterThanABar)
+        length = std::pow (2.0, noteIndex - 4);
+    else
+        length = (1 << (noteIndex - numNotesShorterThanABar)) * numerator * 4.0 / denominator;
+
+    switch (modifierIndex)
+    {
+        case 1:  return length * 1.5;
+        case 2:  return length * 2.0 / 3.0;
+        default: return length;
+    }
+}
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    TempoSync.h
+    Turns a note value and the host's tempo into a delay time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Tempo, time signature, note and sample rate are kept from block to block
+    and the delay is only worked out again when one of them actually changes.
+    Hosts that stop reporting a tempo (or never did) leave the last known one
+    in place, 120 bpm in 4/4 to begin with. The processor's delay smoothing
+    then glides from one tempo's delay to the next through the fractional
+    read path.
+*/
+class TempoSync
+{
+public:
+    TempoSync() = default;
+
+    // the order matches the choices of the SYNC_NOTE and SYNC_MODIFIER parameters
+    static juce::StringArray getNoteNames();
+    static juce::StringArray getModifierNames();
+
+    void prepare (double newSampleRate);
+
+    void setNote (int newNoteIndex, int newModifierIndex);
+
+    // takes the tempo and time signature, if the host gave them
+    void setPosition (const juce::AudioPlayHead::PositionInfo& position);
+
+    // the length of the note at the current tempo
+    double getDelayInSamples();
+
+private:
+    // the note's length in quarter notes, a bar is as long as the time signature says
+    double getNoteLengthInQuarterNotes() const;
+
+    double sampleRate {44100.0};
+    double bpm {120.0};
+    int numerator {4}, denominator {4};
+    int noteIndex {4}, modifierIndex {0};
+
+    bool needsUpdate {true};
+    double delayInSamples {0.0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoSync)
+};
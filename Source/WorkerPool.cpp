@@ -0,0 +1,350 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+#include "RealtimeTrap.h"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_LINUX || JUCE_BSD
+ #include <semaphore.h>
+#endif
+
+//==============================================================================
+namespace
+{
+// a counting semaphore whose post() doesn't lock, so the audio thread can wake the workers with it. where there's
+// no such thing it's a WaitableEvent, which does lock and doesn't count, and the workers' timeout picks up the rest.
+// wait() returns false if it timed out.
+class Semaphore
+{
+public:
+   #if JUCE_MAC || JUCE_IOS
+    Semaphore()     : semaphore (dispatch_semaphore_create (0)) {}
+    ~Semaphore()    { dispatch_release (semaphore); }
+
+    void post() noexcept                { dispatch_semaphore_signal (semaphore); }
+    bool wait (int timeoutMs) noexcept  { return dispatch_semaphore_wait (semaphore, dispatch_time (DISPATCH_TIME_NOW, (int64_t) timeoutMs * NSEC_PER_MSEC)) == 0; }
+
+private:
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_LINUX || JUCE_BSD
+    Semaphore()     { sem_init (&semaphore, 0, 0); }
+    ~Semaphore()    { sem_destroy (&semaphore); }
+
+    void post() noexcept  { sem_post (&semaphore); }
+
+    bool wait (int timeoutMs) noexcept
+    {
+        timespec deadline;
+        clock_gettime (CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long) timeoutMs * 1000000;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+
+        for (;;)
+        {
+            if (sem_timedwait (&semaphore, &deadline) == 0)
+                return true;
+
+            if (errno != EINTR)
+                return false;
+        }
+    }
+
+private:
+    sem_t semaphore;
+   #else
+    void post() noexcept                { event.signal(); }
+    bool wait (int timeoutMs) noexcept  { return event.wait (timeoutMs); }
+
+private:
+    juce::WaitableEvent event;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (Semaphore)
+};
+}
+
+//==============================================================================
+class WorkerPool::Worker  : public juce::Thread
+{
+public:
+    Worker (WorkerPool& ownerPool, int workerIndex)
+        : juce::Thread ("Delay worker " + juce::String (workerIndex + 1)), pool (ownerPool), index (workerIndex)
+    {
+    }
+
+    ~Worker() override
+    {
+        stopThread (1000);
+    }
+
+    void run() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        auto spinTicks = juce::Time::secondsToHighResolutionTicks (spinSeconds);
+
+        while (! threadShouldExit())
+        {
+            // left out while measuring with fewer workers, it only wakes up to check whether it's back in
+            if (index >= pool.maxWorkers.load (std::memory_order_relaxed))
+            {
+                wakeUp.wait (sleepTimeoutMs);
+                continue;
+            }
+
+            {
+                // the tasks are audio thread code, the trap checks them here too
+                RealtimeTrap::ScopedAudioThread audioThread;
+
+                if (pool.runTasks())
+                    continue;
+            }
+
+            // a few microseconds in case the next run() is right behind, then sleep until one posts
+            auto spinUntilTicks = juce::Time::getHighResolutionTicks() + spinTicks;
+
+            while (! pool.hasUnclaimedTasks() && juce::Time::getHighResolutionTicks() < spinUntilTicks)
+            {
+            }
+
+            if (pool.hasUnclaimedTasks())
+                continue;
+
+            // raised before the last look, so a run() that starts now either is seen here or wakes this one
+            sleeping.store (true);
+
+            if (! pool.hasUnclaimedTasks())
+            {
+                auto woken = wakeUp.wait (sleepTimeoutMs);
+
+                // still up means nobody posted: a timeout, or a post left from the destructor. down means run()
+                // took it and has posted, or is about to, and that post is this worker's to take.
+                if (! sleeping.exchange (false) && ! woken)
+                    wakeUp.wait (sleepTimeoutMs);
+            }
+            else if (! sleeping.exchange (false))
+            {
+                wakeUp.wait (sleepTimeoutMs);
+            }
+        }
+    }
+
+    // audio thread. wakes the worker if it's asleep, false if it wasn't
+    bool wakeIfSleeping() noexcept
+    {
+        if (! sleeping.load (std::memory_order_relaxed) || ! sleeping.exchange (false))
+            return false;
+
+        wakeUp.post();
+        return true;
+    }
+
+    // with threadShouldExit() set, so it doesn't sleep out its timeout first
+    void wakeToExit() noexcept
+    {
+        wakeUp.post();
+    }
+
+private:
+    static constexpr double spinSeconds = 5.0e-6;
+    static constexpr int sleepTimeoutMs = 100; // how soon a sleeping worker notices it should exit
+
+    WorkerPool& pool;
+    const int index;
+
+    Semaphore wakeUp;
+    std::atomic<bool> sleeping {false};
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+WorkerPool::WorkerPool()
+    : WorkerPool (juce::SystemStats::getNumPhysicalCpus() - 1)
+{
+}
+
+WorkerPool::WorkerPool (int numWorkers)
+{
+    numWorkers = juce::jlimit (0, maxNumWorkers, numWorkers);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add (new Worker (*this, i));
+
+        // without the privileges for a realtime thread, the highest priority an ordinary one can have
+        if (! worker->startRealtimeThread (juce::Thread::RealtimeOptions {}) && ! worker->isThreadRunning())
+            worker->startThread (juce::Thread::Priority::highest);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->wakeToExit();
+    }
+
+    workers.clear();
+}
+
+bool WorkerPool::runOnWorkers (int numTasks, double deadlineSeconds, TaskFunction function, void* context)
+{
+    jassert (numTasks <= 0xffff);
+
+    if (numTasks <= 1 || workers.isEmpty() || maxWorkers.load (std::memory_order_relaxed) <= 0)
+        return false;
+
+    // another instance is using it, this one's on its own for the block
+    if (inUse.exchange (true, std::memory_order_acquire))
+        return false;
+
+    // a worker was late not long ago, whatever held it up may well do it again
+    if (juce::Time::getHighResolutionTicks() < backOffUntilTicks)
+    {
+        inUse.store (false, std::memory_order_release);
+        return false;
+    }
+
+    // everything the workers need goes out before the claim word that tells them there's something to do.
+    // the last run's tasks have all finished, so nobody can still be claiming them.
+    taskFunction.store (function, std::memory_order_relaxed);
+    taskContext.store (context, std::memory_order_relaxed);
+    numFinished.store (0, std::memory_order_relaxed);
+
+    auto generation = (nextClaim.load (std::memory_order_relaxed) >> 32) + 1;
+    nextClaim.store ((generation << 32) | ((juce::uint64) numTasks << 16));
+
+    // wakes as many sleeping workers as there are tasks to share, the rest sleep on
+    auto numToWake = numTasks - 1;
+    auto numWorkersInUse = juce::jmin (workers.size(), maxWorkers.load (std::memory_order_relaxed));
+
+    for (int i = 0; i < numWorkersInUse && numToWake > 0; ++i)
+        if (workers.getUnchecked (i)->wakeIfSleeping())
+            --numToWake;
+
+    // nobody waits for the workers to wake, whatever's left unclaimed by then gets done here
+    runTasks();
+
+    // the barrier: the tasks are all claimed, wait for the workers still running theirs. past the deadline one has
+    // most likely been preempted, so this gives way in case it's waiting for this core.
+    auto deadlineTicks = juce::Time::getHighResolutionTicks() + juce::Time::secondsToHighResolutionTicks (deadlineSeconds);
+    auto isLate = false;
+
+    while (numFinished.load (std::memory_order_acquire) < numTasks)
+    {
+        if (isLate)
+        {
+            juce::Thread::yield();
+        }
+        else if (juce::Time::getHighResolutionTicks() > deadlineTicks)
+        {
+            isLate = true;
+            numLateRuns.fetch_add (1, std::memory_order_relaxed);
+            backOffUntilTicks = juce::Time::getHighResolutionTicks() + juce::Time::secondsToHighResolutionTicks (backOffSeconds);
+        }
+    }
+
+    inUse.store (false, std::memory_order_release);
+    return true;
+}
+
+bool WorkerPool::hasUnclaimedTasks() const noexcept
+{
+    auto claim = nextClaim.load();
+    return getIndex (claim) < getNumTasks (claim);
+}
+
+bool WorkerPool::runTasks()
+{
+    auto ranTasks = false;
+
+    for (;;)
+    {
+        auto claim = nextClaim.load (std::memory_order_acquire);
+        auto index = getIndex (claim);
+
+        if (index >= getNumTasks (claim))
+            return ranTasks;
+
+        // read before the claim, but only used if the claim goes through, i.e. the tasks haven't changed since
+        auto* function = taskFunction.load (std::memory_order_relaxed);
+        auto* context = taskContext.load (std::memory_order_relaxed);
+
+        if (! nextClaim.compare_exchange_weak (claim, claim + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        function (context, (int) index);
+        numFinished.fetch_add (1, std::memory_order_release);
+        ranTasks = true;
+    }
+}
+
+//==============================================================================
+WorkerPoolHandle::WorkerPoolHandle()
+{
+    startTimer (updateIntervalMs);
+}
+
+WorkerPoolHandle::~WorkerPoolHandle()
+{
+    stopTimer();
+
+    const juce::ScopedLock sl (updateLock);
+    release();
+}
+
+void WorkerPoolHandle::update()
+{
+    const juce::ScopedLock sl (updateLock);
+
+    if (wanted.load (std::memory_order_relaxed))
+    {
+        if (heldPool == nullptr)
+        {
+            // the first instance to want it makes the pool and starts its threads
+            heldPool = std::make_unique<juce::SharedResourcePointer<WorkerPool>>();
+            activePool.store (&heldPool->get());
+        }
+    }
+    else
+    {
+        release();
+    }
+}
+
+void WorkerPoolHandle::release()
+{
+    if (heldPool == nullptr)
+        return;
+
+    // a ScopedUse from here on sees nullptr, one that picked the pool up before is waited out
+    activePool.store (nullptr);
+
+    while (inUse.load())
+        juce::Thread::yield();
+
+    // the last instance to let go destroys the pool, which stops its threads
+    heldPool.reset();
+}
+
+WorkerPoolHandle::ScopedUse::ScopedUse (WorkerPoolHandle& handleToUse) noexcept
+    : handle (handleToUse)
+{
+    // raised before the load, so release() either sees it raised or this sees nullptr
+    handle.inUse.store (true);
+    pool = handle.activePool.load();
+}
+
+WorkerPoolHandle::ScopedUse::~ScopedUse() noexcept
+{
+    handle.inUse.store (false, std::memory_order_release);
+}
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    A few realtime threads that help the audio thread through a block,
+    handing out work with atomics only.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    run() splits a block's work into numbered tasks, usually one per
+    channel. The audio thread publishes them with a single atomic store and
+    then works through them itself alongside the workers: whoever is free
+    claims the next index with a compare-and-swap, so a slow channel or a
+    worker the OS preempts doesn't hold the others up. The audio thread
+    returns once every task has finished, which makes each run() a barrier.
+
+    No locks, no allocation and no waiting on a thread to wake up: tasks
+    nobody has claimed yet the audio thread does itself. Between blocks the
+    workers sleep, each on its own semaphore, after spinning for a few
+    microseconds in case the next run() is right behind. A sleeping worker
+    raises a flag first, and run() wakes as many as it has tasks to share by
+    taking the flag down and posting, which doesn't lock; it carries on with
+    the tasks without waiting for them to wake. Whichever side takes the flag
+    down owns the wake-up, so a worker whose sleep times out is never still
+    counted as asleep and no post is ever left over for nobody.
+
+    The workers are started as realtime threads so the OS doesn't preempt
+    them mid-task in favour of something less urgent. If it does anyway,
+    the audio thread can only wait for the task to finish, so the wait has
+    a deadline: a run() that goes past it is counted in getNumLateRuns() and
+    the audio thread keeps every task to itself for backOffSeconds after.
+
+    The pool is meant to be shared, through a juce::SharedResourcePointer,
+    by every instance in the process, and only exists while one of them
+    wants it (see WorkerPoolHandle). One run() uses it at a time; another
+    instance calling run() meanwhile does its tasks on its own thread.
+*/
+class WorkerPool
+{
+public:
+    static constexpr int maxNumWorkers = 15; // with the audio thread, one per channel of the largest layout
+
+    // one worker per physical core but the one the audio thread is on
+    WorkerPool();
+    explicit WorkerPool (int numWorkers);
+    ~WorkerPool();
+
+    int getNumWorkers() const { return workers.size(); }
+
+    // runs whose workers took longer than the deadline to finish, since the pool was made
+    juce::int64 getNumLateRuns() const { return numLateRuns.load (std::memory_order_relaxed); }
+
+    // any thread. only the first this many workers take part in run(), for measuring how it scales.
+    void setMaxNumWorkers (int newMaxNumWorkers) { maxWorkers.store (newMaxNumWorkers, std::memory_order_relaxed); }
+
+    // audio thread. calls task (index) for every index below numTasks, on this thread and the workers, and
+    // returns when they've all finished. the task mustn't allocate or lock, and mustn't call run() itself.
+    // deadlineSeconds is how long, after the last task has been claimed, the workers get to finish theirs.
+    template <typename Task>
+    void run (int numTasks, double deadlineSeconds, Task&& task)
+    {
+        using TaskType = std::remove_reference_t<Task>;
+        auto* context = const_cast<void*> (static_cast<const void*> (std::addressof (task)));
+
+        if (! runOnWorkers (numTasks, deadlineSeconds, [] (void* c, int index) { (*static_cast<TaskType*> (c)) (index); }, context))
+            for (int index = 0; index < numTasks; ++index)
+                task (index);
+    }
+
+private:
+    using TaskFunction = void (*) (void* context, int index);
+
+    static constexpr double backOffSeconds = 1.0;
+
+    class Worker;
+
+    // false if the pool can't help (no workers, one task, another run() has it, or it's backing off after a late
+    // run), the caller does it all then
+    bool runOnWorkers (int numTasks, double deadlineSeconds, TaskFunction function, void* context);
+
+    // claims and runs the current tasks until there are none left, returns false if there weren't any
+    bool runTasks();
+
+    bool hasUnclaimedTasks() const noexcept;
+
+    // the generation, the number of tasks and the next index to claim, all in one word so a claim can only
+    // ever succeed on the tasks it read the function for
+    static juce::uint64 getIndex (juce::uint64 claim) noexcept     { return claim & 0xffff; }
+    static juce::uint64 getNumTasks (juce::uint64 claim) noexcept  { return (claim >> 16) & 0xffff; }
+
+    alignas (64) std::atomic<juce::uint64> nextClaim {0};
+    std::atomic<TaskFunction> taskFunction {nullptr};
+    std::atomic<void*> taskContext {nullptr};
+    alignas (64) std::atomic<int> numFinished {0};
+    alignas (64) std::atomic<bool> inUse {false};
+    std::atomic<int> maxWorkers {maxNumWorkers};
+    std::atomic<juce::int64> numLateRuns {0};
+    juce::int64 backOffUntilTicks {0}; // only touched by whoever has inUse
+
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerPool)
+};
+
+//==============================================================================
+/**
+    One instance's hold on the shared WorkerPool, taken only while the
+    instance wants it, so a process whose instances never turn PARALLEL on
+    never starts a worker thread.
+
+    The audio thread says whether it wants the pool with setWanted(), which
+    only stores a flag. A timer on the message thread (and update(), from
+    prepareToPlay()) takes a juce::SharedResourcePointer to the pool when
+    it's wanted and lets go when it isn't; the last instance to let go
+    destroys the pool and stops its threads. Until the pool has been taken
+    the audio thread gets nullptr from ScopedUse and does the work itself.
+
+    Letting go is a handshake with the audio thread: the pointer is cleared
+    first, then the message thread waits out any ScopedUse that picked it up
+    before, which is at most the rest of one block.
+*/
+class WorkerPoolHandle  : private juce::Timer
+{
+public:
+    WorkerPoolHandle();
+    ~WorkerPoolHandle() override;
+
+    // any thread, the audio thread once per block. picked up by the next update().
+    void setWanted (bool shouldBeWanted) noexcept { wanted.store (shouldBeWanted, std::memory_order_relaxed); }
+
+    // not the audio thread. takes or lets go of the pool now, rather than at the next timer tick.
+    void update();
+
+    // audio thread. the pool, or nullptr if it isn't held yet, kept alive for as long as this lives.
+    class ScopedUse
+    {
+    public:
+        explicit ScopedUse (WorkerPoolHandle& handleToUse) noexcept;
+        ~ScopedUse() noexcept;
+
+        WorkerPool* get() const noexcept { return pool; }
+
+    private:
+        WorkerPoolHandle& handle;
+        WorkerPool* pool {nullptr};
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedUse)
+    };
+
+private:
+    void timerCallback() override { update(); }
+    void release();
+
+    static constexpr int updateIntervalMs = 500;
+
+    std::atomic<bool> wanted {false};
+    std::atomic<WorkerPool*> activePool {nullptr};
+    std::atomic<bool> inUse {false}; // the audio thread is inside a ScopedUse
+
+    juce::CriticalSection updateLock; // the timer and prepareToPlay() can call update() on different threads
+    std::unique_ptr<juce::SharedResourcePointer<WorkerPool>> heldPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerPoolHandle)
+};